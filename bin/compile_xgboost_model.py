@@ -0,0 +1,257 @@
+#!/usr/bin/env python
+
+"""Compiles a saved XGBoost model into a C++ source file.
+
+The generated file evaluates every tree of the model with nested conditional
+statements, with split thresholds and leaf values as constants, and registers
+the model in XGBoostCompiledModel under the given name. It should be placed in
+directory src/XGBoostModels, from which it is picked up by the build system.
+The compiled model can then be selected in the configuration in place of the
+original one (see for instance PileUpIdWeight). The original model is still
+needed, since XGBoostPredictor checks at startup that the compiled model
+reproduces its predictions for a set of probe examples, which are generated
+by this script around the split thresholds.
+
+Only models with gbtree booster and a single output are supported. The
+conversion requires the XGBoost Python package, version 1.0 or newer.
+"""
+
+import argparse
+import json
+import math
+import os
+import random
+import struct
+import tempfile
+
+import xgboost
+
+
+# Link functions for supported objectives, given as C++ expressions in terms
+# of variable "margin", and functions to convert base score into the margin
+LINKS = {
+    'binary:logistic': '1.f / (1.f + std::exp(-margin))',
+    'reg:logistic': '1.f / (1.f + std::exp(-margin))',
+    'binary:logitraw': 'margin',
+    'reg:squarederror': 'margin',
+    'reg:linear': 'margin'
+}
+BASE_MARGINS = {
+    'binary:logistic': lambda p: -math.log(1. / p - 1.),
+    'reg:logistic': lambda p: -math.log(1. / p - 1.),
+    'binary:logitraw': lambda p: p,
+    'reg:squarederror': lambda p: p,
+    'reg:linear': lambda p: p
+}
+
+
+def to_float32(value):
+    """Round a number to single precision."""
+    return struct.unpack('f', struct.pack('f', value))[0]
+
+
+def format_float(value):
+    """Format a single-precision number as an exact C++ literal."""
+    value = to_float32(value)
+    if math.isnan(value):
+        return 'missing'
+    text = '{:.9g}'.format(value)
+    if not any(c in text for c in '.e'):
+        text += '.'
+    return text + 'f'
+
+
+def load_model(path):
+    """Load XGBoost model and return its JSON representation."""
+    booster = xgboost.Booster(model_file=path)
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        json_path = os.path.join(tmp_dir, 'model.json')
+        booster.save_model(json_path)
+        with open(json_path) as f:
+            return json.load(f)
+
+
+class Tree:
+    """Single regression tree from an XGBoost model.
+
+    Attributes:
+        left, right:  Indices of child nodes, -1 for leaves.
+        features:     Indices of features used in splits.
+        thresholds:   Split thresholds or, for leaves, leaf values.
+        default_left: Flags showing whether missing values go to the left.
+    """
+
+    def __init__(self, tree_json):
+        """Initialize from JSON representation of the tree."""
+
+        self.left = tree_json['left_children']
+        self.right = tree_json['right_children']
+        self.features = tree_json['split_indices']
+        self.thresholds = tree_json['split_conditions']
+        self.default_left = tree_json['default_left']
+
+    def is_leaf(self, node):
+        """Check if the node with given index is a leaf."""
+        return self.left[node] == -1
+
+    def used_thresholds(self):
+        """Yield pairs (feature, threshold) for all splits."""
+        for node in range(len(self.left)):
+            if not self.is_leaf(node):
+                yield self.features[node], to_float32(self.thresholds[node])
+
+    def to_cpp(self, node=0, depth=1):
+        """Return C++ code that evaluates the subtree rooted at given node."""
+
+        indent = '  ' * depth
+
+        if self.is_leaf(node):
+            return '{}return {};\n'.format(
+                indent, format_float(self.thresholds[node]))
+
+        # XGBoost sends an example to the left if the feature is smaller than
+        # the threshold. Comparisons with NaN are always false, so the form of
+        # the condition determines where missing values go.
+        x = 'x[{}]'.format(self.features[node])
+        threshold = format_float(self.thresholds[node])
+        if self.default_left[node]:
+            condition = 'not ({} >= {})'.format(x, threshold)
+        else:
+            condition = '{} < {}'.format(x, threshold)
+
+        return '{0}if ({1}) {{\n{2}{0}}} else {{\n{3}{0}}}\n'.format(
+            indent, condition, self.to_cpp(self.left[node], depth + 1),
+            self.to_cpp(self.right[node], depth + 1))
+
+
+def generate_probes(trees, num_features, num_probes, seed=1):
+    """Generate probe examples around the split thresholds.
+
+    Every feature of a probe example is set to a randomly chosen threshold
+    used with that feature, possibly shifted slightly up or down, or is
+    missing.
+    """
+
+    thresholds = [set() for _ in range(num_features)]
+    for tree in trees:
+        for feature, threshold in tree.used_thresholds():
+            thresholds[feature].add(threshold)
+    thresholds = [sorted(t) for t in thresholds]
+
+    rng = random.Random(seed)
+    probes = []
+    for _ in range(num_probes):
+        for feature in range(num_features):
+            if not thresholds[feature]:
+                probes.append(0.)
+                continue
+            choice = rng.random()
+            if choice < 0.1:
+                probes.append(float('nan'))
+                continue
+            value = rng.choice(thresholds[feature])
+            if choice < 0.4:
+                value -= 1e-3 * max(1., abs(value))
+            elif choice < 0.7:
+                value += 1e-3 * max(1., abs(value))
+            probes.append(value)
+    return probes
+
+
+def generate_source(model_json, name, source_path, num_probes):
+    """Generate C++ source file for given model."""
+
+    learner = model_json['learner']
+    booster = learner['gradient_booster']
+    if booster['name'] != 'gbtree':
+        raise RuntimeError(
+            'Booster "{}" is not supported.'.format(booster['name']))
+
+    objective = learner['objective']['name']
+    if objective not in LINKS:
+        raise RuntimeError(
+            'Objective "{}" is not supported.'.format(objective))
+
+    model_param = learner['learner_model_param']
+    if int(model_param.get('num_class', '0')) > 1 \
+            or int(model_param.get('num_target', '1')) > 1:
+        raise RuntimeError('Models with multiple outputs are not supported.')
+
+    num_features = int(model_param['num_feature'])
+    # Newer versions of XGBoost store the base score as a list
+    base_score = float(model_param['base_score'].strip('[]'))
+    base_margin = BASE_MARGINS[objective](base_score)
+
+    trees = [Tree(t) for t in booster['model']['trees']]
+    probes = generate_probes(trees, num_features, num_probes)
+
+    lines = []
+    lines.append(
+        '// Generated by bin/compile_xgboost_model.py from {}.\n'
+        '// Do not edit.\n\n'.format(os.path.basename(source_path)))
+    lines.append(
+        '#include <cmath>\n#include <limits>\n\n'
+        '#include <XGBoostCompiledModel.h>\n\n\n'
+        'namespace {\n\n')
+
+    lines.append(
+        'constexpr float missing = std::numeric_limits<float>::quiet_NaN();'
+        '\n\n\n')
+
+    for i, tree in enumerate(trees):
+        # Trees that consist of a single leaf don't use the features
+        if tree.is_leaf(0):
+            lines.append('float Tree{}(float const *) {{\n'.format(i))
+        else:
+            lines.append('float Tree{}(float const *x) {{\n'.format(i))
+        lines.append(tree.to_cpp())
+        lines.append('}\n\n\n')
+
+    # Trees are summed in the same order and with the same precision as in
+    # XGBoost
+    lines.append('float Predict(float const *x) {\n')
+    lines.append('  float margin = {};\n'.format(format_float(base_margin)))
+    for i in range(len(trees)):
+        lines.append('  margin += Tree{}(x);\n'.format(i))
+    lines.append('  return {};\n}}\n\n\n'.format(LINKS[objective]))
+
+    lines.append(
+        'XGBoostCompiledModel const model{{\n  "{}", {}, Predict,\n  {{'
+        .format(name, num_features))
+    for i, value in enumerate(probes):
+        if i % 4 == 0:
+            lines.append('\n   ')
+        lines.append(' {},'.format(format_float(value)))
+    lines.append('\n  }\n};\n\n}  // anonymous namespace\n')
+
+    return ''.join(lines)
+
+
+if __name__ == '__main__':
+    arg_parser = argparse.ArgumentParser(__doc__)
+    arg_parser.add_argument('model', help='Saved XGBoost model.')
+    arg_parser.add_argument(
+        '-n', '--name',
+        help='Name under which the model will be registered. By default, '
+        'the name of the model file without extension.')
+    arg_parser.add_argument(
+        '-o', '--output',
+        help='Path for the generated source file. By default, '
+        'src/XGBoostModels/<name>.cc in the repository.')
+    arg_parser.add_argument(
+        '--probes', type=int, default=100,
+        help='Number of probe examples.')
+    args = arg_parser.parse_args()
+
+    if not args.name:
+        args.name = os.path.splitext(os.path.basename(args.model))[0]
+    if not args.output:
+        args.output = os.path.join(
+            os.environ['HZZ2L2NU_BASE'], 'src', 'XGBoostModels',
+            args.name + '.cc')
+
+    source = generate_source(
+        load_model(args.model), args.name, args.model, args.probes)
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as f:
+        f.write(source)
@@ -11,6 +11,7 @@
 #include <ElectronBuilder.h>
 #include <EWCorrectionWeight.h>
 #include <GenJetBuilder.h>
+#include <GenParticleIndex.h>
 #include <GenWeight.h>
 #include <JetBuilder.h>
 #include <JetGeometricVeto.h>
@@ -25,8 +26,9 @@
 #include <PileUpIdWeight.h>
 #include <PileUpWeight.h>
 #include <PtMissBuilder.h>
+#include <RandomGenerator.h>
 #include <RunSampler.h>
-#include <TabulatedRandomGenerator.h>
+#include <ShapeSyst.h>
 #include <TauBuilder.h>
 #include <TriggerWeight.h>
 #include <WeightCollector.h>
@@ -63,7 +65,7 @@ class AnalysisCommon {
   double DPhiPtMiss(
     const std::initializer_list<CollectionBuilderBase const *> &builders);
 
-  double DPhiPtMiss2(const TLorentzVector &p4Miss,
+  double DPhiPtMiss2(const FourMomentum &p4Miss,
     const std::initializer_list<CollectionBuilderBase const *> &builders);
   /// Integrated luminosity, 1/pb
   double intLumi_;
@@ -76,13 +78,24 @@ class AnalysisCommon {
   bool isSim_;
 
   /// Common random number generator engine
-  TabulatedRngEngine tabulatedRngEngine_;
+  RngEngine rngEngine_;
 
   RunSampler runSampler_;
 
+  /**
+   * \brief Shape systematic variations evaluated in the current job
+   *
+   * Analyses that support evaluation of multiple variations in a single pass
+   * loop over them by selecting the current variation in this object.
+   */
+  ShapeSyst shapeSyst_;
+
   BTagger bTagger_;
   PileUpIdFilter pileUpIdFilter_;
 
+  /// Index of generator-level particles, shared by all gen-matching code
+  std::optional<GenParticleIndex> genParticles_;
+
   ElectronBuilder electronBuilder_;
   MuonBuilder muonBuilder_;
   TauBuilder tauBuilder_;
@@ -0,0 +1,144 @@
+#ifndef HZZ2L2NU_INCLUDE_ASYNCTREEWRITER_H_
+#define HZZ2L2NU_INCLUDE_ASYNCTREEWRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <TBranch.h>
+#include <TTree.h>
+
+
+/**
+ * \brief Fills ROOT trees in a separate thread
+ *
+ * Filling a tree involves serialization and compression of its baskets, which
+ * can take a sizeable fraction of the processing time. This class moves this
+ * work to a dedicated writer thread, so that it overlaps with the processing of
+ * subsequent events.
+ *
+ * When \ref Fill is called for the first time, the class records the buffers
+ * that the branches of the trees are attached to and redirects the branches to
+ * private buffers owned by the writer thread. Each call to \ref Fill then
+ * copies the content of the original buffers into a row in a bounded ring
+ * buffer. The writer thread copies rows into its buffers and fills the trees.
+ * The ring buffer has a single producer and a single consumer and is
+ * lock-free. A mutex and a condition variable are only used to put a thread to
+ * sleep when the buffer is full or empty.
+ *
+ * Only branches created from leaf lists with a single leaf of a fundamental
+ * type are supported, including variable-size arrays with a counter of type
+ * Int_t. No branches must be added after the first call to \ref Fill. The trees
+ * must not be accessed by other means until \ref Finish has been called. ROOT
+ * must have been made thread-safe with ROOT::EnableThreadSafety.
+ */
+class AsyncTreeWriter {
+ public:
+  /**
+   * \brief Constructor
+   *
+   * \param[in] trees  Non-owning pointers to trees to be filled.
+   * \param[in] queueSize  Maximal number of rows waiting to be written.
+   */
+  AsyncTreeWriter(std::vector<TTree *> const &trees, int queueSize = 1024);
+
+  /// Destructor. Waits for all queued rows to be written.
+  ~AsyncTreeWriter() noexcept;
+
+  AsyncTreeWriter(AsyncTreeWriter const &) = delete;
+  AsyncTreeWriter &operator=(AsyncTreeWriter const &) = delete;
+
+  /**
+   * \brief Queues current content of the buffers of the given tree for filling
+   *
+   * Blocks if the queue is full.
+   */
+  void Fill(int treeIndex);
+
+  /**
+   * \brief Waits until all queued rows have been written and stops the writer
+   * thread
+   *
+   * If an error occurred in the writer thread, it is rethrown here.
+   */
+  void Finish();
+
+ private:
+  /// Description of a branch
+  struct Branch {
+    TBranch *branch;
+
+    /// Buffer filled by the user
+    char const *source;
+
+    /// Buffer owned by the writer thread
+    std::vector<char> buffer;
+
+    /// Size of one element, in bytes
+    int elementSize;
+
+    /// Number of elements for fixed-size branches
+    int numElements;
+
+    /**
+     * \brief Index of the branch that contains the number of elements for a
+     * variable-size array, or -1 for fixed-size branches
+     */
+    int countIndex;
+  };
+
+  /// Row waiting to be written
+  struct Row {
+    int treeIndex;
+
+    /// Concatenated content of all buffers of the tree
+    std::vector<char> data;
+  };
+
+  /// Records buffers of all branches and redirects the branches
+  void Setup();
+
+  /// Main function of the writer thread
+  void WriterLoop();
+
+  /// Non-owning pointers to the trees
+  std::vector<TTree *> trees_;
+
+  /// Branches of each tree
+  std::vector<std::vector<Branch>> branches_;
+
+  /// Indicates whether \ref Setup has been called
+  bool setUp_;
+
+  /// Ring buffer with rows
+  std::vector<Row> queue_;
+
+  /**
+   * \brief Total numbers of rows added to and removed from the queue
+   *
+   * Only the producer modifies \c head_, and only the consumer modifies
+   * \c tail_.
+   */
+  std::atomic<uint64_t> head_, tail_;
+
+  /// Indicate whether the producer or the consumer is sleeping
+  std::atomic<bool> producerWaiting_, consumerWaiting_;
+
+  /// Indicates that no more rows will be added
+  std::atomic<bool> finishing_;
+
+  /// Used together with \ref wakeUp_ to put the threads to sleep
+  std::mutex mutex_;
+  std::condition_variable wakeUp_;
+
+  std::thread writer_;
+
+  /// Error that occurred in the writer thread
+  std::exception_ptr error_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_ASYNCTREEWRITER_H_
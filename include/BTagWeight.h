@@ -7,12 +7,12 @@
 #include <memory>
 #include <string>
 
-#include <TH2F.h>
 #include <TTreeReaderArray.h>
 
+#include <BinnedTable.h>
 #include <BTagger.h>
 #include <Dataset.h>
-#include <EventCache.h>
+#include <EventGraph.h>
 #include <JetBuilder.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -46,8 +46,7 @@ class BTagWeight : public WeightBase {
   ~BTagWeight() noexcept;
 
   virtual double NominalWeight() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[0];
   }
 
@@ -56,14 +55,12 @@ class BTagWeight : public WeightBase {
   }
 
   virtual double operator()() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[int(defaultVariation_)];
   }
 
   virtual double RelWeight(int variation) const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[variation + 1] / weights_[0];
   }
 
@@ -83,18 +80,32 @@ class BTagWeight : public WeightBase {
     kMistagDown = 4
   };
 
-  /// Computes event weight for the given systematic variation
-  double ComputeWeight(Variation variation) const;
+  /**
+   * \brief Flavours of jets in b tag efficiency tables and scale factors
+   *
+   * The values match the enumeration BTagEntry::JetFlavor.
+   */
+  enum class Flavour : int {
+    kBottom = 0,
+    kCharm = 1,
+    kLight = 2
+  };
+
+  /// Translates hadron flavour of a jet into \ref Flavour
+  static Flavour TranslateFlavour(int hadronFlavour);
 
   /// Loads b tag efficiencies
   void LoadEffTables();
 
   /// Returns b tag efficiency computed for the jet with given properties
-  double GetEfficiency(double pt, double eta, int flavour) const;
+  double GetEfficiency(double pt, double eta, Flavour flavour) const;
 
-  /// Return b tag scale factor computed for the jet with given properties
-  double GetScaleFactor(double pt, double eta, int flavour,
-                        Variation variation) const;
+  /**
+   * \brief Returns central, up, and down b tag scale factors computed for the
+   * jet with given properties
+   */
+  std::array<double, 3> GetScaleFactors(double pt, double eta,
+                                        Flavour flavour) const;
 
   /// Computes event weights for all systematic variations
   void Update() const;
@@ -113,8 +124,8 @@ class BTagWeight : public WeightBase {
   
   std::string bottomHistName_, charmHistName_, lightHistName_;
 
-  /// Object that contains b tag efficiencies
-  std::map<std::string, std::unique_ptr<TH2>> effTables_;
+  /// Tables with b tag efficiencies, indexed with \ref Flavour
+  std::array<BinnedTable2D, 3> effTables_;
 
   /// Object that provies values of b tag scale factors
   std::unique_ptr<BTagCalibrationReader> scaleFactorReader_;
@@ -122,7 +133,7 @@ class BTagWeight : public WeightBase {
   /// Requested systematic variation
   Variation defaultVariation_;
 
-  EventCache cache_;
+  EventNode node_;
 
   /**
    * \brief Cached weights for all systematic variations
@@ -0,0 +1,201 @@
+#ifndef HZZ2L2NU_INCLUDE_BINNEDTABLE_H_
+#define HZZ2L2NU_INCLUDE_BINNEDTABLE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <TAxis.h>
+#include <TH1.h>
+#include <TH2.h>
+
+
+/**
+ * \brief Binning along one axis of a BinnedTable1D or BinnedTable2D
+ *
+ * Bins are numbered following the ROOT convention: bin 0 is the underflow, bins
+ * from 1 to NumBins() are regular, and bin NumBins() + 1 is the overflow. Left
+ * edges of bins are inclusive. FindBin reproduces TAxis::FindFixBin exactly but
+ * avoids virtual calls. For uniform binning the bin index is computed
+ * arithmetically, otherwise a binary search over the edges is performed.
+ */
+class BinnedAxis {
+ public:
+  /// Constructs an axis with a single bin spanning [0, 1)
+  BinnedAxis();
+
+  /// Copies the binning from a ROOT axis
+  BinnedAxis(TAxis const &axis);
+
+  /**
+   * \brief Constructs an axis from edges of regular bins
+   *
+   * The edges must be sorted and contain at least two elements.
+   */
+  BinnedAxis(std::vector<double> const &edges);
+
+  /// Returns the index of the bin that contains given value
+  int FindBin(double x) const {
+    if (x < min_)
+      return 0;
+    else if (not (x < max_))  // Also catches NaN
+      return numBins_ + 1;
+    else if (uniform_)
+      return 1 + int(numBins_ * (x - min_) / (max_ - min_));
+    else
+      return BinarySearch(x);
+  }
+
+  /// Returns the lower edge of the bin with given index
+  double BinLowEdge(int bin) const {
+    return edges_[bin - 1];
+  }
+
+  /// Returns the center of the bin with given index
+  double BinCenter(int bin) const {
+    return 0.5 * (edges_[bin - 1] + edges_[bin]);
+  }
+
+  /// Returns the lower edge of the first regular bin
+  double Min() const {
+    return min_;
+  }
+
+  /// Returns the upper edge of the last regular bin
+  double Max() const {
+    return max_;
+  }
+
+  /// Returns the number of regular bins
+  int NumBins() const {
+    return numBins_;
+  }
+
+ private:
+  /**
+   * \brief Finds the regular bin that contains given value in case of
+   * non-uniform binning
+   */
+  int BinarySearch(double x) const;
+
+  /// Number of regular bins
+  int numBins_;
+
+  /// Range covered by regular bins
+  double min_, max_;
+
+  /// Indicates whether all bins have the same width
+  bool uniform_;
+
+  /**
+   * \brief Edges of all regular bins
+   *
+   * Contains NumBins() + 1 elements.
+   */
+  std::vector<double> edges_;
+};
+
+
+/**
+ * \brief Immutable lookup table with a one-dimensional binning
+ *
+ * Constructed from a TH1 at load time. The bin contents, including the under-
+ * and overflow bins, are stored in a contiguous array of floats, so that a
+ * lookup consists of a bin index computation and a single load.
+ */
+class BinnedTable1D {
+ public:
+  /// Constructs an empty table, which should be assigned before use
+  BinnedTable1D();
+
+  /// Copies the binning and bin contents from a histogram
+  BinnedTable1D(TH1 const &hist);
+
+  /// Returns the value in the bin that contains given point
+  double operator()(double x) const {
+    return values_[axis_.FindBin(x)];
+  }
+
+  /**
+   * \brief Looks up values for an array of points
+   *
+   * \param[in] n  Number of points.
+   * \param[in] x  Coordinates of the points.
+   * \param[out] values  Array of size \c n to be filled with looked up values.
+   */
+  void Lookup(std::size_t n, double const *x, double *values) const;
+
+  /// Returns the binning
+  BinnedAxis const &Axis() const {
+    return axis_;
+  }
+
+  /// Returns the value in the bin with given index
+  double Value(int bin) const {
+    return values_[bin];
+  }
+
+ private:
+  /// Binning
+  BinnedAxis axis_;
+
+  /// Bin contents indexed with the bin number
+  std::vector<float> values_;
+};
+
+
+/**
+ * \brief Immutable lookup table with a two-dimensional binning
+ *
+ * Constructed from a TH2 at load time. The bin contents, including the under-
+ * and overflow bins, are stored in a contiguous array of floats, with the same
+ * layout as the global bin numbering in TH2. A lookup consists of two bin index
+ * computations and a single load.
+ */
+class BinnedTable2D {
+ public:
+  /// Constructs an empty table, which should be assigned before use
+  BinnedTable2D();
+
+  /// Copies the binning and bin contents from a histogram
+  BinnedTable2D(TH2 const &hist);
+
+  /// Returns the value in the bin that contains given point
+  double operator()(double x, double y) const {
+    return Value(xAxis_.FindBin(x), yAxis_.FindBin(y));
+  }
+
+  /**
+   * \brief Looks up values for an array of points
+   *
+   * \param[in] n  Number of points.
+   * \param[in] x  First coordinates of the points.
+   * \param[in] y  Second coordinates of the points.
+   * \param[out] values  Array of size \c n to be filled with looked up values.
+   */
+  void Lookup(std::size_t n, double const *x, double const *y,
+              double *values) const;
+
+  /// Returns the binning along the first dimension
+  BinnedAxis const &XAxis() const {
+    return xAxis_;
+  }
+
+  /// Returns the binning along the second dimension
+  BinnedAxis const &YAxis() const {
+    return yAxis_;
+  }
+
+  /// Returns the value in the bin with given indices along the two dimensions
+  double Value(int binX, int binY) const {
+    return values_[binX + (xAxis_.NumBins() + 2) * binY];
+  }
+
+ private:
+  /// Binnings along the two dimensions
+  BinnedAxis xAxis_, yAxis_;
+
+  /// Bin contents indexed with the global bin number
+  std::vector<float> values_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_BINNEDTABLE_H_
@@ -0,0 +1,290 @@
+#ifndef HZZ2L2NU_INCLUDE_BULKREADER_H_
+#define HZZ2L2NU_INCLUDE_BULKREADER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <Bytes.h>
+#include <TBranch.h>
+#include <TBufferFile.h>
+#include <TChain.h>
+#include <TDataType.h>
+#include <TNotifyLink.h>
+
+
+class Dataset;
+
+
+/**
+ * \brief Type-independent part of BulkColumn
+ *
+ * Keeps track of the branch and of the range of entries in the basket that has
+ * been decoded. Derived classes store the decoded values.
+ */
+class BulkColumnBase {
+ public:
+  /**
+   * \brief Constructor
+   *
+   * \param[in] branchName  Name of the branch.
+   * \param[in] type  Type of the values, which must match the type of the leaf.
+   * \param[in] optional  If true, the branch is allowed to be missing in some
+   *   or all files of the dataset.
+   */
+  BulkColumnBase(std::string const &branchName, EDataType type, bool optional);
+
+  BulkColumnBase(BulkColumnBase const &) = delete;
+  BulkColumnBase &operator=(BulkColumnBase const &) = delete;
+
+  virtual ~BulkColumnBase() = default;
+
+  /// Returns the name of the branch
+  std::string const &GetBranchName() const {
+    return branchName_;
+  }
+
+  /// Checks if the branch is present in the current tree
+  bool IsPresent() const {
+    return branch_ != nullptr;
+  }
+
+ protected:
+  /// Position of the current entry among the decoded values
+  int64_t index_;
+
+ private:
+  friend class BulkReader;
+
+  /**
+   * \brief Finds the branch in the given tree and checks that it can be read
+   * in bulk
+   */
+  void Attach(TTree *tree);
+
+  /**
+   * \brief Decodes the given number of values from a buffer in the
+   * serialized (big-endian) format
+   */
+  virtual void Decode(char *buffer, int count) = 0;
+
+  /**
+   * \brief Makes sure that the basket containing the given entry of the
+   * current tree has been decoded and sets \ref index_
+   */
+  void Load(int64_t entry);
+
+  std::string branchName_;
+
+  /// Type of the values
+  EDataType type_;
+
+  /// Indicates whether the branch is allowed to be missing
+  bool optional_;
+
+  /// Branch in the current tree or nullptr if it is missing
+  TBranch *branch_;
+
+  /// Half-open range of entries of the current tree that have been decoded
+  int64_t first_, end_;
+
+  /// Buffer into which the baskets are read
+  TBufferFile buffer_;
+};
+
+
+/**
+ * \brief Values of a scalar branch decoded from the current basket
+ *
+ * Objects of this class are owned by BulkReader, which creates one for each
+ * branch and type. They are accessed through BulkValue.
+ */
+template <typename T>
+class BulkColumn : public BulkColumnBase {
+ public:
+  /// Constructor, see BulkColumnBase::BulkColumnBase
+  BulkColumn(std::string const &branchName, bool optional)
+      : BulkColumnBase{branchName, TDataType::GetType(typeid(T)), optional},
+        capacity_{0} {}
+
+  /// Returns pointer to the value in the current entry
+  T const *Get() const {
+    return values_.get() + index_;
+  }
+
+ private:
+  void Decode(char *buffer, int count) override {
+    if (count > capacity_) {
+      values_.reset(new T[count]);
+      capacity_ = count;
+    }
+
+    for (int i = 0; i < count; ++i)
+      frombuf(buffer, values_.get() + i);
+  }
+
+  /// Values decoded from the current basket
+  std::unique_ptr<T[]> values_;
+
+  /// Size of the array \ref values_
+  int capacity_;
+};
+
+
+/**
+ * \brief Type-independent part of BulkValue
+ *
+ * Looks up the column for the branch in the BulkReader of the dataset,
+ * creating it if needed.
+ */
+class BulkValueBase {
+ public:
+  /// Function that creates a column of the right type for a branch
+  using ColumnFactory = std::unique_ptr<BulkColumnBase> (*)(
+      std::string const &branchName, bool optional);
+
+  /// Returns the name of the branch
+  std::string const &GetBranchName() const {
+    return column_->GetBranchName();
+  }
+
+  /**
+   * \brief Checks if the branch is present in the current tree
+   *
+   * Values must only be accessed if this is true.
+   */
+  bool IsPresent() const {
+    return column_->IsPresent();
+  }
+
+ protected:
+  /**
+   * \brief Constructor
+   *
+   * \param[in] dataset  Dataset from which the branch is read.
+   * \param[in] branchName  Name of the branch.
+   * \param[in] type  Type of the values, which must match the type of the leaf.
+   * \param[in] optional  If true, the branch is allowed to be missing in some
+   *   or all files of the dataset.
+   * \param[in] factory  Function to create the column if the reader does not
+   *   have one for this branch and type yet.
+   */
+  BulkValueBase(Dataset &dataset, std::string const &branchName,
+                EDataType type, bool optional, ColumnFactory factory);
+
+  /// Non-owning pointer to the column shared by all values of the branch
+  BulkColumnBase *column_;
+};
+
+
+/**
+ * \brief Provides access to the value of a scalar branch in the current entry
+ *
+ * The interface follows that of TTreeReaderValue. The difference is that the
+ * branch is read with the bulk I/O of ROOT, which deserializes a complete
+ * basket at once into a contiguous array, instead of unpacking each entry
+ * individually. Returned references point into that array and stay valid until
+ * a new basket is loaded. All objects that read the same branch with the same
+ * type share the decoded array.
+ *
+ * Only branches with a single leaf holding one value of a fundamental type are
+ * supported, and the type of the leaf must match \c T exactly. The same branch
+ * must not be read through the TTreeReader of the dataset.
+ */
+template <typename T>
+class BulkValue : public BulkValueBase {
+ public:
+  /// Constructor, see BulkValueBase::BulkValueBase
+  BulkValue(Dataset &dataset, std::string const &branchName,
+            bool optional = false)
+      : BulkValueBase{dataset, branchName, TDataType::GetType(typeid(T)),
+                      optional, &CreateColumn} {}
+
+  /// Returns pointer to the value in the current entry
+  T const *Get() const {
+    return static_cast<BulkColumn<T> const *>(column_)->Get();
+  }
+
+  T const &operator*() const {
+    return *Get();
+  }
+
+  T const *operator->() const {
+    return Get();
+  }
+
+ private:
+  static std::unique_ptr<BulkColumnBase> CreateColumn(
+      std::string const &branchName, bool optional) {
+    return std::make_unique<BulkColumn<T>>(branchName, optional);
+  }
+};
+
+
+/**
+ * \brief Reads scalar branches accessed with BulkValue
+ *
+ * An object of this class is owned by Dataset, which notifies it whenever the
+ * current entry changes. When the entry moves outside of the basket decoded
+ * for a branch, the next basket is read in bulk. The reader subscribes to the
+ * notifications that the chain sends each time it loads a tree, and the
+ * columns are attached to branches of the current tree when the next entry is
+ * set after that. This includes the case when a tree that has been left is
+ * loaded again.
+ */
+class BulkReader {
+ public:
+  /// Constructor from the chain that the dataset reads
+  BulkReader(TChain &chain);
+
+  ~BulkReader() noexcept;
+
+  BulkReader(BulkReader const &) = delete;
+  BulkReader &operator=(BulkReader const &) = delete;
+
+  /// Returns names of branches of all columns
+  std::vector<std::string> GetBranchNames() const;
+
+  /**
+   * \brief Marks the columns as not attached to the current tree
+   *
+   * Called by the chain whenever it loads a new tree.
+   */
+  bool Notify();
+
+  /**
+   * \brief Loads values for the given entry of the chain
+   *
+   * The chain must have already been positioned at this entry (e.g. by the
+   * TTreeReader).
+   */
+  void SetEntry(int64_t entry);
+
+ private:
+  friend class BulkValueBase;
+
+  /**
+   * \brief Returns the column for the given branch and type, creating it with
+   * the given function if it does not exist yet
+   *
+   * A column that is shared between optional and mandatory values is
+   * mandatory.
+   */
+  BulkColumnBase *GetColumn(
+      std::string const &branchName, EDataType type, bool optional,
+      BulkValueBase::ColumnFactory factory);
+
+  TChain &chain_;
+
+  /// Link in the chain of objects notified by \ref chain_
+  TNotifyLink<BulkReader> notify_;
+
+  /// Indicates whether the columns are attached to the current tree
+  bool attached_;
+
+  std::vector<std::unique_ptr<BulkColumnBase>> columns_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_BULKREADER_H_
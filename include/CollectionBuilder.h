@@ -2,13 +2,16 @@
 #define COLLECTIONBUILDER_H_
 
 #include <initializer_list>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/iterator/iterator_facade.hpp>
-#include <TLorentzVector.h>
-#include <TTreeReader.h>
 
-#include <EventCache.h>
+#include <Columns.h>
+#include <Dataset.h>
+#include <EventGraph.h>
+#include <FourMomentum.h>
 
 
 /**
@@ -20,12 +23,17 @@
  *
  * This class also provides a mechanism for per-event caching and lazy
  * construction of the collection of physics objects, see methods \ref Update
- * and \ref Build.
+ * and \ref Build. The construction is represented by a node in the EventGraph
+ * of the dataset, which is accessible with \ref GetNode. Builders for cleaning
+ * (see \ref EnableCleaning) are registered as its inputs automatically, and
+ * a derived class must register any other components it uses.
  *
- * Methods \ref EnableCleaning and \ref IsDuplicate are helpful to avoid double
- * counting of objects with collections produced by other builders. A derived
- * class must make use of method \ref IsDuplicate to skip objects identified as
- * duplicates.
+ * Methods \ref EnableCleaning, \ref IsDuplicate, and \ref RejectDuplicates are
+ * helpful to avoid double counting of objects with collections produced by
+ * other builders. A derived class must make use of one of the two latter
+ * methods to skip objects identified as duplicates. The cleaning relies on
+ * \ref GetDirections, which provides directions of objects in the collection
+ * as contiguous arrays.
  *
  * When a derived class changes momenta of physics objects in the collection, it
  * should register the change using method \ref AddMomentumShift. The change in
@@ -35,7 +43,7 @@
  */
 class CollectionBuilderBase {
  public:
-  using Momentum = TLorentzVector;
+  using Momentum = FourMomentum;
 
   /// A constant iterator for MomentaWrapper
   class MomentumIt : public boost::iterator_facade<
@@ -87,10 +95,9 @@ class CollectionBuilderBase {
   /**
    * \brief Constructor
    *
-   * The reader object provided as the argument is used to implement per-event
-   * caching.
+   * Adds a node with the given name to the EventGraph of the dataset.
    */
-  CollectionBuilderBase(TTreeReader &reader);
+  CollectionBuilderBase(Dataset &dataset, std::string name);
 
   /**
    * \brief Requests cleaning with respect to collections produced by given
@@ -99,20 +106,49 @@ class CollectionBuilderBase {
    * It is up to a derived class to actually remove duplicates identified by
    * method \ref IsDuplicate. Objects provided in the argument are not owned by
    * this. If this method is called multiple times, new builders are added to
-   * the list of already registered builders.
+   * the list of already registered builders. The builders are also registered
+   * as inputs of the node of this builder.
    */
   void EnableCleaning(
     std::initializer_list<CollectionBuilderBase const *> builders);
   
+  /**
+   * \brief Provides pseudorapidities and azimuthal angles of physics objects in
+   * the collection
+   *
+   * The arrays are filled right after \ref Build, so that this method does not
+   * modify the object and can be called from several threads concurrently. The
+   * returned view is valid until the collection changes. A derived class that
+   * switches between several collections without rebuilding, as happens with
+   * shape variations, only provides directions for the collection returned
+   * right after \ref Build. An exception is thrown if another collection is
+   * selected.
+   */
+  DirectionColumns GetDirections() const;
+
   /// Provides access to four-momenta of physics objects in the collection
   MomentaWrapper GetMomenta() const;
 
+  /// Returns the node that represents this builder in the EventGraph
+  EventNode const &GetNode() const {
+    return node_;
+  }
+
+  /// \copydoc GetNode
+  EventNode &GetNode() {
+    return node_;
+  }
+
   /**
    * \brief Returns the accumulated change in momentum in the current event,
    * introduced as a result of calibration and other changes to momenta of
    * individual objects.
+   *
+   * A derived class that evaluates several shape variations at once (see
+   * ShapeSyst) overrides this method to return the shift in the currently
+   * selected variation.
    */
-  Momentum const &GetSumMomentumShift() const;
+  virtual Momentum const &GetSumMomentumShift() const;
 
   /**
    * \brief Checks if the direction of the given momentum is close to that of a
@@ -122,6 +158,22 @@ class CollectionBuilderBase {
    */
   bool IsDuplicate(Momentum const &p4, double maxDR) const;
 
+  /**
+   * \brief Deselects objects whose directions are close to that of an object in
+   * one of the collections for cleaning
+   *
+   * This is the same as \ref IsDuplicate but performed for a whole collection
+   * of candidates at once.
+   *
+   * \param[in] candidates  Directions of candidate objects.
+   * \param[in] maxDR  Maximal distance in the (eta, phi) metric for objects to
+   *   be considered duplicates.
+   * \param[in,out] mask  Selection mask for the candidates, in which duplicates
+   *   are deselected.
+   */
+  void RejectDuplicates(DirectionColumns const &candidates, double maxDR,
+                        SelectionMask &mask) const;
+
  protected:
   /**
    * \brief Adds a shift to the sum four-momentum
@@ -163,8 +215,11 @@ class CollectionBuilderBase {
   /// Interface to access the size of the collection
   virtual size_t GetNumMomenta() const = 0;
 
-  /// An object to facilitate caching
-  EventCache cache_;
+  /// Fills \ref directionEta_ and \ref directionPhi_ for the new collection
+  void FillDirections() const;
+
+  /// Node in the EventGraph that calls \ref Build
+  EventNode node_;
 
   /**
    * \brief Collection of non-owning pointers to objects that produce
@@ -177,6 +232,18 @@ class CollectionBuilderBase {
    * \ref AddP4Shift.
    */
   mutable Momentum sumP4Shift_;
+
+  /// Pseudorapidities and azimuthal angles of objects in the collection
+  mutable std::vector<float> directionEta_, directionPhi_;
+
+  /**
+   * \brief Address of the first momentum in the collection from which
+   * \ref directionEta_ and \ref directionPhi_ have been filled
+   *
+   * Used to detect when a derived class switches to a different collection
+   * without rebuilding, as happens with shape variations.
+   */
+  mutable Momentum const *directionsSource_;
 };
 
 
@@ -252,8 +319,15 @@ inline size_t CollectionBuilderBase::MomentaWrapper::size() const {
 }
 
 
-inline CollectionBuilderBase::CollectionBuilderBase(TTreeReader &reader)
-    : cache_{reader} {}
+inline CollectionBuilderBase::CollectionBuilderBase(
+    Dataset &dataset, std::string name)
+    : node_{dataset.Graph(), std::move(name),
+            [this]{
+              sumP4Shift_ = Momentum{};
+              Build();
+              FillDirections();
+            }},
+      directionsSource_{nullptr} {}
 
 
 inline CollectionBuilderBase::MomentaWrapper
@@ -276,10 +350,7 @@ inline void CollectionBuilderBase::AddMomentumShift(
 
 
 inline void CollectionBuilderBase::Update() const {
-  if (cache_.IsUpdated()) {
-    sumP4Shift_ = Momentum{};
-    Build();
-  }
+  node_.Evaluate();
 }
 
 
@@ -298,9 +369,9 @@ class CollectionBuilder : public CollectionBuilderBase {
   /**
    * \brief Constructor
    *
-   * Directly forwards its argument to the base class.
+   * Directly forwards its arguments to the base class.
    */
-  CollectionBuilder(TTreeReader &reader);
+  CollectionBuilder(Dataset &dataset, std::string name);
 
   /// Interface to access the collection of physics objects
   virtual std::vector<T> const &Get() const = 0;
@@ -316,8 +387,8 @@ class CollectionBuilder : public CollectionBuilderBase {
 
 
 template <typename T>
-CollectionBuilder<T>::CollectionBuilder(TTreeReader &reader)
-    : CollectionBuilderBase{reader} {}
+CollectionBuilder<T>::CollectionBuilder(Dataset &dataset, std::string name)
+    : CollectionBuilderBase{dataset, std::move(name)} {}
 
 
 template <typename T>
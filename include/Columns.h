@@ -0,0 +1,316 @@
+#ifndef HZZ2L2NU_INCLUDE_COLUMNS_H_
+#define HZZ2L2NU_INCLUDE_COLUMNS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <TTreeReader.h>
+#include <TTreeReaderArray.h>
+
+#include <FourMomentum.h>
+
+
+/**
+ * \brief Read-only view of a contiguous array of values
+ *
+ * The view does not own the values. It is only valid until the underlying
+ * storage is changed, which for a view obtained from a ColumnReader means
+ * until the next event is read.
+ */
+template <typename T>
+class ColumnView {
+ public:
+  /// Constructs an empty view
+  ColumnView() noexcept
+      : data_{nullptr}, size_{0} {}
+
+  /// Constructs a view of given array
+  ColumnView(T const *data, std::size_t size) noexcept
+      : data_{data}, size_{size} {}
+
+  T const &operator[](std::size_t index) const {
+    return data_[index];
+  }
+
+  T const *begin() const {
+    return data_;
+  }
+
+  T const *data() const {
+    return data_;
+  }
+
+  T const *end() const {
+    return data_ + size_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+ private:
+  /// Pointer to the first element
+  T const *data_;
+
+  /// Number of elements
+  std::size_t size_;
+};
+
+
+/**
+ * \brief Reads an array branch and provides a ColumnView of it
+ *
+ * This is a thin wrapper around TTreeReaderArray. Elements of arrays of
+ * fundamental types read from flat branches, as in NanoAOD, are stored by ROOT
+ * in a contiguous buffer, and the view then points directly into that buffer.
+ * This is verified for every event. If the elements turn out not to be stored
+ * contiguously, they are copied into an internal buffer instead.
+ *
+ * The element accessors of TTreeReaderArray are mirrored, so that this class
+ * can be used as a drop-in replacement for it.
+ */
+template <typename T>
+class ColumnReader {
+ public:
+  /// Constructor from a reader and the name of the branch
+  ColumnReader(TTreeReader &reader, std::string const &branchName)
+      : src_{reader, branchName.c_str()}, bufferSize_{0} {}
+
+  T const &At(std::size_t index) const {
+    return src_.At(index);
+  }
+
+  std::size_t GetSize() const {
+    return src_.GetSize();
+  }
+
+  /**
+   * \brief Reads the branch in the current event
+   *
+   * TTreeReader reads branches lazily, on the first access in an entry. After
+   * this method has been called, accessing the array in the same entry
+   * involves no reading from the tree, which allows concurrent access (see
+   * EventGraph).
+   */
+  void Prefetch() const {
+    if (src_.GetSize() > 0)
+      src_.At(0);
+  }
+
+  /// Returns a view of the array in the current event
+  ColumnView<T> View() const;
+
+  T const &operator[](std::size_t index) const {
+    return src_[index];
+  }
+
+ private:
+  /// Underlying reader
+  mutable TTreeReaderArray<T> src_;
+
+  /// Buffer used in case the array is not stored contiguously
+  mutable std::unique_ptr<T[]> buffer_;
+
+  /// Size of \ref buffer_
+  mutable std::size_t bufferSize_;
+};
+
+
+/**
+ * \brief Structure-of-arrays view of directions of a collection of physics
+ * objects
+ *
+ * Azimuthal angles are expected to lie in the range [-pi, pi].
+ */
+struct DirectionColumns {
+  /// Returns the number of objects
+  std::size_t size() const {
+    return eta.size();
+  }
+
+  /// Pseudorapidity and azimuthal angle
+  ColumnView<float> eta, phi;
+};
+
+
+/**
+ * \brief Structure-of-arrays view of the kinematics of a collection of
+ * physics objects
+ *
+ * Each column holds one property for all objects in the collection.
+ */
+struct KinematicColumns {
+  /// Returns the number of objects
+  std::size_t size() const {
+    return pt.size();
+  }
+
+  /// Returns the view of pseudorapidities and azimuthal angles
+  DirectionColumns Directions() const {
+    return {eta, phi};
+  }
+
+  /// Constructs the four-momentum of the object with given index
+  FourMomentum Momentum(std::size_t index) const {
+    FourMomentum p4;
+    p4.SetPtEtaPhiM(pt[index], eta[index], phi[index],
+                    (mass.size() > 0) ? mass[index] : 0.f);
+    return p4;
+  }
+
+  /// Transverse momentum, pseudorapidity, and azimuthal angle
+  ColumnView<float> pt, eta, phi;
+
+  /**
+   * \brief Masses
+   *
+   * Can be left empty for massless objects, such as photons.
+   */
+  ColumnView<float> mass;
+};
+
+
+/**
+ * \brief Selection mask for a collection of physics objects
+ *
+ * The mask is constructed with all objects selected. Requirements are then
+ * applied to whole columns at once. They are evaluated without branching, which
+ * allows the compiler to vectorize the loops. The resulting selection can be
+ * accessed per object or as a list of indices of selected objects.
+ *
+ * Example of usage:
+ * \code
+ * mask.Reset(pt.size());
+ * mask.Require(pt, [](float pt){return pt > 20.f;})
+ *     .Require(id, [](int id){return id >= 3;});
+ * for (int i : mask.Indices())
+ *   ...
+ * \endcode
+ */
+class SelectionMask {
+ public:
+  /// Resets the mask for a collection of given size, selecting all objects
+  void Reset(std::size_t size);
+
+  /**
+   * \brief Requires that the given predicate is satisfied by the values in a
+   * column
+   *
+   * The predicate must be a function of a single value that returns a boolean.
+   * The size of the column must match the size of the mask.
+   */
+  template <typename T, typename Predicate>
+  SelectionMask &Require(ColumnView<T> const &column, Predicate predicate);
+
+  /**
+   * \brief Requires that the given predicate is satisfied by the values in two
+   * columns
+   *
+   * The predicate is a function of two values, one from each column.
+   */
+  template <typename T1, typename T2, typename Predicate>
+  SelectionMask &Require(ColumnView<T1> const &column1,
+                         ColumnView<T2> const &column2, Predicate predicate);
+
+  /// Requires that the objects are also selected by another mask
+  SelectionMask &Require(SelectionMask const &other);
+
+  /**
+   * \brief Requires that the objects are separated from all objects in another
+   * collection
+   *
+   * \param[in] objects  Directions of objects in the collection described by
+   *   this mask.
+   * \param[in] others  Directions of objects to check against.
+   * \param[in] maxDR  Objects are deselected if their distance to any of
+   *   \c others in the (eta, phi) metric is smaller than this.
+   *
+   * The distances are computed for all objects at once, one object from
+   * \c others at a time.
+   */
+  SelectionMask &RequireNoOverlap(DirectionColumns const &objects,
+                                  DirectionColumns const &others,
+                                  double maxDR);
+
+  /// Returns indices of selected objects, in the increasing order
+  std::vector<int> const &Indices() const;
+
+  /// Checks if the object with given index is selected
+  bool operator[](std::size_t index) const {
+    return mask_[index];
+  }
+
+  /// Returns the size of the collection
+  std::size_t size() const {
+    return mask_.size();
+  }
+
+ private:
+  /// Flags indicating whether objects are selected
+  std::vector<uint8_t> mask_;
+
+  /// Indices of selected objects, computed lazily from \ref mask_
+  mutable std::vector<int> indices_;
+
+  /// Indicates whether \ref indices_ is up to date
+  mutable bool indicesValid_ = false;
+};
+
+
+template <typename T>
+ColumnView<T> ColumnReader<T>::View() const {
+  std::size_t const size = src_.GetSize();
+  if (size == 0)
+    return {};
+
+  T const *first = &src_.At(0);
+  if (&src_.At(size - 1) == first + (size - 1))
+    return {first, size};
+
+  if (bufferSize_ < size) {
+    buffer_.reset(new T[size]);
+    bufferSize_ = size;
+  }
+
+  for (std::size_t i = 0; i < size; ++i)
+    buffer_[i] = src_.At(i);
+
+  return {buffer_.get(), size};
+}
+
+
+template <typename T, typename Predicate>
+SelectionMask &SelectionMask::Require(
+    ColumnView<T> const &column, Predicate predicate) {
+  std::size_t const size = mask_.size();
+  uint8_t *mask = mask_.data();
+  T const *values = column.data();
+
+  for (std::size_t i = 0; i < size; ++i)
+    mask[i] &= uint8_t(predicate(values[i]));
+
+  indicesValid_ = false;
+  return *this;
+}
+
+
+template <typename T1, typename T2, typename Predicate>
+SelectionMask &SelectionMask::Require(
+    ColumnView<T1> const &column1, ColumnView<T2> const &column2,
+    Predicate predicate) {
+  std::size_t const size = mask_.size();
+  uint8_t *mask = mask_.data();
+  T1 const *values1 = column1.data();
+  T2 const *values2 = column2.data();
+
+  for (std::size_t i = 0; i < size; ++i)
+    mask[i] &= uint8_t(predicate(values1[i], values2[i]));
+
+  indicesValid_ = false;
+  return *this;
+}
+
+#endif  // HZZ2L2NU_INCLUDE_COLUMNS_H_
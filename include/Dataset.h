@@ -10,8 +10,11 @@
 #include <yaml-cpp/yaml.h>
 
 #include <TChain.h>
+#include <TObjArray.h>
 #include <TTreeReader.h>
 
+#include <BulkReader.h>
+#include <EventGraph.h>
 #include <Options.h>
 
 
@@ -188,6 +191,18 @@ class DatasetInfo {
  * object (meaning that \ref Reader, which has to be called for this, is not a
  * constant method). This can be thought of as a (dynamic) change in the content
  * of the dataset.
+ *
+ * Once all consumers have registered their branches, \ref SetUpCache should be
+ * called. TTreeReader then adds exactly the registered branches to the
+ * TTreeCache of the chain and stops its learning phase, and the size of the
+ * cache is adjusted to hold one cluster of these branches. Branches registered
+ * after this point are still read correctly but bypass the cache. Statistics
+ * on the use of the cache can be reported with \ref ReportReadStatistics.
+ *
+ * Scalar branches that are read in every event can be accessed with BulkValue
+ * instead of the TTreeReader. They are read basket by basket with the bulk I/O
+ * of ROOT by the BulkReader returned by \ref Bulk, which is kept synchronized
+ * with the current entry by \ref SetEntry and \ref NextEntry.
  */
 class Dataset {
  public:
@@ -203,6 +218,35 @@ class Dataset {
    */
   Dataset(DatasetInfo info, int skipFiles = 0, int maxFiles = -1);
 
+  /// Returns the reader for branches accessed with BulkValue
+  BulkReader &Bulk() {
+    return bulk_;
+  }
+
+  /**
+   * \brief Returns indices of entries at which clusters of the underlying
+   * trees start
+   *
+   * The indices are global, i.e. they are counted over the whole chain of
+   * selected files. The returned vector is sorted and terminated with the total
+   * number of entries, so that consecutive elements define half-open ranges of
+   * entries. These are natural boundaries at which the dataset can be split for
+   * parallel processing without decompressing the same baskets twice.
+   */
+  std::vector<int64_t> ClusterBoundaries();
+
+  /**
+   * \brief Returns the graph of per-event computations performed on this
+   * dataset
+   *
+   * The graph is not invalidated automatically when the current entry is
+   * changed. The code that changes it (normally Looper) must call
+   * EventGraph::Invalidate.
+   */
+  EventGraph &Graph() {
+    return graph_;
+  }
+
   /// Returns associated DatasetInfo object
   DatasetInfo const &Info() const {
     return info_;
@@ -215,7 +259,12 @@ class Dataset {
    * otherwise.
    */
   bool NextEntry() {
-    return reader_.Next();
+    bool const status = reader_.Next();
+
+    if (status)
+      bulk_.SetEntry(reader_.GetCurrentEntry());
+
+    return status;
   }
 
   /// Returns number of entries in the selected input files from the dataset
@@ -228,6 +277,12 @@ class Dataset {
     return reader_;
   }
 
+  /**
+   * \brief Reports the number of bytes read from the input files and the hit
+   * rate of the cache
+   */
+  void ReportReadStatistics();
+
   /// Returns paths to selected input files
   std::vector<std::string> const &SelectedFiles() const {
     return selectedFiles_;
@@ -236,9 +291,27 @@ class Dataset {
   /// Sets the current entry for the reader
   void SetEntry(int64_t index) {
     reader_.SetEntry(index);
+    bulk_.SetEntry(index);
   }
 
+  /**
+   * \brief Sets up TTreeCache for the branches registered so far
+   *
+   * Reads the given entry, which makes the reader add the registered branches
+   * to the cache, adds the branches read with BulkValue, and then sizes the
+   * cache so that it can hold the largest cluster of these branches in the
+   * first tree read. Must be called after all consumers have been constructed
+   * and before the event loop.
+   */
+  void SetUpCache(int64_t firstEntry);
+
  private:
+  /**
+   * \brief Computes the size of the cache needed to hold one cluster of the
+   * given branches in the current tree
+   */
+  int64_t ComputeCacheSize(TObjArray const *branches);
+
   /// Associated DatasetInfo object
   DatasetInfo info_;
 
@@ -250,6 +323,12 @@ class Dataset {
 
   /// Reader associated with \ref chain_
   TTreeReader reader_;
+
+  /// Reader for branches accessed with BulkValue
+  BulkReader bulk_;
+
+  /// Graph of per-event computations
+  EventGraph graph_;
 };
 
 #endif  // DATASET_H_
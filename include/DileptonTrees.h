@@ -9,8 +9,8 @@
 #include <boost/program_options.hpp>
 #include <TFile.h>
 #include <TTree.h>
-#include <TTreeReaderValue.h>
 
+#include <BulkReader.h>
 #include <EventTrees.h>
 #include <Dataset.h>
 #include <GenZZBuilder.h>
@@ -28,7 +28,8 @@
  * In addition, momenta and other properties of jets and leptons can be stored
  * if flag --more-vars is provided.
  *
- * Event weights are saved with the help of the base class EventTrees.
+ * Event weights are saved with the help of the base class EventTrees. All
+ * shape systematic variations can be evaluated in a single pass.
  */
 class DileptonTrees final : public EventTrees {
  public:
@@ -53,6 +54,12 @@ class DileptonTrees final : public EventTrees {
     kGEq2J
   };
 
+  /**
+   * \brief Performs the event selection and fills the output tree in the
+   * current shape variation
+   */
+  bool ProcessVariation();
+
   /**
    * \brief Performs selection on leptons
    *
@@ -84,14 +91,14 @@ class DileptonTrees final : public EventTrees {
 
   TriggerFilter triggerFilter_;
 
-  TTreeReaderValue<ULong64_t> srcEvent_;
+  BulkValue<ULong64_t> srcEvent_;
 
   Int_t leptonCat_, jetCat_, numPVGood_;
   Float_t llPt_, llEta_, llPhi_, llMass_;
   Float_t missPt_, missPhi_;
   Float_t mT_;
 
-  TTreeReaderValue<int> srcNumPVGood_;
+  BulkValue<int> srcNumPVGood_;
 
   ULong64_t event_;
   Float_t genMZZ_;
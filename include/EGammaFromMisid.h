@@ -12,6 +12,7 @@
 #include <TTree.h>
 #include <TTreeReaderValue.h>
 
+#include <BulkReader.h>
 #include <Dataset.h>
 // #include <EventNumberFilter.h>
 #include <EventTrees.h>
@@ -73,9 +74,9 @@ class EGammaFromMisid final : public EventTrees {
   std::optional<Int_t> datasetMaxPtG_;
   std::optional<Float_t> datasetLHEVptUpperLimitInc_;
 
-  TTreeReaderValue<UInt_t> srcRun_;
-  TTreeReaderValue<UInt_t> srcLumi_;
-  TTreeReaderValue<ULong64_t> srcEvent_;
+  BulkValue<UInt_t> srcRun_;
+  BulkValue<UInt_t> srcLumi_;
+  BulkValue<ULong64_t> srcEvent_;
 
   mutable std::unique_ptr<TTreeReaderValue<Float_t>> srcLHEVpt_;
   mutable std::unique_ptr<TTreeReaderValue<UInt_t>> numGenPart_;
@@ -95,7 +96,7 @@ class EGammaFromMisid final : public EventTrees {
   Float_t missPt_, missPhi_;
   // Float_t mT_;
 
-  TTreeReaderValue<int> srcNumPVGood_;
+  BulkValue<int> srcNumPVGood_;
 
   UInt_t run_, lumi_;
   ULong64_t event_;
@@ -13,7 +13,8 @@
 #include <TTreeReaderArray.h>
 
 #include <Dataset.h>
-#include <EventCache.h>
+#include <EventGraph.h>
+#include <GenParticleIndex.h>
 #include <Options.h>
 
 
@@ -32,8 +33,16 @@ class EWCorrectionWeight : public WeightBase {
    *
    * \param[in] dataset  Dataset that will be processed.
    * \param[in] options  Configuration options.
+   * \param[in] genParticles  Index of generator-level particles. The object
+   *   must have an appropriate life time.
    */
-  EWCorrectionWeight(Dataset &dataset, Options const &options);
+  EWCorrectionWeight(Dataset &dataset, Options const &options,
+                     GenParticleIndex const *genParticles);
+
+  /// Returns the node that represents this weight in the EventGraph
+  EventNode &GetNode() {
+    return node_;
+  }
 
   /**
    * \brief Returns the nominal weight for the current event
@@ -80,13 +89,16 @@ class EWCorrectionWeight : public WeightBase {
   /// The main function, returns the kfactor
   double getEwkCorrections(std::map<std::string,std::pair<TLorentzVector,TLorentzVector>> genLevelLeptons, double & error) const;
 
+  /// Reads all branches used in \ref Update, see EventGraph::SetPrefetch
+  void Prefetch() const;
+
   /// Updates cached \ref weightNominal_ and \ref weightError_;
   void Update() const;
 
   /// Selected type of EW correction
   Type correctionType_;
 
-  EventCache cache_;
+  EventNode node_;
 
   /// Cached nominal event weight
   mutable double weightNominal_;
@@ -103,9 +115,9 @@ class EWCorrectionWeight : public WeightBase {
 
   std::vector<std::vector<float>> ewTable_;
 
-  mutable TTreeReaderArray<float> genPartPt_, genPartEta_, genPartPhi_,
-    genPartMass_;
-  mutable TTreeReaderArray<int> genPartPdgId_, genPartIdxMother_;
+  /// Non-owning pointer to the index of generator-level particles
+  GenParticleIndex const *genParticles_;
+
   mutable TTreeReaderValue<Float_t> generatorX1_, generatorX2_;
   mutable TTreeReaderValue<Int_t> generatorId1_, generatorId2_;
 };
@@ -6,6 +6,7 @@
 #include <TTreeReaderArray.h>
 
 #include <CollectionBuilder.h>
+#include <Columns.h>
 #include <Dataset.h>
 #include <PhysicsObjects.h>
 #include <Options.h>
@@ -39,6 +40,9 @@ class ElectronBuilder : public CollectionBuilder<Electron> {
   /// Constructs electrons for the current event
   void Build() const override;
 
+  /// Reads all branches used in \ref Build, see EventGraph::SetPrefetch
+  void Prefetch() const;
+
   /// Minimal pt for loose electrons, GeV
   double minPtLoose_;
 
@@ -51,11 +55,14 @@ class ElectronBuilder : public CollectionBuilder<Electron> {
   /// Collection of electrons passing tight selection
   mutable std::vector<Electron> tightElectrons_;
 
-  mutable TTreeReaderArray<float> srcPt_, srcEta_, srcPhi_, srcMass_, srcDeltaEtaSc_;
+  /// Selections of loose and tight electrons in the input collection
+  mutable SelectionMask looseMask_, tightMask_;
+
+  ColumnReader<float> srcPt_, srcEta_, srcPhi_, srcMass_, srcDeltaEtaSc_;
   // mutable TTreeReaderArray<float> srcIsolation_;
-  mutable TTreeReaderArray<int> srcCharge_;
-  mutable TTreeReaderArray<bool> srcIdLoose_, srcIdTight_;
-  mutable TTreeReaderArray<float> srcECorr_;
+  ColumnReader<int> srcCharge_;
+  ColumnReader<bool> srcIdLoose_, srcIdTight_;
+  ColumnReader<float> srcECorr_;
 };
 
 
@@ -10,6 +10,7 @@
 #include <TTree.h>
 #include <TTreeReaderValue.h>
 
+#include <BulkReader.h>
 #include <Dataset.h>
 #include <EventTrees.h>
 // #include <GenPhotonBuilder.h>
@@ -45,9 +46,9 @@ class ElectronTrees final : public EventTrees {
   /// Indicates that additional variables should be stored
   bool storeMoreVariables_;
 
-  TTreeReaderValue<UInt_t> srcRun_;
-  TTreeReaderValue<UInt_t> srcLumi_;
-  TTreeReaderValue<ULong64_t> srcEvent_;
+  BulkValue<UInt_t> srcRun_;
+  BulkValue<UInt_t> srcLumi_;
+  BulkValue<ULong64_t> srcEvent_;
 
   mutable std::unique_ptr<TTreeReaderValue<Float_t>> srcLHEVpt_;
   mutable std::unique_ptr<TTreeReaderValue<UInt_t>> numGenPart_;
@@ -71,7 +72,7 @@ class ElectronTrees final : public EventTrees {
   Float_t electronMetDeltaPhi_;
   Float_t electronMetMt_;
 
-  TTreeReaderValue<int> srcNumPVGood_;
+  BulkValue<int> srcNumPVGood_;
 
   UInt_t run_, lumi_;
   ULong64_t event_;
@@ -0,0 +1,223 @@
+#ifndef HZZ2L2NU_INCLUDE_EVENTGRAPH_H_
+#define HZZ2L2NU_INCLUDE_EVENTGRAPH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+class ShapeSyst;
+
+
+/**
+ * \brief Dependency graph of per-event computations
+ *
+ * Every component that computes something once per event (a collection
+ * builder, an event weight, etc.) is represented by a node in this graph. A
+ * node declares the nodes whose results it uses as its inputs. When the current
+ * entry in the dataset changes, the graph is invalidated once, with
+ * \ref Invalidate. After that, the first request for the result of a node
+ * evaluates it, after evaluating its inputs, and later requests in the same
+ * event do nothing. Thus the evaluation is lazy and follows the topological
+ * order of the graph.
+ *
+ * A node can be associated with a ShapeSyst object. Such a node is also
+ * evaluated anew when the current shape variation changes. Evaluation of nodes
+ * of this type must only be requested from the thread that runs the event loop.
+ *
+ * Some nodes can be scheduled for eager evaluation with \ref ScheduleEager.
+ * If the number of threads is set to a value larger than 1 with
+ * \ref SetNumThreads, \ref EvaluateEager evaluates these nodes and their inputs
+ * concurrently on a small pool of threads, respecting the dependencies. This is
+ * intended for independent components, such as builders of leptons and
+ * generator-level weights. Since TTreeReader reads branches lazily and is not
+ * thread-safe, nodes to be evaluated concurrently must provide a prefetch
+ * function (see \ref SetPrefetch) that touches all branches they read. These
+ * functions are called serially before the concurrent evaluation starts, after
+ * which accessing the branches in the same entry involves no reading. Nodes
+ * that do not provide a prefetch function are evaluated serially. With a single
+ * thread, which is the default, \ref EvaluateEager does nothing and all nodes
+ * are evaluated lazily.
+ */
+class EventGraph {
+ public:
+  EventGraph();
+  ~EventGraph() noexcept;
+
+  /**
+   * \brief Adds a new node to the graph
+   *
+   * \param[in] name  Name of the node, used in diagnostic messages.
+   * \param[in] evaluate  Function that performs the computation for the
+   *   current event.
+   * \param[in] shapeSyst  If not nullptr, the node is also evaluated anew when
+   *   the current shape variation changes.
+   * \return Index of the new node.
+   */
+  int AddNode(std::string name, std::function<void()> evaluate,
+              ShapeSyst const *shapeSyst = nullptr);
+
+  /**
+   * \brief Declares that a node uses the result of another one
+   *
+   * Throws an exception if this would create a cycle.
+   */
+  void AddInput(int node, int input);
+
+  /// Makes sure that the given node has been evaluated for the current event
+  void Evaluate(int node);
+
+  /**
+   * \brief Evaluates nodes scheduled for eager evaluation
+   *
+   * Does nothing unless the number of threads is larger than 1.
+   */
+  void EvaluateEager();
+
+  /**
+   * \brief Marks all nodes as outdated
+   *
+   * Must be called whenever the current entry in the dataset changes.
+   */
+  void Invalidate() {
+    ++generation_;
+  }
+
+  /// Schedules the given node for eager evaluation, see \ref EvaluateEager
+  void ScheduleEager(int node);
+
+  /// Sets the number of threads to be used in \ref EvaluateEager
+  void SetNumThreads(int numThreads);
+
+  /**
+   * \brief Sets the function to prefetch inputs of the given node
+   *
+   * The function should access all branches that the node reads, so that
+   * subsequent evaluation of the node in the same entry does not trigger any
+   * reading from the tree.
+   */
+  void SetPrefetch(int node, std::function<void()> prefetch);
+
+ private:
+  /// Pool of threads used in \ref EvaluateEager
+  class TaskPool;
+
+  /// Node of the graph
+  struct Node {
+    /// Name used in diagnostic messages
+    std::string name;
+
+    std::function<void()> evaluate, prefetch;
+
+    /// Non-owning pointer to shape variations. May be nullptr.
+    ShapeSyst const *shapeSyst;
+
+    /// Indices of nodes whose results this one uses
+    std::vector<int> inputs;
+
+    /**
+     * \brief Generation and shape variation for which the node has been
+     * evaluated, combined as computed by \ref EventGraph::StateKey
+     */
+    std::atomic<uint64_t> evaluatedKey;
+
+    /**
+     * \brief Serializes evaluation of this node
+     *
+     * The mutex is recursive, and together with flag \ref evaluating, it
+     * allows the evaluation function to access the results of the node itself.
+     */
+    std::recursive_mutex mutex;
+
+    /// Indicates whether the node is being evaluated
+    bool evaluating;
+  };
+
+  /// Checks if \c target can be reached from \c source by following inputs
+  bool IsReachable(int source, int target) const;
+
+  /**
+   * \brief Combines the current generation and the current shape variation
+   * for the given node into a single number
+   */
+  uint64_t StateKey(Node const &node) const;
+
+  /// Appends the given node and all its inputs to the list in topological order
+  void CollectInputs(int node, std::vector<int> &order,
+                     std::vector<uint8_t> &visited) const;
+
+  /// Nodes of the graph
+  std::vector<std::unique_ptr<Node>> nodes_;
+
+  /// Indices of nodes scheduled for eager evaluation
+  std::vector<int> eagerNodes_;
+
+  /// Number of times the graph has been invalidated
+  uint64_t generation_;
+
+  /// Number of threads to be used in \ref EvaluateEager
+  int numThreads_;
+
+  /// Pool of threads, created on the first concurrent evaluation
+  std::unique_ptr<TaskPool> pool_;
+};
+
+
+/**
+ * \brief Handle to a node in an EventGraph
+ *
+ * Components that perform per-event computations hold an object of this class
+ * and call \ref Evaluate before accessing their cached results. The evaluation
+ * function usually captures \c this, and therefore components holding a node
+ * can be neither copied nor moved.
+ */
+class EventNode {
+ public:
+  /**
+   * \brief Constructor
+   *
+   * Adds a new node to the given graph. See EventGraph::AddNode for the
+   * description of the parameters.
+   */
+  EventNode(EventGraph &graph, std::string name, std::function<void()> evaluate,
+            ShapeSyst const *shapeSyst = nullptr)
+      : graph_{graph},
+        id_{graph.AddNode(std::move(name), std::move(evaluate), shapeSyst)} {}
+
+  EventNode(EventNode const &) = delete;
+  EventNode &operator=(EventNode const &) = delete;
+
+  /// Declares that this node uses the result of the given one
+  void AddInput(EventNode const &input) {
+    graph_.AddInput(id_, input.id_);
+  }
+
+  /// Makes sure the node has been evaluated for the current event
+  void Evaluate() const {
+    graph_.Evaluate(id_);
+  }
+
+  /// Schedules the node for eager evaluation
+  void ScheduleEager() {
+    graph_.ScheduleEager(id_);
+  }
+
+  /// Sets the function to prefetch inputs of the node
+  void SetPrefetch(std::function<void()> prefetch) {
+    graph_.SetPrefetch(id_, std::move(prefetch));
+  }
+
+ private:
+  /// Graph to which the node belongs
+  EventGraph &graph_;
+
+  /// Index of the node in the graph
+  int id_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_EVENTGRAPH_H_
@@ -5,9 +5,9 @@
 #include <unordered_map>
 #include <map>
 
-#include <TTreeReaderValue.h>
 #include <TTreeReaderArray.h>
 
+#include <BulkReader.h>
 #include <Dataset.h>
 
 
@@ -56,9 +56,9 @@ class EventNumberFilter {
   RunMap runMap_;
   mutable RunMap::const_iterator eventMap_;
 
-  mutable TTreeReaderValue<UInt_t> run_;
-  mutable TTreeReaderValue<UInt_t> lumiBlock_;
-  mutable TTreeReaderValue<ULong64_t> event_;
+  BulkValue<UInt_t> run_;
+  BulkValue<UInt_t> lumiBlock_;
+  BulkValue<ULong64_t> event_;
 
 };
 
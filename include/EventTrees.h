@@ -1,6 +1,7 @@
 #ifndef HZZ2L2NU_INCLUDE_EVENTTREES_H_
 #define HZZ2L2NU_INCLUDE_EVENTTREES_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -8,6 +9,7 @@
 #include <TTree.h>
 
 #include <AnalysisCommon.h>
+#include <AsyncTreeWriter.h>
 #include <Dataset.h>
 #include <Options.h>
 
@@ -23,6 +25,20 @@
  * <tt>--syst=weights</tt> is provided, nominal weight as well as weights for
  * all registered weight-based systematic variations are stored. The latter ones
  * are saved as full as opposed to relative weights.
+ *
+ * If the derived class supports it, all shape systematic variations can be
+ * evaluated in a single pass with <tt>--syst=shapes</tt> (see ShapeSyst). In
+ * that case a separate tree is produced for each variation. The tree for the
+ * nominal configuration has the name given to the constructor, and the names of
+ * other trees are obtained by adding the label of the variation, separated with
+ * an underscore (e.g. "Vars_jec_up"). The derived class should evaluate its
+ * selection for every variation with the help of method
+ * \ref ForEachShapeVariation.
+ *
+ * With flag <tt>--pipeline</tt>, the trees are filled in a separate thread with
+ * the help of AsyncTreeWriter. All branches must then be added in the
+ * constructor of the derived class, i.e. before the first call to
+ * \ref FillTree.
  */
 class EventTrees : public AnalysisCommon {
  public:
@@ -30,9 +46,13 @@ class EventTrees : public AnalysisCommon {
    * \brief Contructor
    *
    * Argument \c treeName specifies the name for the tree that will be produced.
+   * Flag \c supportsShapeVariations indicates whether the derived class
+   * evaluates multiple shape variations with \ref ForEachShapeVariation. If it
+   * does not and they have been requested, an exception is thrown.
    */
   EventTrees(Options const &options, Dataset &dataset,
-             std::string const treeName = "Vars");
+             std::string const treeName = "Vars",
+             bool supportsShapeVariations = false);
 
   /// If the file is simulations, create the branch with weights
   void CreateWeightBranches();
@@ -41,19 +61,33 @@ class EventTrees : public AnalysisCommon {
   void PostProcessing();
 
  protected:
-  /// Adds a new branch to the underlying tree
+  /// Adds a new branch to the underlying trees
   template<typename... Args>
   void AddBranch(Args... args) {
-    tree_->Branch(args...);
+    for (auto *tree : trees_)
+      tree->Branch(args...);
   }
 
   /**
-   * \brief Fills the underlying tree
+   * \brief Fills the underlying tree for the current shape variation
    *
    * Event weights are set automatically.
    */
   void FillTree();
 
+  /**
+   * \brief Evaluates given selection in all shape variations
+   *
+   * \param[in] selection  Callable without arguments that returns a boolean.
+   *   It is called once for each shape variation, after the variation has been
+   *   selected as the current one.
+   * \return True if the selection is passed in at least one of the variations.
+   *
+   * After the call the nominal variation is selected again.
+   */
+  template<typename Selection>
+  bool ForEachShapeVariation(Selection selection);
+
  private:
   /// Indicates whether variations in event weights should be stored
   bool storeWeightSyst_;
@@ -61,8 +95,12 @@ class EventTrees : public AnalysisCommon {
   /// Output file
   TFile outputFile_;
 
-  /// Non-owning pointer to the output tree
-  TTree *tree_;
+  /**
+   * \brief Non-owning pointers to the output trees
+   *
+   * The trees are indexed in the same way as variations in ShapeSyst.
+   */
+  std::vector<TTree *> trees_;
 
   /// Buffer to save the nominal event weight
   Float_t weight_;
@@ -74,7 +112,31 @@ class EventTrees : public AnalysisCommon {
    * nominal one.
    */
   std::vector<Float_t> systWeights_;
+
+  /**
+   * \brief Buffer for the nominal and relative weights filled with
+   * WeightCollector::FillVariations
+   */
+  std::vector<float> weightBuffer_;
+
+  /// Writer that fills the trees in a separate thread. May be null.
+  std::unique_ptr<AsyncTreeWriter> writer_;
 };
 
+
+template<typename Selection>
+bool EventTrees::ForEachShapeVariation(Selection selection) {
+  bool passed = false;
+
+  for (int i = 0; i < shapeSyst_.NumVariations(); ++i) {
+    shapeSyst_.SetCurrent(i);
+    if (selection())
+      passed = true;
+  }
+
+  shapeSyst_.SetCurrent(0);
+  return passed;
+}
+
 #endif  // HZZ2L2NU_INCLUDE_EVENTTREES_H_
 
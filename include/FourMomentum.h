@@ -0,0 +1,236 @@
+#ifndef HZZ2L2NU_INCLUDE_FOURMOMENTUM_H_
+#define HZZ2L2NU_INCLUDE_FOURMOMENTUM_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include <TLorentzVector.h>
+
+
+/**
+ * \brief Lightweight four-momentum
+ *
+ * This is a non-polymorphic replacement for TLorentzVector, which is used for
+ * physics objects. It mimics the subset of the interface of TLorentzVector used
+ * in this package, including its conventions for degenerate vectors.
+ *
+ * When a vector is set from pt, pseudorapidity, azimuthal angle, and mass,
+ * they are stored exactly, together with the Cartesian components computed
+ * from them, so that reading either representation does not involve any
+ * computation. When a vector is set from Cartesian components (for example, as
+ * a sum of two other vectors), only they are stored, and the polar components
+ * are computed on every request, as in TLorentzVector. Thus accumulating a sum
+ * of many vectors does not involve any transcendental functions. Rescaling
+ * with a non-negative factor does not involve them either. Const methods never
+ * write to the object, and the same vector can be read from several threads
+ * concurrently.
+ *
+ * Conversion to TLorentzVector is available with method \ref ToTLorentzVector
+ * and is meant for interfaces with external code only.
+ */
+class FourMomentum {
+ public:
+  /// Constructs a null vector
+  FourMomentum() noexcept
+      : pt_{0.}, eta_{0.}, phi_{0.}, m_{0.},
+        px_{0.}, py_{0.}, pz_{0.}, e_{0.}, polarValid_{true} {}
+
+  /// Constructs a vector from Cartesian components
+  FourMomentum(double px, double py, double pz, double e) noexcept
+      : pt_{0.}, eta_{0.}, phi_{0.}, m_{0.},
+        px_{px}, py_{py}, pz_{pz}, e_{e}, polarValid_{false} {}
+
+  /// Constructs a vector from a TLorentzVector
+  explicit FourMomentum(TLorentzVector const &p4) noexcept
+      : FourMomentum{p4.Px(), p4.Py(), p4.Pz(), p4.E()} {}
+
+  /// Returns transverse momentum
+  double Pt() const {
+    return (polarValid_) ? pt_ : std::hypot(px_, py_);
+  }
+
+  /// Returns pseudorapidity
+  double Eta() const {
+    return (polarValid_) ? eta_ : EtaFromCartesian();
+  }
+
+  /// Returns azimuthal angle, in the range [-pi, pi]
+  double Phi() const {
+    // Follow the convention of TVector3 for a null transverse momentum
+    if (polarValid_)
+      return phi_;
+    else
+      return (px_ == 0. and py_ == 0.) ? 0. : std::atan2(py_, px_);
+  }
+
+  /**
+   * \brief Returns invariant mass
+   *
+   * Same as in TLorentzVector, the mass is negative for space-like vectors.
+   */
+  double M() const {
+    return (polarValid_) ? m_ : MassFromCartesian();
+  }
+
+  /// Returns x component of the momentum
+  double Px() const {
+    return px_;
+  }
+
+  /// Returns y component of the momentum
+  double Py() const {
+    return py_;
+  }
+
+  /// Returns z component of the momentum
+  double Pz() const {
+    return pz_;
+  }
+
+  /// Returns energy
+  double E() const {
+    return e_;
+  }
+
+  /// Returns magnitude of the momentum
+  double P() const {
+    return std::sqrt(px_ * px_ + py_ * py_ + pz_ * pz_);
+  }
+
+  /**
+   * \brief Sets the vector from pt, pseudorapidity, azimuthal angle, and mass
+   *
+   * Same as in TLorentzVector, the absolute value of pt is used. A negative
+   * mass describes a space-like vector.
+   */
+  void SetPtEtaPhiM(double pt, double eta, double phi, double m) {
+    pt_ = std::abs(pt);
+    eta_ = eta;
+    phi_ = phi;
+    m_ = m;
+    polarValid_ = true;
+    UpdateCartesian();
+  }
+
+  /// Sets the vector from Cartesian components
+  void SetPxPyPzE(double px, double py, double pz, double e) {
+    px_ = px;
+    py_ = py;
+    pz_ = pz;
+    e_ = e;
+    polarValid_ = false;
+  }
+
+  FourMomentum &operator+=(FourMomentum const &other) {
+    SetPxPyPzE(px_ + other.px_, py_ + other.py_, pz_ + other.pz_,
+               e_ + other.e_);
+    return *this;
+  }
+
+  FourMomentum &operator-=(FourMomentum const &other) {
+    SetPxPyPzE(px_ - other.px_, py_ - other.py_, pz_ - other.pz_,
+               e_ - other.e_);
+    return *this;
+  }
+
+  /**
+   * \brief Multiplies all components by a number
+   *
+   * For a non-negative factor, no transcendental functions are evaluated.
+   */
+  FourMomentum &operator*=(double factor);
+
+  FourMomentum operator+(FourMomentum const &other) const {
+    FourMomentum result{*this};
+    result += other;
+    return result;
+  }
+
+  FourMomentum operator-(FourMomentum const &other) const {
+    FourMomentum result{*this};
+    result -= other;
+    return result;
+  }
+
+  FourMomentum operator*(double factor) const {
+    FourMomentum result{*this};
+    result *= factor;
+    return result;
+  }
+
+  /// Converts to a TLorentzVector
+  TLorentzVector ToTLorentzVector() const {
+    return TLorentzVector{px_, py_, pz_, e_};
+  }
+
+ private:
+  /// Computes Cartesian components from the polar ones
+  void UpdateCartesian() {
+    px_ = pt_ * std::cos(phi_);
+    py_ = pt_ * std::sin(phi_);
+    pz_ = pt_ * std::sinh(eta_);
+    double const p2 = px_ * px_ + py_ * py_ + pz_ * pz_;
+    double const m = m_;
+    if (m >= 0.)
+      e_ = std::sqrt(p2 + m * m);
+    else
+      e_ = std::sqrt(std::max(p2 - m * m, 0.));
+  }
+
+  /// Computes pseudorapidity from the Cartesian components
+  double EtaFromCartesian() const;
+
+  /// Computes mass from the Cartesian components
+  double MassFromCartesian() const {
+    double const p = P();
+    double const m2 = (e_ - p) * (e_ + p);
+    return (m2 < 0.) ? -std::sqrt(-m2) : std::sqrt(m2);
+  }
+
+  /**
+   * \brief Polar components
+   *
+   * Only meaningful if \ref polarValid_ is true.
+   */
+  double pt_, eta_, phi_, m_;
+
+  /// Cartesian components
+  double px_, py_, pz_, e_;
+
+  /// Indicates whether the vector has been set from the polar components
+  bool polarValid_;
+};
+
+
+inline double FourMomentum::EtaFromCartesian() const {
+  // Follow the conventions of TVector3 for degenerate cases
+  double const p = P();
+  double const cosTheta = (p == 0.) ? 1. : pz_ / p;
+
+  if (cosTheta * cosTheta < 1.)
+    return -0.5 * std::log((1. - cosTheta) / (1. + cosTheta));
+  else if (pz_ == 0.)
+    return 0.;
+  else
+    return (pz_ > 0.) ? 10e10 : -10e10;
+}
+
+
+inline FourMomentum &FourMomentum::operator*=(double factor) {
+  if (factor >= 0.) {
+    if (polarValid_) {
+      pt_ *= factor;
+      m_ *= factor;
+    }
+
+    px_ *= factor;
+    py_ *= factor;
+    pz_ *= factor;
+    e_ *= factor;
+  } else
+    SetPxPyPzE(px_ * factor, py_ * factor, pz_ * factor, e_ * factor);
+
+  return *this;
+}
+
+#endif  // HZZ2L2NU_INCLUDE_FOURMOMENTUM_H_
@@ -6,6 +6,7 @@
 #include <TTreeReaderArray.h>
 
 #include <CollectionBuilder.h>
+#include <Columns.h>
 #include <Dataset.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -25,8 +26,11 @@ class GenJetBuilder : public CollectionBuilder<GenJet> {
 
   /// Collection of generator-level jets
   mutable std::vector<GenJet> jets_;
-  
-  mutable TTreeReaderArray<float> srcPt_, srcEta_, srcPhi_, srcMass_;
+
+  /// Selection of jets in the input collection that pass angular cleaning
+  mutable SelectionMask mask_;
+
+  ColumnReader<float> srcPt_, srcEta_, srcPhi_, srcMass_;
 };
 
 #endif  // GENJETBUILDER_H_
@@ -0,0 +1,288 @@
+#ifndef HZZ2L2NU_INCLUDE_GENPARTICLEINDEX_H_
+#define HZZ2L2NU_INCLUDE_GENPARTICLEINDEX_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <Columns.h>
+#include <Dataset.h>
+#include <EventGraph.h>
+#include <FourMomentum.h>
+#include <Utils.h>
+
+
+/**
+ * \brief Per-event index of generator-level particles
+ *
+ * This class provides access to the generator-level particles stored in the
+ * GenPart_* branches of NanoAOD. When it is accessed for the first time in an
+ * event, it builds a number of auxiliary structures, which are then shared by
+ * all consumers:
+ * - lists of particles with given PDG ID or status,
+ * - links from particles to their daughters (links to mothers are stored in the
+ *   input),
+ * - a uniform grid in (eta, phi), which allows to find particles within a cone
+ *   without checking all particles in the event.
+ *
+ * Particles are identified by their indices in the input arrays. All lists of
+ * indices provided by this class are sorted in the increasing order.
+ *
+ * This class must only be constructed for simulation.
+ */
+class GenParticleIndex {
+ public:
+  /// Constructor
+  GenParticleIndex(Dataset &dataset);
+
+  /// Returns the node that represents this index in the EventGraph
+  EventNode const &GetNode() const {
+    return node_;
+  }
+
+  /// \copydoc GetNode
+  EventNode &GetNode() {
+    return node_;
+  }
+
+  /// Returns the number of particles in the current event
+  int Size() const;
+
+  /// Returns kinematics of all particles
+  KinematicColumns const &Kinematics() const;
+
+  /// Returns four-momentum of the particle with given index
+  FourMomentum Momentum(int index) const {
+    return Kinematics().Momentum(index);
+  }
+
+  /// Returns PDG ID of the particle with given index
+  int PdgId(int index) const {
+    return pdgId_[index];
+  }
+
+  /// Returns status of the particle with given index
+  int Status(int index) const {
+    return status_[index];
+  }
+
+  /// Returns status flags of the particle with given index
+  int StatusFlags(int index) const {
+    return statusFlags_[index];
+  }
+
+  /// Returns index of the mother of given particle or -1 if there is none
+  int Mother(int index) const {
+    return mother_[index];
+  }
+
+  /**
+   * \brief Returns PDG ID of the mother of given particle
+   *
+   * If the particle has no mother, returns 0.
+   */
+  int MotherPdgId(int index) const {
+    int const mother = mother_[index];
+    return (mother >= 0) ? pdgId_[mother] : 0;
+  }
+
+  /// Returns indices of daughters of the particle with given index
+  ColumnView<int> Daughters(int index) const;
+
+  /// Returns indices of all particles with given (signed) PDG ID
+  ColumnView<int> WithPdgId(int pdgId) const;
+
+  /// Returns indices of all particles with given status
+  ColumnView<int> WithStatus(int status) const;
+
+  /**
+   * \brief Calls the given function for all particles within a cone
+   *
+   * \param[in] eta, phi  Direction of the axis of the cone.
+   * \param[in] maxDR  Radius of the cone in the (eta, phi) metric. Only
+   *   particles with the angular distance strictly smaller than it are
+   *   considered.
+   * \param[in] visit  Function that is called as <tt>visit(index, dR2)</tt>
+   *   for each particle found, where \c dR2 is the squared angular distance to
+   *   the axis. If it returns false, the search is stopped. The order in which
+   *   the particles are visited is unspecified.
+   */
+  template <typename Visitor>
+  void ForEachInCone(double eta, double phi, double maxDR,
+                     Visitor visit) const;
+
+  /**
+   * \brief Finds the particle closest to the given direction among ones that
+   * satisfy a predicate
+   *
+   * \param[in] eta, phi  Direction of the reference axis.
+   * \param[in] maxDR  Maximal allowed angular distance (exclusive).
+   * \param[in] predicate  Function that is called with the index of a
+   *   particle and returns a boolean that indicates if the particle should be
+   *   considered.
+   * \return Index of the found particle or -1 if none is found. In case of a
+   *   tie, the particle with the smallest index is chosen.
+   */
+  template <typename Predicate>
+  int FindClosest(double eta, double phi, double maxDR,
+                  Predicate predicate) const;
+
+ private:
+  /// Width of cells of the grid in eta, and approximate width in phi
+  static constexpr double kCellSize_ = 0.2;
+
+  /// Range in eta covered by the grid. Cells at the edges are open-ended.
+  static constexpr double kMaxAbsEta_ = 5.;
+
+  /// Rebuilds the index for the current event if needed
+  void Update() const {
+    node_.Evaluate();
+  }
+
+  /// Rebuilds the index for the current event
+  void Build() const;
+
+  /// Reads all input branches in the current event
+  void Prefetch() const;
+
+  /// Index of the grid cell along eta for given pseudorapidity
+  int EtaCell(double eta) const;
+
+  /// Index of the grid cell along phi for given azimuthal angle
+  int PhiCell(double phi) const;
+
+  /// Returns the list of indices for the given key in a grouped index
+  static ColumnView<int> FindGroup(
+      std::vector<std::pair<int, int>> const &groups,
+      std::vector<int> const &indices, int key);
+
+  /**
+   * \brief Fills a grouped index
+   *
+   * Particles are grouped by the value of the key. In the output,
+   * \c groups contains pairs of key values and offsets of the corresponding
+   * ranges in \c indices. The last element of \c groups is a sentinel.
+   */
+  static void BuildGroups(ColumnView<int> const &keys,
+                          std::vector<std::pair<int, int>> &groups,
+                          std::vector<int> &indices);
+
+  /// Number of cells along eta and phi
+  int numEtaCells_, numPhiCells_;
+
+  /// Width of a cell in phi
+  double phiCellSize_;
+
+  /// Node in the EventGraph that calls \ref Build
+  EventNode node_;
+
+  /// Views of input columns in the current event
+  mutable KinematicColumns kinematics_;
+  mutable ColumnView<int> pdgId_, status_, statusFlags_, mother_;
+
+  /// Grouping of particles by PDG ID and status
+  mutable std::vector<std::pair<int, int>> pdgIdGroups_, statusGroups_;
+  mutable std::vector<int> pdgIdIndices_, statusIndices_;
+
+  /**
+   * \brief Links to daughters
+   *
+   * Daughters of particle i are given by the range
+   * [daughterOffsets_[i], daughterOffsets_[i + 1]) in \ref daughters_.
+   */
+  mutable std::vector<int> daughterOffsets_, daughters_;
+
+  /**
+   * \brief Particles sorted by grid cells
+   *
+   * Particles in the cell with global index c are given by the range
+   * [cellOffsets_[c], cellOffsets_[c + 1]) in \ref cellParticles_. The global
+   * index is computed as <tt>etaCell * numPhiCells_ + phiCell</tt>.
+   */
+  mutable std::vector<int> cellOffsets_, cellParticles_;
+
+  /// Global indices of cells for all particles, used when building the grid
+  mutable std::vector<int> particleCells_;
+
+  ColumnReader<float> srcPt_, srcEta_, srcPhi_, srcMass_;
+  ColumnReader<int> srcPdgId_, srcStatus_, srcStatusFlags_, srcMother_;
+};
+
+
+inline int GenParticleIndex::EtaCell(double eta) const {
+  if (not (eta > -kMaxAbsEta_))
+    return 0;
+  else if (not (eta < kMaxAbsEta_))
+    return numEtaCells_ - 1;
+  else
+    return std::min(int((eta + kMaxAbsEta_) / kCellSize_), numEtaCells_ - 1);
+}
+
+
+inline int GenParticleIndex::PhiCell(double phi) const {
+  int const cell = int(std::floor(phi / phiCellSize_)) % numPhiCells_;
+  return (cell < 0) ? cell + numPhiCells_ : cell;
+}
+
+
+template <typename Visitor>
+void GenParticleIndex::ForEachInCone(
+    double eta, double phi, double maxDR, Visitor visit) const {
+  Update();
+  double const maxDR2 = std::pow(maxDR, 2);
+
+  int const firstEtaCell = EtaCell(eta - maxDR);
+  int const lastEtaCell = EtaCell(eta + maxDR);
+
+  // Range of cells in phi to check. If the cone covers the full circle, check
+  // every cell exactly once.
+  int const phiReach = int(std::ceil(maxDR / phiCellSize_));
+  int firstPhiCell, numPhiSteps;
+
+  if (2 * phiReach + 1 >= numPhiCells_) {
+    firstPhiCell = 0;
+    numPhiSteps = numPhiCells_;
+  } else {
+    firstPhiCell = PhiCell(phi) - phiReach + numPhiCells_;
+    numPhiSteps = 2 * phiReach + 1;
+  }
+
+  for (int etaCell = firstEtaCell; etaCell <= lastEtaCell; ++etaCell) {
+    for (int step = 0; step < numPhiSteps; ++step) {
+      int const phiCell = (firstPhiCell + step) % numPhiCells_;
+      int const cell = etaCell * numPhiCells_ + phiCell;
+
+      for (int k = cellOffsets_[cell]; k < cellOffsets_[cell + 1]; ++k) {
+        int const index = cellParticles_[k];
+        double const dR2 = utils::DeltaR2(
+            eta, phi, kinematics_.eta[index], kinematics_.phi[index]);
+
+        if (dR2 < maxDR2 and not visit(index, dR2))
+          return;
+      }
+    }
+  }
+}
+
+
+template <typename Predicate>
+int GenParticleIndex::FindClosest(
+    double eta, double phi, double maxDR, Predicate predicate) const {
+  int closest = -1;
+  double minDR2 = std::numeric_limits<double>::infinity();
+
+  ForEachInCone(eta, phi, maxDR, [&](int index, double dR2){
+    if ((dR2 < minDR2 or (dR2 == minDR2 and index < closest))
+        and predicate(index)) {
+      closest = index;
+      minDR2 = dR2;
+    }
+    return true;
+  });
+
+  return closest;
+}
+
+#endif  // HZZ2L2NU_INCLUDE_GENPARTICLEINDEX_H_
@@ -2,8 +2,8 @@
 #define HZZ2L2NU_INCLUDE_GENPHOTONBUILDER_H_
 
 #include <Dataset.h>
+#include <FourMomentum.h>
 
-#include <TLorentzVector.h>
 #include <TTreeReaderArray.h>
 
 
@@ -17,7 +17,7 @@ class GenPhotonBuilder {
   GenPhotonBuilder(Dataset &dataset);
 
   /// Computes four-momentum of the photon
-  TLorentzVector P4Gamma() const;
+  FourMomentum P4Gamma() const;
 
  private:
   mutable TTreeReaderArray<Int_t> srcPdgId_;
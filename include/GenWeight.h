@@ -2,14 +2,17 @@
 #define HZZ2L2NU_INCLUDE_GENWEIGHT_H_
 
 #include <array>
-#include <map>
 #include <optional>
 #include <tuple>
 #include <utility>
+#include <vector>
 
-#include <TTreeReaderArray.h>
+#include <TTreeReaderValue.h>
 
+#include <BulkReader.h>
+#include <Columns.h>
 #include <Dataset.h>
+#include <EventGraph.h>
 #include <Options.h>
 #include <WeightBase.h>
 
@@ -24,6 +27,9 @@
  * dedicated methods. These are always relative weights, which should be applied
  * in addition to the nominal one. The standard weight interface is also
  * implemented.
+ *
+ * All variations are computed together, once per event, on the first request
+ * for any of them.
  */
 class GenWeight : public WeightBase {
 public:
@@ -70,6 +76,8 @@ public:
       return NominalWeight() * RelWeight(defaultVariationIndex_);
   }
 
+  void FillVariations(float *weights) const override;
+
   /**
    * \brief Returns relative weight for requested systematic variation
    *
@@ -113,9 +121,36 @@ private:
     MC  ///< MC replicas
   };
 
+  /**
+   * \brief Indices of weights for variations in the renormalization and
+   * factorization scales in the ME
+   *
+   * The array is indexed with the directions of the variations in the two
+   * scales, in this order. Values are indices of the corresponding weights in
+   * the source array. The convention for the weights is extracted from [1].
+   * [1] https://cms-nanoaod-integration.web.cern.ch/integration/master-102X/mc80X_doc.html#LHEScaleWeight
+   */
+  static constexpr std::array<std::array<int, 3>, 3> kMEScaleIndices_{{
+    // Var::Nominal, Var::Up, Var::Down for the factorization scale
+    {4, 5, 3},  // Var::Nominal for the renormalization scale
+    {7, 8, 6},  // Var::Up
+    {1, 2, 0}   // Var::Down
+  }};
+
   void InitializeLheScale(Dataset &dataset);
   void InitializePdf(Dataset &dataset);
 
+  /**
+   * \brief Computes the sum and the sum of squares of the given weights
+   *
+   * Several independent partial sums are accumulated, which allows the
+   * compiler to vectorize the loop.
+   */
+  static std::pair<double, double> SumWeights(float const *weights, int size);
+
+  /// Computes all relative weights for the current event
+  void Update() const;
+
   /// Helper function to look up metadata about a PDF set from YAML file
   static std::tuple<PdfVarType, std::optional<std::array<int, 2>>, double>
   LookUpPdfSet(int lhapdf);
@@ -131,13 +166,6 @@ private:
   /// Indicates whether LHE scale variations are available
   bool lheScaleWeightsPresent_;
 
-  /**
-   * \brief Mapping from variations in the renormalization and factorization
-   * scales in the ME to the index of the corresponding weight in the source
-   * array.
-   */
-  std::map<std::pair<Var, Var>, int> meScaleIndices_;
-
   /// Indicates whether PDF weights are available
   bool pdfWeightsPresent_;
 
@@ -179,10 +207,34 @@ private:
    */
   int defaultVariationIndex_;
 
+  /// Node in the EventGraph that calls \ref Update
+  EventNode node_;
+
+  /**
+   * \brief Relative weights for all variations in the ME scales
+   *
+   * Indexed in the same way as the source array. Set to 1 if the variations
+   * are not available.
+   */
+  mutable std::array<double, 9> meScaleWeights_;
+
+  /// Absolute change in the relative weight for the combined PDF variation
+  mutable double pdfDeltaWeight_;
+
+  /// Relative weights for the up and down variations in alpha_s
+  mutable std::array<double, 2> alphaSWeights_;
+
+  /**
+   * \brief Relative weights for all variations in the current event
+   *
+   * Indexed in the same way as in \ref RelWeight.
+   */
+  mutable std::vector<double> relWeights_;
+
   mutable TTreeReaderValue<float> srcLheNominalWeight_;
-  mutable TTreeReaderValue<float> srcGenNominalWeight_;
-  mutable TTreeReaderArray<float> srcScaleWeights_;
-  mutable TTreeReaderArray<float> srcPdfWeights_;
+  BulkValue<float> srcGenNominalWeight_;
+  ColumnReader<float> srcScaleWeights_;
+  ColumnReader<float> srcPdfWeights_;
 };
 
 #endif  // HZZ2L2NU_INCLUDE_GENWEIGHT_H_
@@ -2,8 +2,8 @@
 #define HZZ2L2NU_INCLUDE_GENZZBUILDER_H_
 
 #include <Dataset.h>
+#include <FourMomentum.h>
 
-#include <TLorentzVector.h>
 #include <TTreeReaderArray.h>
 
 
@@ -20,7 +20,7 @@ class GenZZBuilder {
   GenZZBuilder(Dataset &dataset);
 
   /// Computes four-momentum of the ZZ system
-  TLorentzVector P4ZZ() const;
+  FourMomentum P4ZZ() const;
 
  private:
   mutable TTreeReaderArray<Int_t> srcPdgId_;
@@ -8,6 +8,7 @@
 #include <TTreeReaderValue.h>
 
 #include <CollectionBuilder.h>
+#include <Columns.h>
 #include <Dataset.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -36,7 +37,11 @@ class IsoTrackBuilder : public CollectionBuilder<IsoTrack> {
   /// Collection of IsoTracks
   mutable std::vector<IsoTrack> IsoTracks_;
 
-  mutable TTreeReaderArray<float> srcPt_, srcEta_, srcPhi_;
+  /// Selection of IsoTracks in the input collection that pass angular cleaning
+  mutable SelectionMask cleaningMask_;
+
+  mutable TTreeReaderArray<float> srcPt_;
+  ColumnReader<float> srcEta_, srcPhi_;
   mutable TTreeReaderArray<int> srcPdgId_;
   mutable TTreeReaderArray<bool> srcIsPFcand_;
   mutable TTreeReaderArray<float> srcDZ_, srcIso_;
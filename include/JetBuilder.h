@@ -6,15 +6,17 @@
 #include <vector>
 
 #include <TTreeReaderArray.h>
-#include <TTreeReaderValue.h>
 
+#include <BulkReader.h>
 #include <CollectionBuilder.h>
+#include <Columns.h>
 #include <Dataset.h>
 #include <GenJetBuilder.h>
 #include <JetCorrector.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
 #include <PileUpIdFilter.h>
+#include <ShapeSyst.h>
 
 
 /**
@@ -32,7 +34,11 @@
  * Systematic variations in jets are implemented with the help of JetCorrector,
  * which also applies JER smearing. To follow the standard smearing algorithm,
  * this builder needs to be made aware of generator-level jets via method
- * \ref SetGenJetBuilder.
+ * \ref SetGenJetBuilder. Jets are constructed for all variations included in
+ * the given ShapeSyst at once, and the collection for the currently selected
+ * variation is returned. Properties that do not depend on the jet momentum
+ * scale, such as the jet ID and the angular cleaning, are evaluated only once
+ * per jet.
  *
  * Jet with corrected pt > 15 GeV (the exact meaning depends on the
  * configuration) are aggregated for \ref GetSumMomentumShift to be used for the
@@ -53,7 +59,8 @@
 class JetBuilder : public CollectionBuilder<Jet> {
  public:
   JetBuilder(
-      Dataset &dataset, Options const &options, TabulatedRngEngine &rngEngine,
+      Dataset &dataset, Options const &options, RngEngine &rngEngine,
+      ShapeSyst const &shapeSyst,
       PileUpIdFilter const *pileUpIdFilter = nullptr);
 
   /// Returns collection of jets
@@ -68,6 +75,14 @@ class JetBuilder : public CollectionBuilder<Jet> {
    */
   std::vector<Jet> const &GetRejected() const;
 
+  /// Returns shape variations for which jets are constructed
+  ShapeSyst const &GetShapeSyst() const {
+    return shapeSyst_;
+  }
+
+  /// Returns the change in momentum in the current shape variation
+  Momentum const &GetSumMomentumShift() const override;
+
   /**
    * \brief Specifies an object that provides generator-level jets
    *
@@ -81,8 +96,10 @@ class JetBuilder : public CollectionBuilder<Jet> {
   /**
    * \brief Adds a contribution to the type 1 correction of missing pt
    *
+   * \param[in] variation  Index of the shape variation to which the
+   *   contribution is added.
    * \param[in] rawP4  Raw four-momentum of the jet.
-   * \param[in] area  Area of the jet.
+   * \param[in] jecL1  L1 JEC for the jet.
    * \param[in] jecOrig  The full JEC applied during production of NanoAOD.
    * \param[in] jecNew  The full JEC applied in the analysis, including the JEC
    *   systematic variation.
@@ -106,7 +123,7 @@ class JetBuilder : public CollectionBuilder<Jet> {
    * the contributions in the starting ptmiss.
    */
   void AddType1Correction(
-      TLorentzVector const &rawP4, double area,
+      int variation, FourMomentum const &rawP4, double jecL1,
       double jecOrig, double jecNew, double jerFactor,
       double emFraction, double muonFraction) const;
 
@@ -122,17 +139,39 @@ class JetBuilder : public CollectionBuilder<Jet> {
    *
    * Returns a nullptr if no match is found within the allowed cone.
    */
-  GenJet const *FindGenMatch(TLorentzVector const &p4,
+  GenJet const *FindGenMatch(FourMomentum const &p4,
                              double ptResolution) const;
 
   /**
-   * \brief Computes momentum scale factor that accounts for JER smearing
+   * \brief Computes momentum scale factors that account for JER smearing
    *
    * \param[in] corrP4  Corrected four-momentum of the jet.
-   * \param[in] rngChannel  Channel for the random number generator. Should be
-   *   set to the index of the jet in the current event.
+   * \param[in] jetIndex  Index of the jet in the current event, which selects
+   *   the random number in \ref jerRandomNumbers_.
+   * \param[out] factors  Scale factors for all shape variations.
+   */
+  void GetJerFactors(FourMomentum const &corrP4, int jetIndex,
+                     std::vector<double> &factors) const;
+
+  /**
+   * \brief Computes JEC uncertainty and JER factors for all shape variations
+   *
+   * Results are written into \ref jecUncFactors_ and \ref jerFactors_.
+   * Factors for JER smearing are only computed if \c withJer is true.
+   * Otherwise they are set to 1.
    */
-  double GetJerFactor(TLorentzVector const &corrP4, int rngChannel) const;
+  void ComputeVariedFactors(FourMomentum const &corrP4, int jetIndex,
+                            bool withJer) const;
+
+  /**
+   * \brief Computes JEC for all jets and soft jets in the current event
+   *
+   * Jets from the main collection are already corrected in the input, so only
+   * L1 JEC is computed for them and written into \ref jecL1_. For soft jets
+   * both L1 and full JEC are computed, and the results are written into
+   * \ref softJecL1_ and \ref softJecFull_.
+   */
+  void ComputeJec() const;
 
   /// Constructs collection of jets in the current event
   void ProcessJets() const;
@@ -201,12 +240,52 @@ class JetBuilder : public CollectionBuilder<Jet> {
   /// Range of pt, in GeV, where pileup ID is applicable
   double pileUpIdMinPt_, pileUpIdMaxPt_;
 
-  /// Collection of jets
-  mutable std::vector<Jet> jets_;
+  /// Shape variations for which jets are constructed
+  ShapeSyst const &shapeSyst_;
+
+  /// Collections of jets for all shape variations
+  mutable std::vector<std::vector<Jet>> jets_;
+
+  mutable std::vector<std::vector<Jet>> lowptJets_;
+  /// Collections of jets rejected by pileup ID for all shape variations
+  mutable std::vector<std::vector<Jet>> rejectedJets_;
+
+  /**
+   * \brief Selection of jets in the input collection based on ID,
+   * pseudorapidity, and angular cleaning
+   */
+  mutable SelectionMask mask_;
 
-  mutable std::vector<Jet> lowptJets_;
-  /// Collection of jets rejected by pileup ID
-  mutable std::vector<Jet> rejectedJets_;
+  /**
+   * \brief Changes in the total momentum for all shape variations
+   *
+   * They replace the shift accumulated in the base class.
+   */
+  mutable std::vector<Momentum> sumP4Shifts_;
+
+  /**
+   * \brief Buffers with JEC uncertainty and JER factors for the jet being
+   * processed, for all shape variations
+   */
+  mutable std::vector<double> jecUncFactors_, jerFactors_;
+
+  /**
+   * \brief Inputs and results for the computation of JEC for all jets in the
+   * current event
+   *
+   * The input buffers are filled first with jets from the main collection and
+   * then with soft jets. All buffers are reused between events.
+   */
+  mutable std::vector<float> jecRawPt_, jecEta_, jecArea_;
+  mutable std::vector<double> jecL1_, softJecL1_, softJecFull_;
+
+  /**
+   * \brief Random numbers for the stochastic JER smearing, following the
+   * standard normal distribution
+   *
+   * Indexed in the same way as the JEC buffers. Only filled in simulation.
+   */
+  mutable std::vector<double> jerRandomNumbers_;
 
   /// Indicates whether running on simulation or data
   bool isSim_;
@@ -217,12 +296,13 @@ class JetBuilder : public CollectionBuilder<Jet> {
   /// Object that computes JEC
   JetCorrector jetCorrector_;
 
-  mutable TTreeReaderArray<float> srcPt_, srcEta_, srcPhi_, srcMass_;
+  ColumnReader<float> srcPt_, srcEta_, srcPhi_, srcMass_;
   mutable TTreeReaderArray<float> srcArea_, srcRawFactor_;
   mutable TTreeReaderArray<float> srcChEmEF_, srcNeEmEF_, srcMuonFraction_;
   mutable TTreeReaderArray<float> srcBTag_;
-  mutable TTreeReaderArray<int> srcId_, srcPileUpId_;
-  mutable TTreeReaderValue<float> puRho_;
+  ColumnReader<int> srcId_;
+  mutable TTreeReaderArray<int> srcPileUpId_;
+  BulkValue<float> puRho_;
   mutable std::optional<TTreeReaderArray<int>> srcHadronFlavour_,
       srcPartonFlavour_, srcGenJetIdx_;
 
@@ -6,13 +6,13 @@
 #include <memory>
 #include <vector>
 
-#include <TLorentzVector.h>
-#include <TTreeReaderValue.h>
-
+#include <BulkReader.h>
 #include <Dataset.h>
+#include <FourMomentum.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
-#include <TabulatedRandomGenerator.h>
+#include <RandomGenerator.h>
+#include <ShapeSyst.h>
 
 
 // Classes from the JME POG that implement jet corrections are hidden from user
@@ -30,8 +30,10 @@ class JetResolutionScaleFactor;
  * \brief Implements jet pt scale and resolution corrections
  *
  * This class computes JEC (full nominal and L1-only), JEC uncertainty, and JER
- * smearing factors. Systematic variations are provided if requested via the
- * \c syst option.
+ * smearing factors. Systematic variations are provided for all shape
+ * variations described by the given ShapeSyst object. Factors for all of them
+ * are computed together, which allows to construct jets in all variations from
+ * a single read of the input.
  *
  * Paths to files that define JEC and JER are read from sections
  * \c jets/corrections and \c jets/resolution of the master configuration.
@@ -39,7 +41,7 @@ class JetResolutionScaleFactor;
 class JetCorrector {
  public:
   JetCorrector(Dataset &dataset, Options const &options,
-               TabulatedRngEngine &rngEngine);
+               RngEngine &rngEngine, ShapeSyst const &shapeSyst);
   ~JetCorrector() noexcept;
 
   /**
@@ -48,7 +50,7 @@ class JetCorrector {
    * In every event, \ref UpdateIov must be called before the first call to this
    * method. The effect of JEC uncertainties is not included.
    */
-  double GetJecFull(TLorentzVector const &rawP4, double area) const;
+  double GetJecFull(FourMomentum const &rawP4, double area) const;
 
   /**
    * \brief Computes L1 JEC
@@ -56,20 +58,52 @@ class JetCorrector {
    * In every event, \ref UpdateIov must be called before the first call to this
    * method.
    */
-  double GetJecL1(TLorentzVector const &rawP4, double area) const;
+  double GetJecL1(FourMomentum const &rawP4, double area) const;
+
+  /**
+   * \brief Computes L1 JEC for a collection of jets
+   *
+   * Same as \ref GetJec but only the L1 level is evaluated.
+   */
+  void GetJecL1(std::vector<float> const &rawPt, std::vector<float> const &eta,
+                std::vector<float> const &area,
+                std::vector<double> &jecL1) const;
+
+  /**
+   * \brief Computes L1 and full JEC for a collection of jets
+   *
+   * \param[in] rawPt  Raw pt of the jets.
+   * \param[in] eta  Pseudorapidities of the jets.
+   * \param[in] area  Areas of the jets.
+   * \param[out] jecL1  L1 JEC for each jet.
+   * \param[out] jecFull  JEC with all levels applied for each jet.
+   *
+   * Equivalent to calling \ref GetJecL1 and \ref GetJecFull for every jet but
+   * evaluates all JEC levels for all jets in one go. Input arrays must be of
+   * the same size, and the output vectors are resized accordingly. If the
+   * output vectors are reused between events, no memory is allocated once
+   * they have grown to the largest number of jets. In every event, \ref
+   * UpdateIov must be called before the first call to this method.
+   */
+  void GetJec(std::vector<float> const &rawPt, std::vector<float> const &eta,
+              std::vector<float> const &area, std::vector<double> &jecL1,
+              std::vector<double> &jecFull) const;
 
   /**
-   * \brief Computes correction factor to account for JEC uncertainty
+   * \brief Computes correction factors to account for JEC uncertainty
    *
    * \param[in] corrP4  Corrected four-momentum of a jet.
-   * \return Correction factor to rescale jet four-momentum to reproduce
-   *   requested systematic variation in JEC, or 1 if no such variation has been
-   *   requested.
+   * \param[out] factors  Correction factors to rescale jet four-momentum, one
+   *   for each variation in ShapeSyst and in the same order. Variations that do
+   *   not affect JEC get a factor of 1.
+   *
+   * The uncertainty is evaluated at most once per call.
    */
-  double GetJecUncFactor(TLorentzVector const &corrP4) const;
+  void GetJecUncFactors(FourMomentum const &corrP4,
+                        std::vector<double> &factors) const;
 
   /**
-   * \brief Computes correction factor to account for JER smearing
+   * \brief Computes correction factors to account for JER smearing
    *
    * \param[in] corrP4        Corrected four-momentum of a jet.
    * \param[in] genJet        Non-owning pointer to the generator-level jet
@@ -77,19 +111,34 @@ class JetCorrector {
    *   match or when the stochastic smearing is desired.
    * \param[in] ptResolution  Relative pt resolution as computed by
    *   \ref GetPtResolution.
-   * \param[in] rngChannel    Channel to be used for the tabulated random number
-   *   generator.
-   * \return Correction factor to rescale jet four-momentum.
+   * \param[in] randomNumber  Random number following the standard normal
+   *   distribution, to be used for the stochastic smearing. Normally produced
+   *   with \ref GetJerRandomNumbers.
+   * \param[out] factors  Correction factors to rescale jet four-momentum, one
+   *   for each variation in ShapeSyst and in the same order.
    *
    * The input four-momentum must have JEC applied. Normally, only the nominal
    * JEC should be applied, even when a JEC variation has been requested. This
    * is consistent with how JER smearing is applied in CMSSW.
    *
-   * The returned correction factor accounts for a systematic shift in JER if
-   * requested in the options. This method should only be called for simulation.
+   * Variations in JER shift the data-to-simulation scale factor. The same
+   * random number is used in all variations. This method should only be
+   * called for simulation.
+   */
+  void GetJerFactors(FourMomentum const &corrP4, GenJet const *genJet,
+                     double ptResolution, double randomNumber,
+                     std::vector<double> &factors) const;
+
+  /**
+   * \brief Produces random numbers for the stochastic JER smearing of all jets
+   * in the current event
+   *
+   * \param[in] numJets  Number of jets.
+   * \param[out] values  Random numbers following the standard normal
+   *   distribution, one per jet. The number for a given jet is determined by
+   *   its index and the current event.
    */
-  double GetJerFactor(TLorentzVector const &corrP4, GenJet const *genJet,
-                      double ptResultion, int rngChannel) const;
+  void GetJerRandomNumbers(int numJets, std::vector<double> &values) const;
 
   /**
    * \brief Returns relative jet pt resolution in simulation
@@ -97,7 +146,7 @@ class JetCorrector {
    * \param[in] corrP4  Corrected four-momentum of a jet.
    * \return Relative pt resolution.
    */
-  double GetPtResolution(TLorentzVector const &corrP4) const;
+  double GetPtResolution(FourMomentum const &corrP4) const;
 
   /**
    * \brief If needed, update IOV based on the current run
@@ -108,19 +157,6 @@ class JetCorrector {
   void UpdateIov() const;
 
  private:
-  /// Supported types of systematic variations
-  enum class Syst {
-    None,
-    JEC,
-    JER
-  };
-
-  /// Possible directions for systematic variations
-  enum class SystDirection {
-    Up,
-    Down
-  };
-
   /// Type for run number
   using run_t = uint64_t;
 
@@ -170,11 +206,8 @@ class JetCorrector {
    */
   void ReadIovParams(YAML::Node const config);
 
-  /// Type of requested systematic variation
-  Syst syst_;
-
-  /// Direction of requested systematic variation
-  SystDirection systDirection_;
+  /// Shape variations for which correction factors are computed
+  ShapeSyst const &shapeSyst_;
 
   /// Registered IOV-dependent parameters
   std::vector<IovParams> iovs_;
@@ -219,14 +252,21 @@ class JetCorrector {
    */
   std::unique_ptr<JME::JetResolutionScaleFactor> jerSFProvider_;
 
+  /**
+   * \brief Buffer for sub-corrections computed in \ref GetJec
+   *
+   * Indexed as <tt>[level * numJets + jet]</tt>.
+   */
+  mutable std::vector<float> subCorrections_;
+
   /// Random number generator
-  TabulatedRandomGenerator tabulatedRng_;
+  RandomGenerator rng_;
 
   /// Reader to access the current run
-  mutable TTreeReaderValue<UInt_t> run_;
+  BulkValue<UInt_t> run_;
 
   /// Median angular pt density
-  mutable TTreeReaderValue<float> rho_;
+  BulkValue<float> rho_;
 };
 
 #endif  // HZZ2L2NU_INCLUDE_JETCORRECTOR_H_
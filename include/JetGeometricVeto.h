@@ -1,12 +1,11 @@
 #ifndef HZZ2L2NU_INCLUDE_JETGEOMETRICVETO_H_
 #define HZZ2L2NU_INCLUDE_JETGEOMETRICVETO_H_
 
-#include <TTreeReaderValue.h>
-
+#include <BulkReader.h>
 #include <Dataset.h>
 #include <JetBuilder.h>
 #include <Options.h>
-#include <TabulatedRandomGenerator.h>
+#include <RandomGenerator.h>
 
 
 /**
@@ -24,7 +23,7 @@ class JetGeometricVeto {
  public:
   JetGeometricVeto(
       Dataset &dataset, Options const &options, JetBuilder const *jetBuilder,
-      TabulatedRngEngine &rngEngine);
+      RngEngine &rngEngine);
 
   /**
    * \brief Returns true if there are no jets in the specified window
@@ -56,8 +55,8 @@ class JetGeometricVeto {
   bool enabled_;
   bool isSim_;
   JetBuilder const *jetBuilder_;
-  TabulatedRandomGenerator tabulatedRng_;
-  mutable TTreeReaderValue<UInt_t> srcRun_;
+  RandomGenerator rng_;
+  BulkValue<UInt_t> srcRun_;
 };
 
 #endif  // HZZ2L2NU_INCLUDE_JETGEOMETRICVETO_H_
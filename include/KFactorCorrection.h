@@ -6,9 +6,9 @@
 #include <filesystem>
 
 #include <TGraph.h>
-#include <TTreeReaderArray.h>
 
 #include <Dataset.h>
+#include <GenParticleIndex.h>
 #include <Options.h>
 
 /**
@@ -20,7 +20,16 @@
  */
 class KFactorCorrection : public WeightBase {
  public:
-  KFactorCorrection(Dataset &dataset, Options const &options);
+  /**
+   * \brief Constructor
+   *
+   * \param[in] dataset  Dataset that will be processed.
+   * \param[in] options  Configuration options for the job.
+   * \param[in] genParticles  Index of generator-level particles. The object
+   *   must have an appropriate life time.
+   */
+  KFactorCorrection(Dataset &dataset, Options const &options,
+                    GenParticleIndex const *genParticles);
 
   /**
    * \brief Computes mass of generator-level Higgs boson
@@ -42,9 +51,8 @@ class KFactorCorrection : public WeightBase {
   /// The k factor as a function of the mass of the Higgs boson
   std::unique_ptr<TGraph> kfactorGraph_;
 
-  mutable TTreeReaderArray<float> genPartPt_, genPartEta_, genPartPhi_,
-    genPartMass_;
-  mutable TTreeReaderArray<int> genPartStatus_, genPartStatusFlags_;
+  /// Non-owning pointer to the index of generator-level particles
+  GenParticleIndex const *genParticles_;
 };
 
 #endif  // HZZ2L2NU_INCLUDE_KFACTORCORRECTION_H_
@@ -3,7 +3,11 @@
 
 #include <WeightBase.h>
 
+#include <array>
+#include <vector>
+
 #include <Dataset.h>
+#include <EventGraph.h>
 #include <ElectronBuilder.h>
 #include <MuonBuilder.h>
 #include <Options.h>
@@ -38,22 +42,19 @@ class LeptonWeight : public WeightBase {
   /// Computes the total lepton efficiency weight for the current event
 
   double NominalWeight() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[0];
   }
 
 
   double operator()() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[defaultWeightIndex_];
   }
   
 	double RelWeight(int variation) const override {
 
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[variation + 1] / weights_[defaultWeightIndex_];
 	}
 	
@@ -104,7 +105,7 @@ class LeptonWeight : public WeightBase {
    */
   mutable std::array<double, 17> weights_;
   
-	EventCache cache_;
+	EventNode node_;
   
 	/**
    * \brief Index of the default weight to be returned by operator()
@@ -117,6 +118,17 @@ class LeptonWeight : public WeightBase {
   std::array<std::vector<PtEtaHistogram>, 9> 
 		muonScaleFactors_, electronScaleFactors_;
 
+  /// Kinematics of tight leptons used to look up scale factors
+  mutable std::vector<double> electronPt_, electronEta_, muonPt_, muonEta_;
+
+  /**
+   * \brief Scale factors for individual tight leptons
+   *
+   * Indexed in the same way as \ref muonScaleFactors_ and
+   * \ref electronScaleFactors_.
+   */
+  mutable std::array<std::vector<double>, 9> muonSFs_, electronSFs_;
+
   /// Non-owning pointer to object that provides collection of electrons
   ElectronBuilder const *electronBuilder_;
 
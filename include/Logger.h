@@ -26,7 +26,8 @@
  * coloured. Apart from this, no formatting is applied to messages.
  *
  * The underlying implementation logger is wrapped into a Mayer's singleton. It
- * is automatically constructed at the first usage and available globally. The
+ * is automatically constructed at the first usage and available globally, and
+ * it can be used concurrently from multiple threads. The
  * threshold severity level for filtering can be set with \ref SetLevel. This
  * logger is not safe to use in the deconstruction phase at the end of the
  * application since it might be destroyed before the object that uses it.
@@ -53,7 +54,7 @@ class Logger {
   /// Auxiliary structure used in \ref TimeStamp manipulator
   struct _TimeStamp {};
 
-  using logger_t = boost::log::sources::severity_logger<SeverityLevel>;
+  using logger_t = boost::log::sources::severity_logger_mt<SeverityLevel>;
 
   ~Logger() noexcept;
 
@@ -2,11 +2,21 @@
 #define HZZ2L2NU_INCLUDE_LOOPER_H_
 
 #include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <boost/program_options.hpp>
+#include <TEnv.h>
+#include <TFileMerger.h>
+#include <TROOT.h>
+#include <TTreeCacheUnzip.h>
 
 #include <Dataset.h>
+#include <HZZException.h>
 #include <Logger.h>
 #include <Options.h>
 
@@ -20,6 +30,33 @@
  *   in the input dataset. It must return true if the event passes the selection
  *   and false otherwise. Method <tt>void AnalysisClass::PostProcessing()</tt>
  *   is called after the event loop.
+ *
+ * If option \c --threads is set to a value larger than 1, the entries to be
+ * processed are split into contiguous ranges aligned with the cluster
+ * boundaries of the input trees (see Dataset::ClusterBoundaries), and each
+ * range is processed in a separate thread. Every thread gets its own Dataset
+ * and its own instance of \c AnalysisClass, which writes to a temporary file.
+ * Once all threads have finished, the temporary files are merged, in the order
+ * of the ranges, into the file given by option \c --output and then deleted.
+ * Output trees therefore contain the same entries in the same order as in a
+ * serial run, while histograms are summed.
+ *
+ * For each entry, the graph of per-event computations of the dataset (see
+ * EventGraph) is invalidated and nodes scheduled for eager evaluation are
+ * evaluated. Option \c --event-threads sets the number of threads that are
+ * used for this within each event.
+ *
+ * Flag \c --pipeline makes each event loop run as a pipeline of three
+ * overlapping stages. Upcoming clusters of the input trees are read ahead by a
+ * helper thread of ROOT (asynchronous prefetching of TTreeCache), events are
+ * processed in the thread of the loop, and the output trees are filled and
+ * compressed in a writer thread (see EventTrees).
+ *
+ * Before each event loop starts, the TTreeCache of the dataset is set up with
+ * the branches registered by the analysis (see Dataset::SetUpCache), and
+ * statistics on reading are reported after the loop. If option
+ * \c --unzip-threads is set to a positive value, baskets in the cache are
+ * decompressed in parallel by a pool of ROOT with this number of threads.
  */
 template<typename AnalysisClass>
 class Looper {
@@ -36,13 +73,54 @@ class Looper {
 
   /// Runs over the input dataset
   void Run();
- 
+
  private:
-  /// Input dataset constructed from the configuration
-  Dataset dataset_;
+  /**
+   * \brief Inputs and state for processing of one range of entries
+   *
+   * Objects are held by pointers because the analysis keeps a reference to
+   * the dataset.
+   */
+  struct Worker {
+    /// Input dataset
+    std::unique_ptr<Dataset> dataset;
+
+    /// Implementation of the analysis
+    std::unique_ptr<AnalysisClass> analysis;
+
+    /// Half-open range of entries to process
+    int64_t begin, end;
+
+    /**
+     * \brief Output file written by this worker
+     *
+     * Empty if the worker writes directly to the final output file.
+     */
+    std::filesystem::path output;
+
+    /// Number of events that passed the selection
+    int64_t numSelected = 0;
+  };
+
+  /**
+   * \brief Computes boundaries of ranges of entries for the workers
+   *
+   * The ranges are of approximately equal size. Their boundaries are aligned
+   * with the clusters in the input trees.
+   */
+  std::vector<int64_t> ComputeRanges(Dataset &dataset, int numRanges) const;
+
+  /// Merges outputs of all workers into the final output file
+  void MergeOutputs() const;
+
+  /// Processes the range of entries assigned to the given worker
+  static void ProcessRange(Worker &worker, int index);
 
-  /// Implementation of the analysis
-  AnalysisClass analysis_;
+  /// Workers, one per thread
+  std::vector<Worker> workers_;
+
+  /// Name of the final output file
+  std::string output_;
 
   /// The number of events to read from the input dataset
   int64_t numEvents_;
@@ -51,17 +129,81 @@ class Looper {
 
 template<typename AnalysisClass>
 Looper<AnalysisClass>::Looper(Options const &options)
-    : dataset_{DatasetInfo{options.GetAs<std::string>("ddf"), options},
-               options.GetAs<int>("skip-files"),
-               options.GetAs<int>("max-files")},
-      analysis_{options, dataset_} {
-  
+    : output_{options.GetAs<std::string>("output")} {
+  int const numThreads = options.GetAsChecked<int>(
+      "threads", [](int n){return n >= 1;});
+
+  int const eventThreads = options.GetAsChecked<int>(
+      "event-threads", [](int n){return n >= 1;});
+
+  bool const pipeline = options.Exists("pipeline");
+
+  int const unzipThreads = options.GetAsChecked<int>(
+      "unzip-threads", [](int n){return n >= 0;});
+
+  if (numThreads > 1 or eventThreads > 1 or pipeline)
+    ROOT::EnableThreadSafety();
+
+  // Must be set before caches for input files are created
+  if (unzipThreads > 0) {
+    ROOT::EnableImplicitMT(unzipThreads);
+    TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+  }
+
+  // Must be set before input files are opened
+  if (pipeline)
+    gEnv->SetValue("TFile.AsyncPrefetching", 1);
+
+  DatasetInfo const info{options.GetAs<std::string>("ddf"), options};
+  int const skipFiles = options.GetAs<int>("skip-files");
+  int const maxFiles = options.GetAs<int>("max-files");
+
+  auto dataset = std::make_unique<Dataset>(info, skipFiles, maxFiles);
+  dataset->Graph().SetNumThreads(eventThreads);
   auto const maxEvents = options.GetAs<int64_t>("max-events");
 
   if (maxEvents >= 0)
-    numEvents_ = std::min(maxEvents, dataset_.NumEntries());
+    numEvents_ = std::min(maxEvents, dataset->NumEntries());
   else
-    numEvents_ = dataset_.NumEntries();
+    numEvents_ = dataset->NumEntries();
+
+  if (numThreads == 1) {
+    Worker &worker = workers_.emplace_back();
+    worker.analysis = std::make_unique<AnalysisClass>(options, *dataset);
+    worker.dataset = std::move(dataset);
+    worker.begin = 0;
+    worker.end = numEvents_;
+    return;
+  }
+
+  auto const ranges = ComputeRanges(*dataset, numThreads);
+  std::filesystem::path const outputPath{output_};
+  LOG_DEBUG << "Will process " << ranges.size() - 1 << " ranges of entries in "
+      "parallel threads.";
+
+  // Analyses are constructed sequentially since reading of configuration and
+  // auxiliary files is not guaranteed to be thread-safe
+  for (int i = 0; i < int(ranges.size()) - 1; ++i) {
+    Worker &worker = workers_.emplace_back();
+    worker.begin = ranges[i];
+    worker.end = ranges[i + 1];
+
+    if (i == 0)
+      worker.dataset = std::move(dataset);
+    else {
+      worker.dataset = std::make_unique<Dataset>(info, skipFiles, maxFiles);
+      worker.dataset->Graph().SetNumThreads(eventThreads);
+    }
+
+    worker.output = outputPath;
+    worker.output.replace_filename(
+        outputPath.stem().string() + "_thread" + std::to_string(i)
+        + outputPath.extension().string());
+    worker.analysis = std::make_unique<AnalysisClass>(
+        options.WithValue("output", worker.output.string()), *worker.dataset);
+    LOG_DEBUG << "Worker " << i << " will process entries [" << worker.begin
+        << ", " << worker.end << ") and write to " << worker.output << ".";
+  }
 }
 
 
@@ -69,7 +211,7 @@ template<typename AnalysisClass>
 boost::program_options::options_description
 Looper<AnalysisClass>::OptionsDescription() {
   namespace po = boost::program_options;
-  
+
   po::options_description optionsDescription{"Dataset"};
   optionsDescription.add_options()
     ("ddf,d", po::value<std::string>()->required(),
@@ -79,7 +221,15 @@ Looper<AnalysisClass>::OptionsDescription() {
     ("skip-files", po::value<int>()->default_value(0),
      "Number of files to skip at the beginning of the dataset")
     ("max-files", po::value<int>()->default_value(-1),
-     "Maximal number of files to read; -1 means all");
+     "Maximal number of files to read; -1 means all")
+    ("threads", po::value<int>()->default_value(1),
+     "Number of threads for the event loop")
+    ("event-threads", po::value<int>()->default_value(1),
+     "Number of threads for independent computations within each event")
+    ("pipeline", "Overlap reading, processing, and writing of events")
+    ("unzip-threads", po::value<int>()->default_value(0),
+     "Number of threads for decompression of input baskets; 0 disables "
+     "parallel decompression");
 
   optionsDescription.add(AnalysisClass::OptionsDescription());
   return optionsDescription;
@@ -91,20 +241,116 @@ void Looper<AnalysisClass>::Run() {
   LOG_DEBUG << "Will run over " << numEvents_ << " events.";
   int64_t numSelected = 0;
 
-  for (int64_t iEvent = 0; iEvent < numEvents_; ++iEvent) {
-    if (iEvent % 10000 == 0) {
-      LOG_INFO << Logger::TimeStamp << " Event " << iEvent << " out of "
-          << numEvents_;
-    }
-    dataset_.SetEntry(iEvent);
-    if (analysis_.ProcessEvent())
-      ++numSelected;
+  if (workers_.front().output.empty()) {
+    // Serial processing, the analysis writes directly to the final output
+    ProcessRange(workers_.front(), 0);
+    numSelected = workers_.front().numSelected;
+  } else {
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(workers_.size());
+
+    for (int i = 0; i < int(workers_.size()); ++i)
+      threads.emplace_back([this, &errors, i]{
+        try {
+          ProcessRange(workers_[i], i);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      });
+
+    for (auto &thread : threads)
+      thread.join();
+
+    for (auto const &error : errors)
+      if (error)
+        std::rethrow_exception(error);
+
+    for (auto const &worker : workers_)
+      numSelected += worker.numSelected;
+
+    MergeOutputs();
   }
 
-  analysis_.PostProcessing();
   LOG_INFO << Logger::TimeStamp << " Finishing. Total events selected: "
       << numSelected << ".";
 }
 
-#endif  // HZZ2L2NU_INCLUDE_LOOPER_H_
 
+template<typename AnalysisClass>
+std::vector<int64_t> Looper<AnalysisClass>::ComputeRanges(
+    Dataset &dataset, int numRanges) const {
+  auto const clusters = dataset.ClusterBoundaries();
+  std::vector<int64_t> ranges{0};
+
+  for (int i = 1; i < numRanges; ++i) {
+    int64_t const target = numEvents_ * i / numRanges;
+    auto const boundary = *std::lower_bound(
+        clusters.begin(), clusters.end(), target);
+
+    // Do not create empty ranges
+    if (boundary > ranges.back() and boundary < numEvents_)
+      ranges.emplace_back(boundary);
+  }
+
+  ranges.emplace_back(numEvents_);
+  return ranges;
+}
+
+
+template<typename AnalysisClass>
+void Looper<AnalysisClass>::MergeOutputs() const {
+  LOG_DEBUG << "Merging outputs of " << workers_.size() << " workers into "
+      << output_ << ".";
+  TFileMerger merger{false};
+  merger.SetPrintLevel(0);
+
+  if (not merger.OutputFile(output_.c_str(), "recreate")) {
+    HZZException exception;
+    exception << "Failed to open output file \"" << output_ << "\".";
+    throw exception;
+  }
+
+  for (auto const &worker : workers_) {
+    if (not merger.AddFile(worker.output.c_str(), false)) {
+      HZZException exception;
+      exception << "Failed to open partial output file " << worker.output
+          << ".";
+      throw exception;
+    }
+  }
+
+  if (not merger.Merge())
+    throw HZZException{"Failed to merge partial output files."};
+
+  for (auto const &worker : workers_)
+    std::filesystem::remove(worker.output);
+}
+
+
+template<typename AnalysisClass>
+void Looper<AnalysisClass>::ProcessRange(Worker &worker, int index) {
+  if (worker.begin < worker.end)
+    worker.dataset->SetUpCache(worker.begin);
+
+  for (int64_t iEvent = worker.begin; iEvent < worker.end; ++iEvent) {
+    if ((iEvent - worker.begin) % 10000 == 0) {
+      if (worker.output.empty())
+        LOG_INFO << Logger::TimeStamp << " Event " << iEvent << " out of "
+            << worker.end;
+      else
+        LOG_INFO << Logger::TimeStamp << " Worker " << index << ": event "
+            << iEvent - worker.begin << " out of "
+            << worker.end - worker.begin;
+    }
+    worker.dataset->SetEntry(iEvent);
+    worker.dataset->Graph().Invalidate();
+    worker.dataset->Graph().EvaluateEager();
+    if (worker.analysis->ProcessEvent())
+      ++worker.numSelected;
+  }
+
+  worker.analysis->PostProcessing();
+  worker.dataset->ReportReadStatistics();
+}
+
+#endif  // HZZ2L2NU_INCLUDE_LOOPER_H_
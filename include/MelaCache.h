@@ -0,0 +1,154 @@
+#ifndef HZZ2L2NU_INCLUDE_MELACACHE_H_
+#define HZZ2L2NU_INCLUDE_MELACACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <tuple>
+
+
+/**
+ * \brief Persistent cache of MELA probabilities
+ *
+ * Computation of matrix-element probabilities with MELA is expensive, and it is
+ * repeated identically whenever the same events are processed again, for
+ * instance in runs for different systematic variations. This class stores the
+ * probabilities in a sidecar file, indexed by event ID and a hash of the
+ * kinematics given to MELA.
+ *
+ * The file is memory-mapped in the constructor, and lookups are performed with
+ * a binary search in it. Probabilities computed anew are added with
+ * \ref Insert and written to the file by the destructor. Since the file may be
+ * shared by several jobs, the writing is protected by a lock on an auxiliary
+ * file. The current version of the file is reread under the lock and merged
+ * with the new records, and the result is atomically renamed into place.
+ *
+ * The file also contains a hash of the MELA configuration. If it doesn't match
+ * the one given to the constructor, the content of the file is ignored and
+ * overwritten.
+ */
+class MelaCache {
+ public:
+  /// Number of probabilities stored for each event
+  static constexpr int numValues = 5;
+
+  /// Probabilities stored for each event
+  using Values = std::array<double, numValues>;
+
+  /// Identifier of an event
+  struct EventID {
+    uint32_t run, lumi;
+    uint64_t event;
+  };
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] path  Path to the cache file. It is created if it doesn't
+   *   exist.
+   * \param[in] configHash  Hash of the MELA configuration.
+   */
+  MelaCache(std::filesystem::path const &path, uint64_t configHash);
+
+  /// Destructor. Writes new records to the file.
+  ~MelaCache() noexcept;
+
+  MelaCache(MelaCache const &) = delete;
+  MelaCache &operator=(MelaCache const &) = delete;
+
+  /**
+   * \brief Looks up probabilities for given event and kinematics
+   *
+   * \return Pointer to stored probabilities or nullptr if they are not
+   *   available.
+   */
+  Values const *Find(EventID const &id, uint64_t inputHash) const;
+
+  /**
+   * \brief Computes FNV-1a hash of a block of memory
+   *
+   * The hash can be chained by providing the result of a previous call as the
+   * seed.
+   */
+  static uint64_t Hash(void const *data, std::size_t size,
+                       uint64_t seed = 0xcbf29ce484222325);
+
+  /// Stores probabilities for given event and kinematics
+  void Insert(EventID const &id, uint64_t inputHash, Values const &values);
+
+ private:
+  /// Record in the cache file
+  struct Record {
+    uint32_t run, lumi;
+    uint64_t event, inputHash;
+    Values values;
+  };
+
+  /// Header of the cache file
+  struct Header {
+    /// Identifies the format of the file
+    std::array<char, 8> magic;
+
+    uint64_t configHash;
+    uint64_t numRecords;
+  };
+
+  /// Key by which records are ordered
+  using Key = std::tuple<uint32_t, uint32_t, uint64_t, uint64_t>;
+
+  /// Mapping of a cache file into memory
+  class MappedFile {
+   public:
+    /**
+     * \brief Maps given file
+     *
+     * If the file doesn't exist or is not a valid cache file for the given
+     * configuration, the mapping contains no records.
+     */
+    MappedFile(std::filesystem::path const &path, uint64_t configHash);
+
+    ~MappedFile() noexcept;
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    /// Returns pointer to the first record
+    Record const *begin() const {
+      return records_;
+    }
+
+    /// Returns pointer past the last record
+    Record const *end() const {
+      return records_ + numRecords_;
+    }
+
+   private:
+    void *data_;
+    std::size_t size_;
+    Record const *records_;
+    std::size_t numRecords_;
+  };
+
+  static Key GetKey(Record const &record) {
+    return {record.run, record.lumi, record.event, record.inputHash};
+  }
+
+  /// Writes new records to the file, merging them with its current content
+  void Save();
+
+  static constexpr std::array<char, 8> magic_{
+      'H', 'Z', 'Z', 'M', 'E', 'L', 'A', '1'};
+
+  std::filesystem::path path_;
+  uint64_t configHash_;
+
+  /// Mapping of the cache file as it was at construction
+  MappedFile mapped_;
+
+  /// Records added in this job, ordered by their keys
+  std::map<Key, Values> newRecords_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_MELACACHE_H_
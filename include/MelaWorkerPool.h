@@ -0,0 +1,111 @@
+#ifndef HZZ2L2NU_INCLUDE_MELAWORKERPOOL_H_
+#define HZZ2L2NU_INCLUDE_MELAWORKERPOOL_H_
+
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <FourMomentum.h>
+#include <MelaCache.h>
+
+
+/**
+ * \brief Pool of helper processes that compute MELA probabilities
+ *
+ * MELA is a process-global object that is not thread-safe, and it writes
+ * auxiliary files into the current directory. This class forks a number of
+ * helper processes, each of which owns a copy of the MELA state of the parent
+ * process and works in a private scratch directory. The kinematics and the
+ * resulting probabilities are exchanged via shared memory, with one slot per
+ * helper, while sockets are only used to signal that a request or a response
+ * is ready. A computation requested with \ref Compute is assigned to a free
+ * helper, so that up to as many computations as there are helpers can be
+ * performed concurrently from different threads.
+ *
+ * Since the helpers are created with fork, the pool must be constructed before
+ * any threads are started, and the MELA state that the helpers use is the one
+ * at the time of construction. For this reason it cannot be used together with
+ * the implicit multithreading of ROOT. The helpers are terminated and their
+ * scratch directories removed by the destructor.
+ */
+class MelaWorkerPool {
+ public:
+  /**
+   * \brief Function that computes probabilities for given momenta of the
+   * approximate ZZ candidate and jets
+   *
+   * It is executed in the helper processes.
+   */
+  using ComputeFunction = std::function<MelaCache::Values(
+      FourMomentum const &p4ZZ, std::vector<FourMomentum> const &jets)>;
+
+  /// Maximal number of jets that can be passed to \ref Compute
+  static constexpr int maxJets = 32;
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] numWorkers  Number of helper processes.
+   * \param[in] compute  Function that computes probabilities.
+   */
+  MelaWorkerPool(int numWorkers, ComputeFunction compute);
+
+  ~MelaWorkerPool() noexcept;
+
+  MelaWorkerPool(MelaWorkerPool const &) = delete;
+  MelaWorkerPool &operator=(MelaWorkerPool const &) = delete;
+
+  /**
+   * \brief Computes probabilities in one of the helper processes
+   *
+   * Blocks until a helper becomes available and the computation is done. Can
+   * be called concurrently from multiple threads. Throws an exception if the
+   * number of jets exceeds \ref maxJets, if the computation failed, or if
+   * the helper has terminated. A helper that has terminated is not used
+   * again, and an exception is thrown when no helpers are left.
+   */
+  MelaCache::Values Compute(
+      FourMomentum const &p4ZZ, std::vector<FourMomentum> const &jets);
+
+ private:
+  /// Slot in shared memory used to communicate with a helper
+  struct Slot;
+
+  /// Helper process
+  struct Worker {
+    pid_t pid;
+
+    /// Socket to signal requests to and responses from the helper
+    int fd;
+
+    std::filesystem::path scratchDir;
+  };
+
+  /// Main loop of a helper process
+  void WorkerLoop(Slot &slot, int fd) const;
+
+  ComputeFunction compute_;
+
+  /// Shared memory with one slot per helper
+  Slot *slots_;
+
+  std::vector<Worker> workers_;
+
+  /// Protects \ref freeWorkers_ and \ref numAlive_
+  std::mutex mutex_;
+
+  /// Notified when a helper becomes free
+  std::condition_variable freed_;
+
+  /// Indices of helpers that are not performing computations
+  std::vector<int> freeWorkers_;
+
+  /// Number of helpers that have not terminated
+  int numAlive_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_MELAWORKERPOOL_H_
@@ -3,8 +3,7 @@
 
 #include <vector>
 
-#include <TTreeReaderValue.h>
-
+#include <BulkReader.h>
 #include <Dataset.h>
 #include <Options.h>
 
@@ -22,7 +21,7 @@ class MetFilters {
 
  private:
   /// Readers to access decisions of relevant filters
-  mutable std::vector<TTreeReaderValue<Bool_t>> flags_;
+  std::vector<BulkValue<Bool_t>> flags_;
 };
 
 #endif  // METFILTERS_H_
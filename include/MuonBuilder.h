@@ -8,11 +8,13 @@
 #include <TTreeReaderArray.h>
 
 #include <CollectionBuilder.h>
+#include <Columns.h>
 #include <Dataset.h>
+#include <GenParticleIndex.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
+#include <RandomGenerator.h>
 #include <RoccoR.h>
-#include <TabulatedRandomGenerator.h>
 
 
 /**
@@ -23,7 +25,9 @@
  * tight collection is a subset of the loose one.
  *
  * Rochester corrections for muon momenta are applied. The changes in momenta of
- * loose muons are aggregated for \ref GetSumMomentumShift.
+ * loose muons are aggregated for \ref GetSumMomentumShift. In simulation, the
+ * correction requires matching to generator-level muons, and an index of
+ * generator-level particles must be provided with \ref SetGenParticleIndex.
  */
 class MuonBuilder : public CollectionBuilder<Muon> {
  public:
@@ -32,10 +36,10 @@ class MuonBuilder : public CollectionBuilder<Muon> {
    *
    * \param[in] dataset    Dataset that will be processed.
    * \param[in] options    Configuration options for the job.
-   * \param[in] rngEngine  Engine to construct TabulatedRandomGenerator.
+   * \param[in] rngEngine  Engine to construct RandomGenerator.
    */
   MuonBuilder(Dataset &dataset, Options const &options,
-              TabulatedRngEngine &rngEngine);
+              RngEngine &rngEngine);
 
   /// Alias for \ref GetTight
   std::vector<Muon> const &Get() const override;
@@ -46,11 +50,20 @@ class MuonBuilder : public CollectionBuilder<Muon> {
   /// Returns collection of tight muons
   std::vector<Muon> const &GetTight() const;
 
+  /**
+   * \brief Specifies an object that provides generator-level particles
+   *
+   * Must be called in simulation. The object must have an appropriate life
+   * time.
+   */
+  void SetGenParticleIndex(GenParticleIndex const *genParticles);
+
  private:
   /**
    * \brief Applies Rochester correction to momentum of the muon
    *
-   * \param[in] index     Index of the muon to choose channel for tabulatedRng_.
+   * \param[in] index     Index of the muon to choose random numbers from
+   *   \ref rochesterRandomNumbers_.
    * \param[in,out] muon  Muon to be corrected.
    * \param[in] trackerLayers  Number of tracker layers with measurements for
    *   the given muon.
@@ -62,6 +75,9 @@ class MuonBuilder : public CollectionBuilder<Muon> {
 
   /// Constructs muons for the current event
   void Build() const override;
+
+  /// Reads all branches used in \ref Build, see EventGraph::SetPrefetch
+  void Prefetch() const;
   
   /**
    * \brief Finds matching generator-level muon using (eta, phi) metric
@@ -95,23 +111,33 @@ class MuonBuilder : public CollectionBuilder<Muon> {
   /// Indicates whether running on simulation or data
   bool isSim_;
 
+  /// Non-owning pointer to the index of generator-level particles
+  GenParticleIndex const *genParticles_;
+
   /// Object to compute Rochester correction to muon pt
   std::unique_ptr<RoccoR> rochesterCorrection_;
 
   /// Random number generator
-  TabulatedRandomGenerator tabulatedRng_;
+  RandomGenerator rng_;
+
+  /**
+   * \brief Uniformly distributed random numbers for the Rochester correction
+   *
+   * Two numbers for each muon in the current event. Only filled in simulation.
+   */
+  mutable std::vector<double> rochesterRandomNumbers_;
+
+  /// Selections of loose and tight muons in the input collection
+  mutable SelectionMask looseMask_, tightMask_;
 
-  mutable TTreeReaderArray<float> srcPt_, srcEta_, srcPhi_, srcMass_;
-  mutable TTreeReaderArray<int> srcCharge_;
-  mutable TTreeReaderArray<float> srcIsolation_;
+  ColumnReader<float> srcPt_, srcEta_, srcPhi_, srcMass_;
+  ColumnReader<int> srcCharge_;
+  ColumnReader<float> srcIsolation_;
   mutable TTreeReaderArray<bool> srcIsPfMuon_, srcIsGlobalMuon_;
   mutable TTreeReaderArray<bool> srcIsTrackerMuon_;
-  mutable TTreeReaderArray<bool> srcIdLoose_, srcIdTight_;
-  mutable TTreeReaderArray<float> srcdxy_, srcdz_;
-  mutable TTreeReaderArray<int> srcTrackerLayers_;
-  mutable std::unique_ptr<TTreeReaderArray<int>> genPartId_;
-  mutable std::unique_ptr<TTreeReaderArray<float>> genPartPt_, genPartEta_;
-  mutable std::unique_ptr<TTreeReaderArray<float>> genPartPhi_;
+  ColumnReader<bool> srcIdLoose_, srcIdTight_;
+  ColumnReader<float> srcdxy_, srcdz_;
+  ColumnReader<int> srcTrackerLayers_;
 };
 
 
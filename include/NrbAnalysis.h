@@ -11,9 +11,9 @@
 #include <TRandom3.h>
 #include <TString.h>
 #include <TTreeReaderArray.h>
-#include <TTreeReaderValue.h>
 
 #include <AnalysisCommon.h>
+#include <BulkReader.h>
 #include <Dataset.h>
 #include <Options.h>
 #include <RunSampler.h>
@@ -62,9 +62,9 @@ class NrbAnalysis : public AnalysisCommon {
 
   TString fileName_;
 
-  TTreeReaderValue<UInt_t> run_ = {dataset_.Reader(), "run"};
-  TTreeReaderValue<Float_t> rho_ = {dataset_.Reader(), "fixedGridRhoFastjetAll"};
-  TTreeReaderValue<Int_t> numPVGood_ = {dataset_.Reader(), "PV_npvsGood"};
+  BulkValue<UInt_t> run_ = {dataset_, "run"};
+  BulkValue<Float_t> rho_ = {dataset_, "fixedGridRhoFastjetAll"};
+  BulkValue<Int_t> numPVGood_ = {dataset_, "PV_npvsGood"};
   TTreeReaderArray<Float_t> muonPt_ = {dataset_.Reader(), "Muon_pt"};
   TTreeReaderArray<Float_t> electronPt_ = {dataset_.Reader(), "Electron_pt"};
   std::unique_ptr<TTreeReaderArray<int>> genPartPdgId_, genPartMotherIndex_;
@@ -9,8 +9,8 @@
 #include <boost/program_options.hpp>
 #include <TFile.h>
 #include <TTree.h>
-#include <TTreeReaderValue.h>
 
+#include <BulkReader.h>
 #include <EventTrees.h>
 #include <Dataset.h>
 #include <GenZZBuilder.h>
@@ -103,7 +103,7 @@ class NrbTrees final : public EventTrees {
   LeptonWeight leptonEff_;
   TriggerWeight triggerEff_;
 
-  TTreeReaderValue<ULong64_t> srcEvent_;
+  BulkValue<ULong64_t> srcEvent_;
 
   Int_t leptonCat_, jetCat_, numPVGood_;
   Float_t llPt_, llEta_, llPhi_, llMass_;
@@ -115,7 +115,7 @@ class NrbTrees final : public EventTrees {
   Bool_t btagLoose_, btagMedium_, btagTight_;
   Bool_t btagLooseLowPt_, btagMediumLowPt_, btagTightLowPt_;
 
-  TTreeReaderValue<int> srcNumPVGood_;
+  BulkValue<int> srcNumPVGood_;
 
   ULong64_t event_;
   Float_t genMZZ_;
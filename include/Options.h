@@ -5,6 +5,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <typeinfo>
 
 #include <boost/program_options.hpp>
 #include <yaml-cpp/yaml.h>
@@ -132,6 +133,18 @@ class Options {
   static T NodeAsChecked(YAML::Node const &node, Checker const &checker,
                          std::initializer_list<std::string> const keys = {});
 
+  /**
+   * \brief Returns a copy of this object with the value of one option replaced
+   *
+   * The option must have been registered and must have a value, possibly a
+   * default one. The type \c T must match the type with which the option has
+   * been declared. Otherwise an exception of type Options::Error is thrown.
+   * This is used to give each worker of a multithreaded event loop its own
+   * output file.
+   */
+  template<typename T>
+  Options WithValue(std::string const &label, T const &value) const;
+
  private:
   /**
    * \brief Prints usage instructions
@@ -233,4 +246,27 @@ T Options::NodeAsChecked(YAML::Node const &node, Checker const &checker,
   return value;
 }
 
+
+template<typename T>
+Options Options::WithValue(std::string const &label, T const &value) const {
+  if (not Exists(label)) {
+    std::ostringstream message;
+    message << "Unknown option \"" << label << "\"";
+    throw Error(message.str());
+  }
+
+  Options copy{*this};
+  auto &storedValue = copy.optionMap_.at(label).value();
+
+  if (storedValue.type() != typeid(T)) {
+    std::ostringstream message;
+    message << "Type mismatch when replacing the value of option \"" << label
+        << "\"";
+    throw Error(message.str());
+  }
+
+  storedValue = value;
+  return copy;
+}
+
 #endif  // OPTIONS_H_
@@ -8,6 +8,7 @@
 #include <TTreeReaderValue.h>
 
 #include <CollectionBuilder.h>
+#include <Columns.h>
 #include <Dataset.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -38,12 +39,15 @@ class PhotonBuilder : public CollectionBuilder<Photon> {
   /// Collection of photons
   mutable std::vector<Photon> photons_;
 
+  /// Selection of photons in the input collection
+  mutable SelectionMask mask_;
+
   mutable std::unique_ptr<TTreeReaderArray<float>> srcGenPt_, srcGenEta_;
   mutable std::unique_ptr<TTreeReaderArray<float>> srcGenPhi_;
   mutable std::unique_ptr<TTreeReaderArray<int>> srcPhotonGenPartIndex_;
   mutable std::unique_ptr<TTreeReaderArray<UChar_t>> srcFlavour_;
-  mutable TTreeReaderArray<float> srcPt_, srcEta_, srcPhi_;
-  mutable std::unique_ptr<TTreeReaderArray<int>> srcId_;
+  ColumnReader<float> srcPt_, srcEta_, srcPhi_;
+  ColumnReader<int> srcId_;
   // mutable std::unique_ptr<TTreeReaderArray<bool>> srcMvaId_;
   mutable TTreeReaderArray<bool> srcIsEtaScEb_, srcPixelSeed_, srcElecronVeto_;
   mutable TTreeReaderArray<float> srcR9_, srcSieie_;
@@ -4,8 +4,7 @@
 #include <memory>
 #include <vector>
 
-#include <TTreeReaderValue.h>
-
+#include <BulkReader.h>
 #include <Dataset.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -17,7 +16,7 @@ struct PhotonTrigger {
   }
   std::string name;
   double threshold;
-  std::unique_ptr<TTreeReaderValue<Bool_t>> decision;
+  std::unique_ptr<BulkValue<Bool_t>> decision;
   std::unique_ptr<std::map<unsigned, std::map<unsigned,int>>> prescaleMap;
 };
 
@@ -84,9 +83,9 @@ class PhotonPrescales {
   /// Indicates if the event is simulation or data
   bool isSim_;
 
-  /// For determining the prescale, work around for const object
-  mutable TTreeReaderValue<UInt_t> run_;
-  mutable TTreeReaderValue<UInt_t> luminosityBlock_;
+  /// For determining the prescale
+  BulkValue<UInt_t> run_;
+  BulkValue<UInt_t> luminosityBlock_;
 };
 
 #endif  // HZZ2L2NU_INCLUDE_PHOTONPRESCALES_H
@@ -10,6 +10,7 @@
 #include <TTree.h>
 #include <TTreeReaderValue.h>
 
+#include <BulkReader.h>
 #include <Dataset.h>
 // #include <EventNumberFilter.h>
 #include <EventTrees.h>
@@ -38,6 +39,12 @@ class PhotonTrees final : public EventTrees {
     kGEq2J
   };
 
+  /**
+   * \brief Performs the event selection and fills the output tree in the
+   * current shape variation
+   */
+  bool ProcessVariation();
+
   Photon const *CheckPhotons() const;
 
   void FillMoreVariables(std::vector<Jet> const &jets);
@@ -47,9 +54,9 @@ class PhotonTrees final : public EventTrees {
   /// Indicates that additional variables should be stored
   bool storeMoreVariables_;
 
-  TTreeReaderValue<UInt_t> srcRun_;
-  TTreeReaderValue<UInt_t> srcLumi_;
-  TTreeReaderValue<ULong64_t> srcEvent_;
+  BulkValue<UInt_t> srcRun_;
+  BulkValue<UInt_t> srcLumi_;
+  BulkValue<ULong64_t> srcEvent_;
 
   mutable std::unique_ptr<TTreeReaderValue<UInt_t>> numGenPart_;
   mutable std::unique_ptr<TTreeReaderArray<Int_t>> genPartPdgId_;
@@ -85,7 +92,7 @@ class PhotonTrees final : public EventTrees {
   Float_t photonReweighting_, photonNvtxReweighting_, photonEtaReweighting_;
   Float_t meanWeight_;
 
-  TTreeReaderValue<int> srcNumPVGood_;
+  BulkValue<int> srcNumPVGood_;
 
   UInt_t run_, lumi_;
   ULong64_t event_;
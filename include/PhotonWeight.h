@@ -9,6 +9,7 @@
 
 #include <TH2.h>
 
+#include <BinnedTable.h>
 #include <Dataset.h>
 #include <Options.h>
 #include <PhotonBuilder.h>
@@ -49,11 +50,11 @@ class PhotonWeight : public WeightBase {
   static std::unique_ptr<TH2> ReadHistogram(std::string const &pathsWithNames);
   
   /**
-   * \brief Histograms of different type of photon scale factors
+   * \brief Tables of different type of photon scale factors
    *
    * They are stored in 2D format with eta in X-axis and pt in Y-axis.
    */
-  std::vector<std::unique_ptr<TH2>> photonTable_; 
+  std::vector<BinnedTable2D> photonTable_; 
 
   /// Non-owning pointer to object that provides collection of photons
   PhotonBuilder const *photonBuilder_;
@@ -5,14 +5,14 @@
 #include <cstdlib>
 #include <limits>
 
-#include <TLorentzVector.h>
+#include <FourMomentum.h>
 
 
 /// Non-polymorphic base class for particle-like physics objects
 struct Particle {
 
   /// Four-momentum, in GeV
-  TLorentzVector p4;
+  FourMomentum p4;
 };
 
 
@@ -150,7 +150,7 @@ struct Photon : public Particle {
   Origin flavour = Origin::Unmatched;
 
   /// Four-momentum of the matched gen-level particle, in GeV
-  TLorentzVector genP4;
+  FourMomentum genP4;
 
   /// Photon variables
   bool passElecVeto;
@@ -207,7 +207,7 @@ struct Lepton : public Particle {
    * the old momentum. If the momentum has not been corrected, set to a null
    * vector.
    */
-  TLorentzVector uncorrP4;
+  FourMomentum uncorrP4;
 };
 
 
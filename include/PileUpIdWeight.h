@@ -7,12 +7,12 @@
 #include <memory>
 #include <optional>
 #include <string_view>
+#include <vector>
 
-#include <TH2.h>
-#include <TTreeReaderValue.h>
-
+#include <BinnedTable.h>
+#include <BulkReader.h>
 #include <Dataset.h>
-#include <EventCache.h>
+#include <EventGraph.h>
 #include <JetBuilder.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -32,6 +32,11 @@
  * PileUpIdWeight it is assumed that section \c pileup_id exists; otherwise an
  * object of this class should not be constructed.
  *
+ * The model for the efficiency is read from the file given by parameter
+ * \c pileup_id.efficiency. If optional parameter
+ * \c pileup_id.efficiency_compiled is given, predictions are computed with the
+ * compiled model of this name instead (see XGBoostCompiledModel).
+ *
  * Systematic variations in the scale factors are provided. The scale factors
  * for pileup and matched jets are varied simulatneously within each category
  * and independently between the categories.
@@ -53,8 +58,7 @@ class PileUpIdWeight : public WeightBase {
       JetBuilder const *jetBuilder);
 
   double NominalWeight() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[0];
   }
 
@@ -63,14 +67,12 @@ class PileUpIdWeight : public WeightBase {
   }
 
   double operator()() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[int(defaultVariation_)];
   }
 
   double RelWeight(int variation) const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[variation + 1] / weights_[0];
   }
 
@@ -99,10 +101,10 @@ class PileUpIdWeight : public WeightBase {
     Jet::PileUpId workingPoint;
 
     /**
-     * \brief Histograms with pileup ID scale factors and their uncertainties
-     * for matched and pileup jets
+     * \brief Tables with pileup ID scale factors and their uncertainties for
+     * matched and pileup jets
      */
-    std::shared_ptr<TH2> sfMatched, sfUncMatched, sfPileUp, sfUncPileUp;
+    std::shared_ptr<BinnedTable2D> sfMatched, sfUncMatched, sfPileUp, sfUncPileUp;
   };
 
   /**
@@ -111,8 +113,34 @@ class PileUpIdWeight : public WeightBase {
    */
   Context const &FindContext(Jet const &jet) const;
 
-  /// Computes pileup ID efficiency in simulation for given jet
-  double GetEfficiency(Context const &context, Jet const &jet) const;
+  /// Jet that enters the computation of the weight
+  struct TaggableJet {
+    Jet const *jet;
+
+    /// Context for the |eta| range of the jet
+    Context const *context;
+
+    /// Indicates whether the jet passes pileup ID
+    bool passed;
+  };
+
+  /**
+   * \brief Adds the given jet to \ref taggableJets_ if it is affected by the
+   * pileup ID
+   */
+  void AddTaggableJet(Jet const &jet, bool passed) const;
+
+  /**
+   * \brief Writes input features for the computation of the pileup ID
+   * efficiency for given jet
+   *
+   * \param[in] context  Context for the jet.
+   * \param[in] jet  Jet for which the features are computed.
+   * \param[out] features  Array to which the features are written. Must be
+   *   able to store \ref numEffFeatures_ elements.
+   */
+  void FillEffFeatures(
+      Context const &context, Jet const &jet, float *features) const;
 
   /// Finds pileup ID scale factor for given jet and variation
   double GetScaleFactor(
@@ -143,25 +171,46 @@ class PileUpIdWeight : public WeightBase {
   /// \ref Context for each |eta| region
   std::vector<Context> contexts_;
 
+  /// Number of input features of the model for the pileup ID efficiency
+  static constexpr int numEffFeatures_ = 13;
+
+  /**
+   * \brief Input features for the computation of the pileup ID efficiency
+   * that don't change from event to event
+   *
+   * They are set in the constructor. Remaining features are set to zero.
+   */
+  std::array<float, numEffFeatures_> effFeaturesTemplate_;
+
   /**
-   * \brief Array with input features for the computation of the pileup ID
-   * efficiency in simulation
+   * \brief Jets that enter the computation of the weight in the current event
    *
-   * It will be reused for each computation. Features that don't change are set
-   * in the constructor.
+   * Reused between events to avoid memory allocations.
    */
-  mutable std::array<float, 13> effFeatures_;
+  mutable std::vector<TaggableJet> taggableJets_;
+
+  /**
+   * \brief Input features for the computation of the pileup ID efficiency in
+   * simulation for all jets in \ref taggableJets_, stored row by row
+   *
+   * Efficiencies for all jets in an event are computed with a single call to
+   * the model.
+   */
+  mutable std::vector<float> effFeatures_;
+
+  /// Pileup ID efficiencies for jets in \ref taggableJets_
+  mutable std::vector<float> efficiencies_;
 
   /// Model that parameterizes the pileup ID efficiency in simulation
   std::optional<XGBoostPredictor> effCalc_;
 
   /// Interface to read the expected number of pileup interactions
-  mutable TTreeReaderValue<float> expPileUp_;
+  BulkValue<float> expPileUp_;
 
   /// Requested systematic variation
   Variation defaultVariation_;
 
-  EventCache cache_;
+  EventNode node_;
 
   /**
    * \brief Cached weights for all systematic variations
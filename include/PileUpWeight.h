@@ -5,12 +5,14 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <TH1.h>
-#include <TTreeReaderValue.h>
 
+#include <BinnedTable.h>
+#include <BulkReader.h>
 #include <Dataset.h>
-#include <EventCache.h>
+#include <EventGraph.h>
 #include <Options.h>
 #include <RunSampler.h>
 #include <WeightBase.h>
@@ -32,7 +34,9 @@
  * - \c nominal, \c up, \c down  \c TH1 representing nominal pileup profile and
  *   profiles for systamatic varations. Expect an integer binning.
  *
- * Computed weights are cached on per-event basis.
+ * When the profiles are loaded, ratios between them are tabulated for each era
+ * in a binning common to all profiles. Computed weights are cached on
+ * per-event basis.
  */
 class PileUpWeight : public WeightBase {
  public:
@@ -41,8 +45,7 @@ class PileUpWeight : public WeightBase {
                RunSampler const *runSampler);
 
   double NominalWeight() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[0];
   }
 
@@ -52,14 +55,12 @@ class PileUpWeight : public WeightBase {
 
   /// Computes the pileup weight for the current event
   double operator()() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[defaultWeightIndex_];
   }
 
   double RelWeight(int variation) const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     if (weights_[0] == 0) {
       LOG_DEBUG << "Nominal weight of 0. Put variation to 0.";
       return 0;
@@ -71,38 +72,64 @@ class PileUpWeight : public WeightBase {
   std::string_view VariationName(int variation) const override;
 
  private:
-  /// Data pileup profiles for a single era
+  /// Pileup weights for a single era
   struct Era {
     /// Range of runs defining the era (boundaries included)
     int minRun, maxRun;
 
     /**
-     * \brief Data pileup profiles
+     * \brief Binning in the true number of pileup interactions
      *
-     * The nominal profile and the profiles for up and down systematic
-     * varations, in that order. All profiles are normalized to represent
-     * probability density. Under- and overflow bins in the histograms are
-     * empty.
+     * Includes edges of bins of the profiles in data and simulation.
      */
-    std::array<std::unique_ptr<TH1>, 3> dataProfiles;
+    BinnedAxis binning;
+
+    /**
+     * \brief Precomputed weights in each bin of \ref binning, including the
+     * under- and overflow bins
+     *
+     * For each bin, the nominal weight and the weights for up and down
+     * systematic variations, in that order. They are computed as ratios between
+     * the corresponding data profile and the simulation profile, or set to 1 if
+     * the probability in simulation is not positive.
+     */
+    std::vector<std::array<double, 3>> weights;
   };
 
-  /// Loads data pileup profiles for all eras
-  void LoadDataProfiles(std::filesystem::path const &path);
+  /**
+   * \brief Fills the binning and the weights for the given era
+   *
+   * All profiles must be normalized to represent probability density.
+   */
+  static void BuildWeightTable(
+      Era &era, TH1 const &simProfile,
+      std::array<std::unique_ptr<TH1>, 3> const &dataProfiles);
 
-  /// Loads pileup profile in simulation for a given dataset or default one
-  void LoadSimProfile(YAML::Node const &config, std::string const &datasetName);
+  /**
+   * \brief Finds the era that contains given run
+   *
+   * The era found for the previous call is checked first.
+   */
+  Era const &FindEra(int run) const;
 
-  /// Computes all weights for the current event
-  void Update() const;
+  /**
+   * \brief Loads data pileup profiles for all eras and computes weights with
+   * respect to the given profile in simulation
+   */
+  void LoadDataProfiles(std::filesystem::path const &path,
+                        TH1 const &simProfile);
 
   /**
-   * \brief Histogram representing pileup profile in simulation
+   * \brief Loads pileup profile in simulation for a given dataset or default
+   * one
    *
-   * The histogram is normalized to represent probability density. Under- and
-   * overflow bins are empty.
+   * The returned histogram is normalized to represent probability density.
    */
-  std::unique_ptr<TH1> simProfile_;
+  static std::unique_ptr<TH1> LoadSimProfile(
+      YAML::Node const &config, std::string const &datasetName);
+
+  /// Computes all weights for the current event
+  void Update() const;
 
   /**
    * \brief Eras with pileup profiles in data
@@ -112,7 +139,14 @@ class PileUpWeight : public WeightBase {
    */
   std::vector<Era> eras_;
 
-  EventCache cache_;
+  /**
+   * \brief Index of the era found for the previous event
+   *
+   * Negative if no era has been looked up yet.
+   */
+  mutable int currentEraIndex_ = -1;
+
+  EventNode node_;
 
   /// Non-owning pointer to an object that samples representative run numbers
   RunSampler const *runSampler_;
@@ -132,7 +166,7 @@ class PileUpWeight : public WeightBase {
   int defaultWeightIndex_;
 
   /// Interface to read the expected number of pileup interactions
-  mutable TTreeReaderValue<float> mu_;
+  BulkValue<float> mu_;
 };
 
 #endif  // HZZ2L2NU_INCLUDE_PILEUPWEIGHT_H_
@@ -10,11 +10,13 @@
 
 #include <TTreeReaderArray.h>
 
+#include <BulkReader.h>
 #include <CollectionBuilder.h>
 #include <Dataset.h>
-#include <EventCache.h>
+#include <EventGraph.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
+#include <ShapeSyst.h>
 
 
 /**
@@ -23,7 +25,8 @@
  * Starts from raw missing pt. Type 1 correction, i.e. changes caused by
  * corrections applied to other objects, such as jets, can be included using
  * method \ref PullCalibration. Variations in "unclustered" momentum are applied
- * if requested via the \c syst option.
+ * if they are included in the given ShapeSyst. Missing pt is rebuilt whenever
+ * the current shape variation changes.
  *
  * If the master configuration contains field \c fix_ee_2017 in section
  * \c ptmiss and it is set to true, applies the
@@ -31,7 +34,8 @@
  */
 class PtMissBuilder {
  public:
-  PtMissBuilder(Dataset &dataset, Options const &options);
+  PtMissBuilder(Dataset &dataset, Options const &options,
+                ShapeSyst const &shapeSyst);
 
   /// Returns missing pt in the current event
   PtMiss const &Get() const;
@@ -42,30 +46,29 @@ class PtMissBuilder {
    *
    * For example, changes in jet momenta due to variations in their corrections
    * can be included this way. If this method is called multiple times, new
-   * builders are added to the list of already registered builders.
+   * builders are added to the list of already registered builders. The
+   * builders are registered as inputs of the node of this object in the
+   * EventGraph.
    */
   void PullCalibration(
     std::initializer_list<CollectionBuilderBase const *> builders);
 
  private:
-  /// Supported systematic variations
-  enum class Syst {
-    None,
-    UnclEnergyUp,
-    UnclEnergyDown
-  };
-
   /// Constructs ptmiss in the current event
   void Build() const;
 
-  /// Systematic variation to be applied
-  Syst syst_;
+  /// Shape variations to be applied
+  ShapeSyst const &shapeSyst_;
 
   /// Whether to apply the EE noise mitigation
   bool applyEeNoiseMitigation_;
 
-  /// An object to facilitate caching
-  EventCache cache_;
+  /**
+   * \brief Node in the EventGraph that calls \ref Build
+   *
+   * It is associated with \ref shapeSyst_.
+   */
+  EventNode node_;
 
   /// Objects registered with \ref PullCalibration
   std::vector<CollectionBuilderBase const *> calibratingBuilders_;
@@ -77,7 +80,7 @@ class PtMissBuilder {
 
   mutable TTreeReaderValue<int> srcNumPV_;
   mutable TTreeReaderValue<float> srcPt_, srcPhi_;
-  mutable TTreeReaderValue<UInt_t> srcRun_;
+  BulkValue<UInt_t> srcRun_;
   mutable std::optional<TTreeReaderValue<float>> srcSignificance_;
   mutable std::optional<TTreeReaderValue<float>> srcUnclEnergyUpDeltaX_,
       srcUnclEnergyUpDeltaY_;
@@ -0,0 +1,198 @@
+#ifndef HZZ2L2NU_INCLUDE_RANDOMGENERATOR_H_
+#define HZZ2L2NU_INCLUDE_RANDOMGENERATOR_H_
+
+#include <array>
+#include <cstdint>
+
+#include <BulkReader.h>
+#include <Dataset.h>
+
+
+/**
+ * \brief Engine for RandomGenerator
+ *
+ * This class provides reproducible random numbers. Multiple numbers per event
+ * can be obtained using different channels. The numbers returned for a given
+ * channel in an event with a given ID are always the same.
+ *
+ * This class is not expected to be used directly but via RandomGenerator
+ * instead. Each instance of the latter registers itself as a consumer of random
+ * numbers.
+ *
+ * Internally, the counter-based generator Philox4x32-10 [1] is used. Its
+ * counter is made of the event number, the luminosity block, and the channel,
+ * and the key is fixed. The engine has no state that changes from one draw to
+ * another, so random numbers can be produced in any order and in parallel.
+ * [1] J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3",
+ * https://doi.org/10.1145/2063384.2063405
+ */
+class RngEngine {
+ public:
+  /// Block of random integers produced by a single evaluation of Philox
+  using block_t = std::array<uint32_t, 4>;
+
+  /// Identification of an event used to construct the counter
+  struct EventId {
+    uint64_t event;
+    uint32_t luminosityBlock;
+  };
+
+  /// Constructor from a dataset
+  RngEngine(Dataset &dataset);
+
+  /// Returns identification of the current event
+  EventId CurrentEvent() const {
+    return {*event_, *luminosityBlock_};
+  }
+
+  /**
+   * \brief Computes the block of random integers for the given event and
+   * channel
+   *
+   * It is responsibility of the caller to include the offset returned by
+   * \ref Register into the provided channel number. No check on the given
+   * channel number is done.
+   */
+  static block_t Generate(EventId const &eventId, uint32_t channel);
+
+  /// Computes the block of random integers for given channel in current event
+  block_t Read(int channel) const {
+    return Generate(CurrentEvent(), channel);
+  }
+
+  /**
+   * \brief Registers a new consumer of random numbers
+   *
+   * The consumer must respect the returned offset to ensure that the set of
+   * random numbers it reads does not overlap with the sets read by other
+   * consumers.
+   *
+   * \param[in] numChannels  Number of random numbers that can be used by this
+   *     consumer per event.
+   * \return Offset that determines the start of the range of channels allocated
+   *     for this consumer.
+   */
+  int Register(int numChannels = 1);
+
+  /// Converts a block into a number uniformly distributed in (0, 1)
+  static double ToUniform(block_t const &block) {
+    // Use 53 random bits, which is the precision of double
+    uint64_t const bits = ((uint64_t(block[0]) << 32) | block[1]) >> 11;
+    return (bits + 0.5) * 0x1p-53;
+  }
+
+  /**
+   * \brief Converts a block into a number following the standard normal
+   * distribution
+   *
+   * Uses the Box-Muller transform.
+   */
+  static double ToNormal(block_t const &block);
+
+ private:
+  /// Key of the generator
+  static constexpr std::array<uint32_t, 2> kKey_{1439, 0x48a3c5e1};
+
+  /// Total number of channels registered
+  int numChannelsRegistered_;
+
+  /// Readers to access the event ID
+  BulkValue<ULong64_t> event_;
+  BulkValue<UInt_t> luminosityBlock_;
+};
+
+
+inline RngEngine::block_t RngEngine::Generate(
+    EventId const &eventId, uint32_t channel) {
+  constexpr uint32_t kMul0 = 0xD2511F53, kMul1 = 0xCD9E8D57;
+  constexpr uint32_t kWeyl0 = 0x9E3779B9, kWeyl1 = 0xBB67AE85;
+
+  block_t ctr{channel, eventId.luminosityBlock, uint32_t(eventId.event),
+              uint32_t(eventId.event >> 32)};
+  uint32_t key0 = kKey_[0], key1 = kKey_[1];
+
+  for (int round = 0; round < 10; ++round) {
+    uint64_t const prod0 = uint64_t(kMul0) * ctr[0];
+    uint64_t const prod1 = uint64_t(kMul1) * ctr[2];
+    ctr = {uint32_t(prod1 >> 32) ^ ctr[1] ^ key0, uint32_t(prod1),
+           uint32_t(prod0 >> 32) ^ ctr[3] ^ key1, uint32_t(prod0)};
+    key0 += kWeyl0;
+    key1 += kWeyl1;
+  }
+
+  return ctr;
+}
+
+
+/**
+ * \brief Interface to obtain random numbers
+ *
+ * Uses RngEngine. The number of random numbers consumed per event (number of
+ * channels) is a parameter of an object of this class. All methods that return
+ * random numbers accept the channel as the first argument; if it is larger or
+ * equal than the requested number of channels, it is silently wrapped around.
+ *
+ * Batch versions of the methods fill arrays with random numbers for
+ * consecutive channels, for example one per jet or muon in the current event.
+ */
+class RandomGenerator {
+ public:
+  /**
+   * \brief Constructor
+   *
+   * \param[in] engine  Engine to be used. A reference is saved internally.
+   * \param[in] numChannels  (Maximal) number of different random numbers
+   *     consumed per event.
+   */
+  RandomGenerator(RngEngine &engine, int numChannels = 1);
+
+  /// Obtain a random number following normal distribution with given parameters
+  double Gaus(int channel, double mean = 0., double sigma = 1.) const;
+
+  /**
+   * \brief Fills an array with random numbers following the standard normal
+   * distribution
+   *
+   * \param[in] firstChannel  Channel for the first number.
+   * \param[in] n  Number of random numbers to produce. They are given by
+   *   channels from \c firstChannel to <tt>firstChannel + n - 1</tt>.
+   * \param[out] values  Array of size \c n to be filled.
+   */
+  void Gaus(int firstChannel, int n, double *values) const;
+
+  /// Obtain a random number uniformly distributed on (0, 1)
+  double Rndm(int channel) const;
+
+  /**
+   * \brief Fills an array with random numbers uniformly distributed on (0, 1)
+   *
+   * The arguments have the same meaning as in the batch version of \ref Gaus.
+   */
+  void Rndm(int firstChannel, int n, double *values) const;
+
+  /**
+   * \brief Reads the event ID in the current event
+   *
+   * Needed before random numbers are requested concurrently, see EventGraph.
+   */
+  void Prefetch() const {
+    engine_.CurrentEvent();
+  }
+
+ private:
+  /// Translates the channel of this generator into the channel for the engine
+  uint32_t EngineChannel(int channel) const {
+    return offset_ + channel % numChannels_;
+  }
+
+  /// Underlying engine
+  RngEngine &engine_;
+
+  /// Number of channels used by this generator
+  int numChannels_;
+
+  /// Offset returned by \ref RngEngine::Register
+  int offset_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_RANDOMGENERATOR_H_
@@ -5,12 +5,11 @@
 #include <vector>
 #include <utility>
 
-#include <TTreeReaderValue.h>
-
+#include <BulkReader.h>
 #include <Dataset.h>
-#include <EventCache.h>
+#include <EventGraph.h>
 #include <Options.h>
-#include <TabulatedRandomGenerator.h>
+#include <RandomGenerator.h>
 
 
 /**
@@ -37,7 +36,7 @@ class RunSampler {
   using run_t = int32_t;
 
   RunSampler(Dataset &dataset, Options const &options,
-             TabulatedRngEngine &rngEngine);
+             RngEngine &rngEngine);
 
   /**
    * \brief Returns the run number for the current event
@@ -49,6 +48,11 @@ class RunSampler {
    */
   run_t Get() const;
 
+  /// Returns the node that represents this object in the EventGraph
+  EventNode const &GetNode() const {
+    return node_;
+  }
+
  private:
   /// Updates per-event cache by sampling or reading new run number
   void Build() const;
@@ -68,8 +72,8 @@ class RunSampler {
    */
   bool samplingEnabled_;
 
-  /// Implements per-event caching
-  EventCache cache_;
+  /// Node in the EventGraph that calls \ref Build
+  EventNode node_;
 
   /// Sampled or read run number cached for the current event
   mutable run_t currentRun_;
@@ -79,10 +83,10 @@ class RunSampler {
    *
    * Only used when \ref samplingEnabled_ is false.
    */
-  mutable std::optional<TTreeReaderValue<UInt_t>> srcRun_;
+  std::optional<BulkValue<UInt_t>> srcRun_;
 
   /// Random number generator to do the sampling
-  TabulatedRandomGenerator tabulatedRng_;
+  RandomGenerator rng_;
 
   /**
    * \brief Cumulative probabilities for the sampling
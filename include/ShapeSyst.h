@@ -0,0 +1,99 @@
+#ifndef HZZ2L2NU_INCLUDE_SHAPESYST_H_
+#define HZZ2L2NU_INCLUDE_SHAPESYST_H_
+
+#include <string_view>
+#include <vector>
+
+#include <Dataset.h>
+#include <Options.h>
+
+
+/**
+ * \brief Describes shape systematic variations evaluated in the current job
+ *
+ * Shape variations are those that change momenta of reconstructed objects, as
+ * opposed to variations in event weights. Normally a single variation is
+ * evaluated in a job. It is selected with the \c syst option (e.g.
+ * <tt>--syst=jec_up</tt>), and if none of the supported labels is given, the
+ * nominal configuration is used.
+ *
+ * With <tt>--syst=shapes</tt> all supported shape variations are evaluated in
+ * a single pass over the input files. The list then starts with the nominal
+ * configuration, which is followed by all variations. In real data only the
+ * nominal configuration is included. Builders that are affected by the
+ * variations (JetBuilder, PtMissBuilder) construct their collections for all
+ * variations at once and return the one for the variation that is currently
+ * selected with \ref SetCurrent. Per-event caches of objects that depend on
+ * those collections should be invalidated when the current variation changes.
+ * This is done by associating their nodes in the EventGraph with the ShapeSyst
+ * object.
+ */
+class ShapeSyst {
+ public:
+  /// Supported shape variations
+  enum class Variation : int {
+    kNominal,
+    kJecUp,
+    kJecDown,
+    kJerUp,
+    kJerDown,
+    kUnclEnergyUp,
+    kUnclEnergyDown
+  };
+
+  ShapeSyst(Dataset &dataset, Options const &options);
+
+  /// Returns the variation with the given index
+  Variation Get(int index) const {
+    return variations_[index];
+  }
+
+  /// Returns the variation that is currently selected
+  Variation GetCurrent() const {
+    return variations_[current_];
+  }
+
+  /// Returns the index of the variation that is currently selected
+  int GetCurrentIndex() const {
+    return current_;
+  }
+
+  /// Checks if at least one of the evaluated variations affects JEC
+  bool HasJecVariation() const;
+
+  /// Checks if at least one of the evaluated variations affects JER
+  bool HasJerVariation() const;
+
+  /**
+   * \brief Indicates whether all shape variations are evaluated in the same
+   * pass
+   */
+  bool IsMultiple() const {
+    return variations_.size() > 1;
+  }
+
+  /**
+   * \brief Returns label of the variation with the given index
+   *
+   * The label matches the value of the \c syst option that requests this
+   * variation. It is empty for the nominal configuration.
+   */
+  std::string_view Label(int index) const;
+
+  /// Returns the number of variations evaluated in this job
+  int NumVariations() const {
+    return variations_.size();
+  }
+
+  /// Selects the variation with the given index as the current one
+  void SetCurrent(int index);
+
+ private:
+  /// Variations evaluated in this job
+  std::vector<Variation> variations_;
+
+  /// Index of the currently selected variation
+  int current_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_SHAPESYST_H_
@@ -1,6 +1,7 @@
 #ifndef smartselectionmonitor_hzz_hh
 #define smartselectionmonitor_hzz_hh
 
+#include <FourMomentum.h>
 #include <PhysicsObjects.h>
 #include <SmartSelectionMonitor.h>
 #include <Utils.h>
@@ -33,7 +34,7 @@ struct base_evt{
   double jet3_pT;
   double HT_selJets;
 
-  void Fill_baseEvt(TString s_jetCat_, TString s_lepCat_, TLorentzVector boson_, TLorentzVector METVector_, std::vector<Jet> const &selJets_, double run_, double PV_npvsGood_, double fixedGridRhoFastjetAll_, double MET_significance_){ 
+  void Fill_baseEvt(TString s_jetCat_, TString s_lepCat_, FourMomentum boson_, FourMomentum METVector_, std::vector<Jet> const &selJets_, double run_, double PV_npvsGood_, double fixedGridRhoFastjetAll_, double MET_significance_){ 
     s_jetCat = s_jetCat_;
     s_lepCat = s_lepCat_;
     MT = sqrt(pow(sqrt(pow(boson_.Pt(),2)+pow(boson_.M(),2))+sqrt(pow(METVector_.Pt(),2)+pow(91.1876,2)),2)-pow((boson_+METVector_).Pt(),2));;
@@ -54,13 +55,10 @@ struct base_evt{
     deltaPhi_MET_Boson = fabs(utils::deltaPhi(boson_, METVector_));
     METoPT = METVector_.Pt()/(1.*boson_.Pt());
     double METorth_ =0, METpar_ = 0;
-    TVector3 bosonDir = boson_.Vect();
-    if (bosonDir.Perp()>0){
-      TVector3 bosonDir2D(bosonDir.x()/bosonDir.Perp(), bosonDir.y()/bosonDir.Perp(), 0);
-      TVector3 bosonPerp2D(-bosonDir2D.y(),bosonDir2D.x(),0);
-      TVector3 METVector3D = METVector_.Vect();
-      METpar_ = - METVector3D.Dot(bosonDir2D);
-      METorth_ = METVector3D.Dot(bosonPerp2D);
+    if (boson_.Pt()>0){
+      double bosonDirX = boson_.Px()/boson_.Pt(), bosonDirY = boson_.Py()/boson_.Pt();
+      METpar_ = - (METVector_.Px()*bosonDirX + METVector_.Py()*bosonDirY);
+      METorth_ = - METVector_.Px()*bosonDirY + METVector_.Py()*bosonDirX;
     }
     METpar = METpar_;
     METperp = METorth_;
@@ -84,8 +82,8 @@ struct evt : base_evt{
   double lep2eta;
   
   void Fill_evt(
-      TString s_jetCat_, TString s_lepCat_, TLorentzVector boson_,
-      TLorentzVector METVector_, std::vector<Jet> const &selJets_,
+      TString s_jetCat_, TString s_lepCat_, FourMomentum boson_,
+      FourMomentum METVector_, std::vector<Jet> const &selJets_,
       double run_, double PV_npvsGood_, double fixedGridRhoFastjetAll_,
       double MET_significance_, std::vector<Lepton> const &selLeptons_) {
     
@@ -109,7 +107,7 @@ struct photon_evt : base_evt{
   double phoIsoRhoCorr;
   double R9;
 
-  void Fill_photonEvt(TString s_jetCat_, TString s_lepCat_, TLorentzVector boson_, TLorentzVector METVector_, std::vector<Jet> const &selJets_, double run_, double PV_npvsGood_, double fixedGridRhoFastjetAll_, double MET_significance_, double HoE_ = -1., double sigmaIEtaIEta_ = -1., double chIsoRhoCorr_ = -1., double neuIsoRhoCorr_ = -1., double phoIsoRhoCorr_ = -1., double R9_ = -1.){
+  void Fill_photonEvt(TString s_jetCat_, TString s_lepCat_, FourMomentum boson_, FourMomentum METVector_, std::vector<Jet> const &selJets_, double run_, double PV_npvsGood_, double fixedGridRhoFastjetAll_, double MET_significance_, double HoE_ = -1., double sigmaIEtaIEta_ = -1., double chIsoRhoCorr_ = -1., double neuIsoRhoCorr_ = -1., double phoIsoRhoCorr_ = -1., double R9_ = -1.){
     Fill_baseEvt(s_jetCat_, s_lepCat_, boson_, METVector_, selJets_, run_, PV_npvsGood_, fixedGridRhoFastjetAll_, MET_significance_);
     HoE = HoE_;
     sigmaIEtaIEta = sigmaIEtaIEta_;
@@ -8,6 +8,7 @@
 #include <TTreeReaderValue.h>
 
 #include <CollectionBuilder.h>
+#include <Columns.h>
 #include <Dataset.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -36,8 +37,11 @@ class TauBuilder : public CollectionBuilder<Tau> {
   /// Collection of Taus
   mutable std::vector<Tau> Taus_;
 
-  mutable TTreeReaderArray<float> srcPt_, srcEta_, srcPhi_;
-  mutable TTreeReaderArray<int> srcDecayMode_;
+  /// Selection of Taus in the input collection
+  mutable SelectionMask mask_;
+
+  ColumnReader<float> srcPt_, srcEta_, srcPhi_;
+  ColumnReader<int> srcDecayMode_;
 
 };
 
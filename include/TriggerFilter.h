@@ -2,18 +2,16 @@
 #define HZZ2L2NU_INCLUDE_TRIGGERFILTER_H_
 
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
-#include <TBranch.h>
-#include <TChain.h>
-#include <TTreeReader.h>
-
+#include <BulkReader.h>
 #include <Dataset.h>
-#include <EventCache.h>
+#include <EventGraph.h>
 #include <Options.h>
 #include <RunSampler.h>
 
@@ -39,9 +37,9 @@
  * in each of the associated run ranges) and different channels.
  *
  * Branch with decisions of a given trigger is not guaranteed to be present in
- * every file of a dataset. Because of this, the branches are read directly,
- * bypassing the TTreeReader. They must not be accessed outside of this class in
- * order not to overwrite the buffers associated with the branches.
+ * every file of a dataset. Because of this, the branches are read with
+ * optional BulkValue objects, and a trigger whose branch is missing in the
+ * current file is treated as not firing.
  */
 class TriggerFilter {
  public:
@@ -59,7 +57,7 @@ class TriggerFilter {
   /// Type representing run number
   using run_t = RunSampler::run_t;
 
-  /// Trigger with associated branch and buffer
+  /// Trigger with associated decision
   struct Trigger {
     /// Comparison needed to use Triger in an std::set
     struct Compare {
@@ -69,21 +67,18 @@ class TriggerFilter {
     };
 
     Trigger(std::string_view name_)
-      : name{name_}, branch{nullptr} {}
+      : name{name_} {}
 
     /// Name of the trigger, without "HLT_" prefix and version postfix
     std::string name;
 
     /**
-     * \brief Branch that contains trigger decision
+     * \brief Reader for the trigger decision
      *
-     * Set to nullptr if the current tree doesn't contain a branch for this
-     * trigger.
+     * Constructed after the configuration has been read, since the triggers
+     * are stored in an std::set.
      */
-    mutable TBranch *branch;
-
-    /// Buffer into which the branch will be read
-    mutable Bool_t decision;
+    mutable std::optional<BulkValue<Bool_t>> decision;
   };
 
   /// Trigger with associated run range
@@ -127,11 +122,7 @@ class TriggerFilter {
     mutable bool decision;
   };
 
-  /**
-   * \brief Updates per-event cache
-   *
-   * If needed, configures trigger branches. Reads trigger decisions.
-   */
+  /// Updates per-event cache
   void Build() const;
 
   /// Reads trigger selection from configuration
@@ -140,17 +131,8 @@ class TriggerFilter {
   /// Provides run numbers
   RunSampler const *runSampler_;
 
-  /// Implements per-event caching
-  EventCache cache_;
-
-  /// Non-owning pointer to the TTreeReader from the dataset
-  TTreeReader const *reader_;
-
-  /// Chain associated with the TTreeReader
-  TChain *chain_;
-
-  /// Index of the current tree in the chain
-  mutable int treeIndex_;
+  /// Node in the EventGraph that calls \ref Build
+  EventNode node_;
 
   /**
    * \brief Used triggers
@@ -3,14 +3,17 @@
 
 #include <WeightBase.h>
 
+#include <map>
+#include <string>
+
+#include <BinnedTable.h>
 #include <Dataset.h>
+#include <EventGraph.h>
 #include <ElectronBuilder.h>
 #include <MuonBuilder.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
 
-#include <TH2.h>
-
 /**
  * \brief Applies trigger efficiency scale factors
  *
@@ -30,22 +33,19 @@ class TriggerWeight : public WeightBase {
 
   /// Computes the total trigger efficiency weight for the current event
   double NominalWeight() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[0];
   }
 
 
   double operator()() const override {
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[defaultWeightIndex_];
   }
 
   double RelWeight(int variation) const override {
 
-    if (cache_.IsUpdated())
-      Update();
+    node_.Evaluate();
     return weights_[variation + 1] / weights_[defaultWeightIndex_];
   }
 	
@@ -69,11 +69,11 @@ class TriggerWeight : public WeightBase {
    * \brief Store efficiency tables in the map
    *
    * Read the root file with given path and store all
-   * histograms together with their names.
+   * histograms, converted into lookup tables, together with their names.
    */
   void ReadHistogram(
     std::string const &pathWithName,
-		std::map<std::string, std::unique_ptr<TH2D>> &th2Map);
+		std::map<std::string, BinnedTable2D> &th2Map);
   
   /**
    * \brief Cached weights
@@ -85,7 +85,7 @@ class TriggerWeight : public WeightBase {
    */
   mutable std::array<double, 7> weights_;
 
-  EventCache cache_;
+  EventNode node_;
  
   /**
    * \brief Index of the default weight to be returned by operator()
@@ -105,7 +105,7 @@ class TriggerWeight : public WeightBase {
   int efficiencyType_;
 
 	/// Trigger efficiency table for 3 channels
-  std::map<std::string, std::unique_ptr<TH2D>> 
+  std::map<std::string, BinnedTable2D> 
   mumuScaleFactors_, eeScaleFactors_, emuScaleFactors_;
 
   /// Non-owning pointer to object that provides collection of electrons
@@ -12,11 +12,11 @@
 #include <TFile.h>
 #include <TH1.h>
 #include <TH2.h>
-#include <TLorentzVector.h>
 #include <TString.h>
 #include <TTreeReaderArray.h>
 #include <TVector2.h>
 
+#include <FourMomentum.h>
 #include <HZZException.h>
 #include <Options.h>
 #include <PhysicsObjects.h>
@@ -31,15 +31,15 @@ inline double DeltaR2(double eta1, double phi1, double eta2, double phi2) {
 }
 
 /// Computes squared distance in (eta, phi) metric
-inline double DeltaR2(TLorentzVector const &p1, TLorentzVector const &p2) {
+inline double DeltaR2(FourMomentum const &p1, FourMomentum const &p2) {
   return DeltaR2(p1.Eta(), p1.Phi(), p2.Eta(), p2.Phi());
 }
 
-double deltaPhi(TLorentzVector const &v1, TLorentzVector const &v2);
+double deltaPhi(FourMomentum const &v1, FourMomentum const &v2);
 
 double deltaPhi (float phi1, float phi2);
 
-bool PassVbfCuts(std::vector<Jet> const &jets, TLorentzVector const &boson);
+bool PassVbfCuts(std::vector<Jet> const &jets, FourMomentum const &boson);
 
 std::map<double, double> TH1toMap(TH1D *h_weight);
 
@@ -1,12 +1,20 @@
 #ifndef VBFDISCRIMINANT_H
 #define VBFDISCRIMINANT_H
 
+#include <array>
+#include <cstdint>
+#include <memory>
+
 #include <TSpline.h>
 
 #include <Mela.h>
 #include <GMECHelperFunctions.h>
 
+#include <BulkReader.h>
+#include <Dataset.h>
 #include <JetBuilder.h>
+#include <MelaCache.h>
+#include <MelaWorkerPool.h>
 #include <Options.h>
 
 
@@ -18,11 +26,26 @@
  * <a href="https://github.com/MELALabs/MelaAnalytics">MelaAnalyctics</a>
  * packags based on Reco information.
  * Discriminants are cached on a per-event basis.
+ *
+ * If parameter \c vbf_discriminant.cache_dir is given in the configuration,
+ * matrix-element probabilities are also stored in a persistent MelaCache in
+ * that directory, with a separate file for each dataset. They are then reused
+ * in later runs over the same events with the same jets, for instance for other
+ * systematic variations. The cache is invalidated automatically whenever the
+ * MELA configuration in section \c vbf_discriminant changes.
+ *
+ * The MELA object is global and not thread-safe, and therefore computations
+ * with it are serialized among all instances of this class. If parameter
+ * \c vbf_discriminant.workers is set to a positive number, the computations are
+ * instead performed in a MelaWorkerPool with the given number of helper
+ * processes, shared by all instances. This allows instances used in different
+ * threads of the event loop to compute discriminants concurrently. All
+ * instances are assumed to use the same configuration.
  */
 class VBFDiscriminant {
   public:
     // Constructor
-    VBFDiscriminant(Options const &options);
+    VBFDiscriminant(Dataset &dataset, Options const &options);
 
     // Destructor
     ~VBFDiscriminant();
@@ -51,20 +74,41 @@ class VBFDiscriminant {
      * \param[in] jets      Reconstructed jets with tight ID.
      */
     std::array<double, 4> const &Get(
-        TLorentzVector const &p4LL,
-        TLorentzVector const &p4Miss,
+        FourMomentum const &p4LL,
+        FourMomentum const &p4Miss,
         std::vector<Jet> const &jets);
 
   private:
     /// Resets Mela settings for next event DjjVBF discriminants computation.
     void Reset();
 
-    /// Builds Mela candidate based on the reconstructed Physics Objects.
-    void BuildMelaCandidate(TLorentzVector const &p4LL,
-        TLorentzVector const &p4Miss, std::vector<Jet> const &jets);
+    /// Builds Mela candidate from given ZZ candidate and jets.
+    void BuildMelaCandidate(FourMomentum const &p4ZZ,
+        std::vector<FourMomentum> const &jets);
 
     /// Computes Mela clusters
     void ComputeClusters() const;
+
+    /**
+     * \brief Computes matrix-element probabilities for given ZZ candidate and
+     * jets with the MELA object of the current process
+     *
+     * The probabilities are indexed with \ref MEP.
+     */
+    MelaCache::Values ComputeProbabilities(FourMomentum const &p4ZZ,
+        std::vector<FourMomentum> const &jets);
+
+    /**
+     * \brief Computes matrix-element probabilities for \ref p4ZZApprox_ and
+     * \ref jetP4_
+     *
+     * Uses the worker pool if available. Otherwise calls
+     * \ref ComputeProbabilities, serializing with other instances.
+     */
+    MelaCache::Values EvaluateProbabilities();
+
+    /// Computes hash of the kinematics given to MELA
+    uint64_t HashInputs() const;
     
     /// Facilitates accessing to the Mela object
     Mela *melaHandle_;
@@ -82,7 +126,10 @@ class VBFDiscriminant {
     std::vector<MELACluster*> clusters_;
     
     /// Stores Approximate 4-momentum of ZZ system
-    TLorentzVector p4ZZApprox_;
+    FourMomentum p4ZZApprox_;
+
+    /// Momenta of jets in the current event
+    std::vector<FourMomentum> jetP4_;
 
     /// Stores DjjVBF discriminants for a1 (SM), a2 and a3 couplings
     std::array<double, 4> dJJVBF_;
@@ -93,6 +140,16 @@ class VBFDiscriminant {
     /// Stores g and c constants values used in Djj VBF discriminant formula
     std::unique_ptr<TSpline3> cConstant_;
     std::array<std::unique_ptr<TSpline3>, 4> gConstant_;
+
+    /// Persistent cache of probabilities. Not created if not requested.
+    std::unique_ptr<MelaCache> cache_;
+
+    /// Pool of helper processes. Not created if not requested.
+    std::shared_ptr<MelaWorkerPool> workerPool_;
+
+    /// Event ID, used as a key in \ref cache_
+    BulkValue<UInt_t> srcRun_, srcLumi_;
+    BulkValue<ULong64_t> srcEvent_;
 };
 
 #endif
@@ -47,6 +47,26 @@ class WeightBase {
     return std::numeric_limits<double>::quiet_NaN();
   };
 
+  /**
+   * \brief Computes the nominal weight and relative weights for all systematic
+   * variations at once
+   *
+   * \param[out] weights  Array of size <tt>NumVariations() + 1</tt>. The
+   *   nominal weight is written at index 0, and it is followed by relative
+   *   weights for all variations in the order of their indices.
+   *
+   * The default implementation calls \ref NominalWeight and \ref RelWeight.
+   * A derived class should override this method if computing all variations
+   * together is cheaper than computing them one by one.
+   */
+  virtual void FillVariations(float *weights) const {
+    weights[0] = NominalWeight();
+    int const numVariations = NumVariations();
+
+    for (int i = 0; i < numVariations; ++i)
+      weights[i + 1] = RelWeight(i);
+  }
+
   /**
    * \brief Returns the label of the systematic variation with the given index
    *
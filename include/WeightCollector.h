@@ -50,6 +50,21 @@ class WeightCollector {
    */
   double operator()() const;
 
+  /**
+   * \brief Computes the combined nominal weight and relative weights for all
+   * variations in a single pass
+   *
+   * \param[out] weights  Array of size <tt>NumVariations() + 1</tt>. The
+   *   combined nominal weight is written at index 0, and it is followed by
+   *   relative weights for all variations in the order of their global
+   *   indices.
+   *
+   * Each registered computer is asked once to fill its variations with
+   * WeightBase::FillVariations. This is more efficient than calling
+   * \ref RelWeight for each variation.
+   */
+  void FillVariations(float *weights) const;
+
   /// Total number of systematic variations in all registered computers
   int NumVariations() const;
 
@@ -0,0 +1,88 @@
+#ifndef HZZ2L2NU_INCLUDE_XGBOOSTCOMPILEDMODEL_H_
+#define HZZ2L2NU_INCLUDE_XGBOOSTCOMPILEDMODEL_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+/**
+ * \brief XGBoost model compiled into native code
+ *
+ * Source files with compiled models are generated from saved XGBoost models
+ * with script bin/compile_xgboost_model.py and placed in directory
+ * src/XGBoostModels, from which they are picked up by the build system. Each of
+ * them defines a static object of this class, which registers the model under
+ * its name. A registered model can then be found with \ref Get.
+ *
+ * Every compiled model is accompanied by a set of probe examples, chosen by the
+ * generator around the split thresholds of the model. They are used by
+ * XGBoostPredictor to check that the compiled model reproduces predictions of
+ * the original one.
+ */
+class XGBoostCompiledModel {
+ public:
+  /// Function that computes prediction of a model for a single example
+  using PredictFunction = float (*)(float const *x);
+
+  /**
+   * \brief Constructor
+   *
+   * \param[in] name  Name under which the model is registered.
+   * \param[in] numFeatures  Number of input features of the model.
+   * \param[in] predict  Function that computes prediction of the model.
+   * \param[in] probes  Probe examples, stored row by row.
+   *
+   * Throws an exception if a model with the same name has already been
+   * registered.
+   */
+  XGBoostCompiledModel(
+      std::string name, int numFeatures, PredictFunction predict,
+      std::vector<float> probes);
+
+  XGBoostCompiledModel(XGBoostCompiledModel const &) = delete;
+  XGBoostCompiledModel &operator=(XGBoostCompiledModel const &) = delete;
+
+  /**
+   * \brief Returns the compiled model with the given name
+   *
+   * Throws an exception if no such model has been registered.
+   */
+  static XGBoostCompiledModel const &Get(std::string const &name);
+
+  /// Returns the name of the model
+  std::string const &GetName() const {
+    return name_;
+  }
+
+  /// Returns the number of input features of the model
+  int GetNumFeatures() const {
+    return numFeatures_;
+  }
+
+  /// Returns the number of probe examples
+  int GetNumProbes() const {
+    return probes_.size() / numFeatures_;
+  }
+
+  /// Returns probe examples, stored row by row
+  float const *GetProbes() const {
+    return probes_.data();
+  }
+
+  /// Computes prediction of the model for a single example
+  float Predict(float const *x) const {
+    return predict_(x);
+  }
+
+ private:
+  /// Returns the map with all registered models
+  static std::map<std::string, XGBoostCompiledModel const *> &Registry();
+
+  std::string name_;
+  int numFeatures_;
+  PredictFunction predict_;
+  std::vector<float> probes_;
+};
+
+#endif  // HZZ2L2NU_INCLUDE_XGBOOSTCOMPILEDMODEL_H_
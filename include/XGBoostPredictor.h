@@ -6,6 +6,8 @@
 
 #include <xgboost/c_api.h>
 
+#include <XGBoostCompiledModel.h>
+
 
 /// Exception class for calls to XGBoost C API
 class XGBoostPredictorException : public std::exception {
@@ -33,10 +35,16 @@ class XGBoostPredictorException : public std::exception {
  * \brief Simple wrapper around XGBoost C API
  *
  * This class loads a saved XGBoost model from a file and computes its
- * predictions, for one example at a time. The predictions require memory
- * allocation and deallocation for each example, which is not optimal.
- * Unfortunately, in XGBoost 0.90 API this is the only way to compute
- * predictions per example.
+ * predictions. XGBoost 0.90 API requires that a DMatrix is created and freed
+ * for each call to the model, which involves memory allocation and
+ * deallocation. To amortize this overhead, predictions for multiple examples
+ * should be computed in a single call to \ref Predict whenever possible.
+ *
+ * Alternatively, predictions can be computed with a version of the model
+ * compiled into native code (see XGBoostCompiledModel), which avoids the
+ * overhead altogether. The original model is still loaded in this case, and
+ * the constructor checks that the compiled model reproduces its predictions
+ * for the probe examples provided with the compiled model.
  */
 class XGBoostPredictor {
  public:
@@ -45,8 +53,12 @@ class XGBoostPredictor {
    *
    * \param[in] path  Path to a file with XGBoost model.
    * \param[in] numFeatures  Number of input features.
+   * \param[in] compiledModel  Name of the compiled version of the model, as
+   *   registered in XGBoostCompiledModel. If empty, the model is evaluated
+   *   with XGBoost library.
    */
-  XGBoostPredictor(std::string const &path, int numFeatures);
+  XGBoostPredictor(std::string const &path, int numFeatures,
+                   std::string const &compiledModel = "");
 
   ~XGBoostPredictor();
 
@@ -59,6 +71,18 @@ class XGBoostPredictor {
    */
   float Predict(float const *x) const;
 
+  /**
+   * \brief Computes predictions of the XGBoost model for a block of examples
+   *
+   * \param[in] x  Array of features describing the examples, stored row by
+   *   row. Starting from the given position, \c numExamples * \c numFeatures_
+   *   elements will be read.
+   * \param[in] numExamples  Number of examples.
+   * \param[out] predictions  Array to which predictions of the model will be
+   *   written. Must be able to store \c numExamples elements.
+   */
+  void Predict(float const *x, int numExamples, float *predictions) const;
+
  private:
   /**
    * \brief Throws XGBoostPredictorException if the exit code is not 0
@@ -67,11 +91,30 @@ class XGBoostPredictor {
    */
   static void CheckCall(std::string const &functionName, int exitCode);
 
+  /**
+   * \brief Checks that the compiled model reproduces predictions of the
+   * original one for the probe examples
+   *
+   * Throws an exception if this is not the case.
+   */
+  void CheckCompiledModel() const;
+
+  /// Computes predictions with XGBoost library
+  void PredictLibrary(
+      float const *x, int numExamples, float *predictions) const;
+
   /// Pointer to XGBoost model
   BoosterHandle booster_;
 
   /// Number of input features specified in the constructor
   int numFeatures_;
+
+  /**
+   * \brief Non-owning pointer to compiled version of the model
+   *
+   * If nullptr, predictions are computed with XGBoost library.
+   */
+  XGBoostCompiledModel const *compiledModel_;
 };
 
 #endif  // HZZ2L2NU_INCLUDE_XGBOOSTPREDICTOR_H_
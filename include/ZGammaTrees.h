@@ -11,6 +11,7 @@
 #include <TTreeReaderValue.h>
 #include <TTreeReaderArray.h>
 
+#include <BulkReader.h>
 #include <Dataset.h>
 #include <EventNumberFilter.h>
 #include <EventTrees.h>
@@ -66,16 +67,11 @@ class ZGammaTrees final : public EventTrees {
 
   std::optional<GenPhotonBuilder> genPhotonBuilder_;
 
-  TTreeReaderValue<UInt_t> srcRun_;
-  TTreeReaderValue<UInt_t> srcLumi_;
-  TTreeReaderValue<ULong64_t> srcEvent_;
+  BulkValue<UInt_t> srcRun_;
+  BulkValue<UInt_t> srcLumi_;
+  BulkValue<ULong64_t> srcEvent_;
 
   mutable std::unique_ptr<TTreeReaderValue<Float_t>> srcLHEVpt_;
-  mutable std::unique_ptr<TTreeReaderValue<UInt_t>> numGenPart_;
-  mutable std::unique_ptr<TTreeReaderArray<Int_t>> genPartPdgId_;
-  mutable std::unique_ptr<TTreeReaderArray<Float_t>> genPartPt_, genPartEta_, genPartPhi_;
-  mutable std::unique_ptr<TTreeReaderArray<Int_t>> genPartStatus_;
-  mutable std::unique_ptr<TTreeReaderArray<Int_t>> genPartStatusFlags_;
 
   PhotonBuilder photonBuilder_;
 
@@ -106,7 +102,7 @@ class ZGammaTrees final : public EventTrees {
   Float_t leptonPt_[2], leptonEta_[2], leptonPhi_[2];
   Bool_t isOverlapped_;
 
-  TTreeReaderValue<int> srcNumPVGood_;
+  BulkValue<int> srcNumPVGood_;
 
   UInt_t run_, lumi_;
   ULong64_t event_;
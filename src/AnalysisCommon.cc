@@ -8,19 +8,21 @@ namespace po = boost::program_options;
 AnalysisCommon::AnalysisCommon(Options const &options, Dataset &dataset)
     : intLumi_{options.GetConfig()["luminosity"].as<double>()},
       isSim_{dataset.Info().IsSimulation()},
-      tabulatedRngEngine_{dataset},
-      runSampler_{dataset, options, tabulatedRngEngine_},
+      rngEngine_{dataset},
+      runSampler_{dataset, options, rngEngine_},
+      shapeSyst_{dataset, options},
       bTagger_{options}, pileUpIdFilter_{options},
       electronBuilder_{dataset, options},
-      muonBuilder_{dataset, options, tabulatedRngEngine_},
+      muonBuilder_{dataset, options, rngEngine_},
       tauBuilder_{dataset, options},
-      jetBuilder_{dataset, options, tabulatedRngEngine_, &pileUpIdFilter_},
-      ptMissBuilder_{dataset, options},
+      jetBuilder_{dataset, options, rngEngine_, shapeSyst_,
+                  &pileUpIdFilter_},
+      ptMissBuilder_{dataset, options, shapeSyst_},
       leptonWeight_{dataset, options, &electronBuilder_, &muonBuilder_},
       triggerWeight_{dataset, options, &electronBuilder_, &muonBuilder_},
       bTagWeight_{dataset, options, &bTagger_, &jetBuilder_},
       meKinFilter_{dataset}, metFilters_{options, dataset},
-      jetGeometricVeto_{dataset, options, &jetBuilder_, tabulatedRngEngine_} {
+      jetGeometricVeto_{dataset, options, &jetBuilder_, rngEngine_} {
 
   YAML::Node const &selectionCutsNode = options.GetConfig()["selection_cuts"];
   zMassWindow_ = selectionCutsNode["z_mass_window"].as<double>();
@@ -30,7 +32,17 @@ AnalysisCommon::AnalysisCommon(Options const &options, Dataset &dataset)
   minDphiLeptonsJetsPtMiss_ =
     selectionCutsNode["min_dphi_leptonsjets_ptmiss"].as<double>();
 
+  // Components that are needed in almost every event and do not depend on
+  // each other are evaluated eagerly. With option --event-threads, this
+  // happens concurrently.
+  electronBuilder_.GetNode().ScheduleEager();
+  muonBuilder_.GetNode().ScheduleEager();
+
   if (isSim_) {
+    genParticles_.emplace(dataset);
+    genParticles_->GetNode().ScheduleEager();
+    muonBuilder_.SetGenParticleIndex(&genParticles_.value());
+
     genJetBuilder_.emplace(dataset, options);
     jetBuilder_.SetGenJetBuilder(&genJetBuilder_.value());
   }
@@ -44,8 +56,9 @@ AnalysisCommon::AnalysisCommon(Options const &options, Dataset &dataset)
 
   if (isSim_) {
     genWeight_.emplace(dataset, options);
-    kFactorCorrection_.emplace(dataset, options);
-    ewCorrectionWeight_.emplace(dataset, options);
+    kFactorCorrection_.emplace(dataset, options, &genParticles_.value());
+    ewCorrectionWeight_.emplace(dataset, options, &genParticles_.value());
+    ewCorrectionWeight_->GetNode().ScheduleEager();
     pileUpWeight_.emplace(dataset, options, &runSampler_);
     l1tPrefiringWeight_.emplace(dataset, options);
 
@@ -74,7 +87,8 @@ po::options_description AnalysisCommon::OptionsDescription() {
   po::options_description optionsDescription{"Analysis-specific options"};
   optionsDescription.add_options()
     ("syst", po::value<std::string>()->default_value(""),
-     "Requested systematic variation")
+     "Requested systematic variation; \"shapes\" requests all shape "
+     "variations in a single pass")
     ("output,o", po::value<std::string>()->default_value("output.root"),
      "Name for output file with histograms");
   return optionsDescription;
@@ -89,8 +103,8 @@ bool AnalysisCommon::ApplyCommonFilters() const {
 double AnalysisCommon::DPhiPtMiss(
     const std::initializer_list<CollectionBuilderBase const *> &builders) {
 
-  TLorentzVector const &p4Miss = ptMissBuilder_.Get().p4;
-  TLorentzVector p4LeptonsJets(0, 0, 0, 0);
+  FourMomentum const &p4Miss = ptMissBuilder_.Get().p4;
+  FourMomentum p4LeptonsJets(0, 0, 0, 0);
 
   for (const auto &builder : builders) {
     for (const auto &p: builder->GetMomenta()) {
@@ -101,10 +115,10 @@ double AnalysisCommon::DPhiPtMiss(
   return std::abs(TVector2::Phi_mpi_pi(p4LeptonsJets.Phi() - p4Miss.Phi()));
 }
 
-double AnalysisCommon::DPhiPtMiss2(const TLorentzVector &p4Miss,
+double AnalysisCommon::DPhiPtMiss2(const FourMomentum &p4Miss,
     const std::initializer_list<CollectionBuilderBase const *> &builders) {
 
-  TLorentzVector p4LeptonsJets(0, 0, 0, 0);
+  FourMomentum p4LeptonsJets(0, 0, 0, 0);
 
   for (const auto &builder : builders) {
     for (const auto &p: builder->GetMomenta()) {
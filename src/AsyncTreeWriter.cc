@@ -0,0 +1,213 @@
+#include <AsyncTreeWriter.h>
+
+#include <cstring>
+
+#include <TLeaf.h>
+#include <TLeafI.h>
+#include <TObjArray.h>
+
+#include <HZZException.h>
+#include <Logger.h>
+
+
+namespace {
+
+/// Reads the number of elements from the buffer of a counter branch
+int ReadCount(char const *buffer) {
+  Int_t count;
+  std::memcpy(&count, buffer, sizeof(count));
+  return (count > 0) ? count : 0;
+}
+
+}  // anonymous namespace
+
+
+AsyncTreeWriter::AsyncTreeWriter(
+    std::vector<TTree *> const &trees, int queueSize)
+    : trees_{trees}, setUp_{false}, queue_(queueSize),
+      head_{0}, tail_{0}, producerWaiting_{false}, consumerWaiting_{false},
+      finishing_{false} {}
+
+
+AsyncTreeWriter::~AsyncTreeWriter() noexcept {
+  try {
+    Finish();
+  } catch (std::exception const &e) {
+    LOG_ERROR << "Error while writing trees: " << e.what();
+  }
+}
+
+
+void AsyncTreeWriter::Fill(int treeIndex) {
+  if (not setUp_)
+    Setup();
+
+  uint64_t const head = head_.load(std::memory_order_relaxed);
+
+  if (head - tail_.load() == queue_.size()) {
+    std::unique_lock<std::mutex> lock{mutex_};
+    producerWaiting_ = true;
+    wakeUp_.wait(lock, [this, head]{return head - tail_ < queue_.size();});
+    producerWaiting_ = false;
+  }
+
+  Row &row = queue_[head % queue_.size()];
+  row.treeIndex = treeIndex;
+  row.data.clear();
+  auto const &branches = branches_[treeIndex];
+
+  for (auto const &branch : branches) {
+    int numElements = branch.numElements;
+    if (branch.countIndex >= 0)
+      numElements *= ReadCount(branches[branch.countIndex].source);
+    row.data.insert(row.data.end(), branch.source,
+                    branch.source + numElements * branch.elementSize);
+  }
+
+  head_ = head + 1;
+
+  // Taking the lock makes sure that the consumer is either not about to sleep
+  // or already sleeping and will receive the notification
+  if (consumerWaiting_) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    wakeUp_.notify_all();
+  }
+}
+
+
+void AsyncTreeWriter::Finish() {
+  if (not writer_.joinable())
+    return;
+
+  finishing_ = true;
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    wakeUp_.notify_all();
+  }
+
+  writer_.join();
+  LOG_DEBUG << "Writer thread has filled " << tail_ << " entries.";
+
+  if (error_)
+    std::rethrow_exception(error_);
+}
+
+
+void AsyncTreeWriter::Setup() {
+  for (auto *tree : trees_) {
+    auto &branches = branches_.emplace_back();
+    TObjArray const *listOfBranches = tree->GetListOfBranches();
+
+    for (int i = 0; i < listOfBranches->GetEntries(); ++i) {
+      auto *tBranch = static_cast<TBranch *>(listOfBranches->At(i));
+      TObjArray const *leaves = tBranch->GetListOfLeaves();
+
+      if (tBranch->IsA() != TBranch::Class() or leaves->GetEntries() != 1) {
+        HZZException exception;
+        exception << "Branch \"" << tBranch->GetName() << "\" in tree \""
+            << tree->GetName() << "\" cannot be filled asynchronously.";
+        throw exception;
+      }
+
+      auto const *leaf = static_cast<TLeaf const *>(leaves->At(0));
+      Branch &branch = branches.emplace_back();
+      branch.branch = tBranch;
+      branch.source = tBranch->GetAddress();
+      branch.elementSize = leaf->GetLenType();
+      branch.numElements = leaf->GetLenStatic();
+      branch.countIndex = -1;
+
+      if (TLeaf const *count = leaf->GetLeafCount()) {
+        for (int j = 0; j < int(branches.size()) - 1; ++j)
+          if (branches[j].branch == count->GetBranch())
+            branch.countIndex = j;
+
+        if (branch.countIndex < 0 or count->IsA() != TLeafI::Class()) {
+          HZZException exception;
+          exception << "Counter for branch \"" << tBranch->GetName()
+              << "\" in tree \"" << tree->GetName()
+              << "\" is not supported for asynchronous filling.";
+          throw exception;
+        }
+      }
+
+      // Variable-size buffers are resized in the writer thread as needed
+      if (branch.countIndex < 0)
+        branch.buffer.resize(branch.numElements * branch.elementSize);
+      else
+        branch.buffer.resize(branch.elementSize);
+
+      tBranch->SetAddress(branch.buffer.data());
+    }
+  }
+
+  setUp_ = true;
+  writer_ = std::thread{&AsyncTreeWriter::WriterLoop, this};
+  LOG_DEBUG << "Started writer thread for " << trees_.size() << " tree(s).";
+}
+
+
+void AsyncTreeWriter::WriterLoop() {
+  while (true) {
+    uint64_t const tail = tail_.load(std::memory_order_relaxed);
+
+    if (tail == head_) {
+      if (finishing_) {
+        // The producer might have added a row before setting the flag
+        if (tail == head_)
+          return;
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock{mutex_};
+      consumerWaiting_ = true;
+      wakeUp_.wait(lock, [this, tail]{return tail != head_ or finishing_;});
+      consumerWaiting_ = false;
+      continue;
+    }
+
+    // After an error, rows are discarded so that the producer never blocks
+    if (not error_) {
+      try {
+        Row const &row = queue_[tail % queue_.size()];
+        auto &branches = branches_[row.treeIndex];
+        char const *data = row.data.data();
+
+        for (auto &branch : branches) {
+          int numElements = branch.numElements;
+
+          if (branch.countIndex >= 0) {
+            numElements *= ReadCount(branches[branch.countIndex].buffer.data());
+            std::size_t const size = numElements * branch.elementSize;
+
+            if (branch.buffer.size() < size) {
+              branch.buffer.resize(size);
+              branch.branch->SetAddress(branch.buffer.data());
+            }
+          }
+
+          std::size_t const size = numElements * branch.elementSize;
+          std::memcpy(branch.buffer.data(), data, size);
+          data += size;
+        }
+
+        if (trees_[row.treeIndex]->Fill() < 0) {
+          HZZException exception;
+          exception << "Failed to fill tree \""
+              << trees_[row.treeIndex]->GetName() << "\".";
+          throw exception;
+        }
+      } catch (...) {
+        error_ = std::current_exception();
+      }
+    }
+
+    tail_ = tail + 1;
+
+    if (producerWaiting_) {
+      std::lock_guard<std::mutex> lock{mutex_};
+      wakeUp_.notify_all();
+    }
+  }
+}
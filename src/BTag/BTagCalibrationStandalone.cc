@@ -1,8 +1,10 @@
 #include "BTagCalibrationStandalone.h"
+#include "FormulaEvaluator.h"
 #include <iostream>
 #include <exception>
 #include <algorithm>
 #include <sstream>
+#include <stdexcept>
 
 
 BTagEntry::Parameters::Parameters(
@@ -378,7 +380,23 @@ public:
     float ptMax;
     float discrMin;
     float discrMax;
-    TF1 func;
+    // compiled formula; if the formula is not supported by FormulaEvaluator,
+    // the TF1 is used instead
+    std::shared_ptr<FormulaEvaluator> compiledFunc;
+    std::shared_ptr<TF1> func;
+  };
+
+  // Cells along each axis are delimited by all bin edges found in the
+  // entries, so that within a cell every comparison with the edges, and thus
+  // the result of the linear searches, is the same.
+  struct FlavorIndex {
+    std::vector<float> etaEdges;    // eta bins are closed: 2n+1 cells
+    std::vector<float> ptEdges;     // pt bins are (min, max]: n+1 cells
+    std::vector<float> discrEdges;  // discr bins are [min, max): n+1 cells,
+                                    // only used for OP_RESHAPING
+    std::vector<int> entries;       // [(etaCell*nPt+ptCell)*nDiscr+discrCell]
+    std::vector<std::pair<float, float> > ptBounds;   // [etaCell*nDiscr+discrCell]
+    std::vector<std::pair<float, float> > etaBounds;  // [discrCell]
   };
 
 private:
@@ -401,6 +419,34 @@ private:
                           float pt,
                           float discr) const;
 
+  double eval_auto_bounds(SysVariation sys,
+                          BTagEntry::JetFlavor jf,
+                          float eta,
+                          float pt,
+                          float discr) const;
+
+  std::array<double, 3> eval_auto_bounds_all(BTagEntry::JetFlavor jf,
+                                             float eta,
+                                             float pt,
+                                             float discr) const;
+
+  // common implementation for the above; sysReader is nullptr if the
+  // requested systematic has not been loaded
+  double eval_auto_bounds(const BTagCalibrationReaderImpl * sysReader,
+                          const std::string & sys,
+                          BTagEntry::JetFlavor jf,
+                          float eta,
+                          float pt,
+                          float discr) const;
+
+  // eta (made absolute if needed), pt_for_eval, and whether pt is out of
+  // bounds; returns false if eta is out of bounds
+  bool auto_bounds(BTagEntry::JetFlavor jf,
+                   float & eta,
+                   float & pt,
+                   float discr,
+                   bool & is_out_of_bounds) const;
+
   std::pair<float, float> min_max_pt(BTagEntry::JetFlavor jf,
                                      float eta,
                                      float discr) const;
@@ -408,14 +454,92 @@ private:
   std::pair<float, float> min_max_eta(BTagEntry::JetFlavor jf,
                                      float discr) const;
 
+  // linear searches through all entries, used to build the index
+  int find_entry_linear(BTagEntry::JetFlavor jf,
+                        float eta,
+                        float pt,
+                        float discr) const;
+
+  std::pair<float, float> min_max_pt_linear(BTagEntry::JetFlavor jf,
+                                            float eta,
+                                            float discr) const;
+
+  std::pair<float, float> min_max_eta_linear(BTagEntry::JetFlavor jf,
+                                             float discr) const;
+
+  void build_index(BTagEntry::JetFlavor jf);
+
+  unsigned discr_cell(const FlavorIndex & index, float discr) const;
+
   BTagEntry::OperatingPoint op_;
   std::string sysType_;
   std::vector<std::vector<TmpEntry> > tmpData_;  // first index: jetFlavor
   std::vector<bool> useAbsEta_;                  // first index: jetFlavor
+  std::vector<FlavorIndex> index_;               // first index: jetFlavor
   std::map<std::string, std::shared_ptr<BTagCalibrationReaderImpl>> otherSysTypeReaders_;
+  std::array<const BTagCalibrationReaderImpl *, 3> sysReaders_;  // index: SysVariation
 };
 
 
+namespace {
+
+// Cell along an eta axis with closed bins. Even cells are open intervals
+// between edges, odd cells are the edges themselves.
+unsigned etaCell(const std::vector<float> & edges, float eta)
+{
+  unsigned k = std::lower_bound(edges.begin(), edges.end(), eta) - edges.begin();
+  if (k < edges.size() && edges[k] == eta) {
+    return 2*k + 1;
+  }
+  return 2*k;
+}
+
+// Cell k is (edges[k-1], edges[k]]
+unsigned ptCell(const std::vector<float> & edges, float pt)
+{
+  return std::lower_bound(edges.begin(), edges.end(), pt) - edges.begin();
+}
+
+// Cell k is [edges[k-1], edges[k])
+unsigned discrCell(const std::vector<float> & edges, float discr)
+{
+  return std::upper_bound(edges.begin(), edges.end(), discr) - edges.begin();
+}
+
+// A value inside the interval cell k, which lies between edges[k-1] and
+// edges[k]
+float intervalValue(const std::vector<float> & edges, unsigned k)
+{
+  if (edges.empty()) {
+    return 0.;
+  }
+  if (k == 0) {
+    return edges.front() - 1.;
+  }
+  if (k == edges.size()) {
+    return edges.back() + 1.;
+  }
+  return 0.5 * (edges[k-1] + edges[k]);
+}
+
+float etaCellValue(const std::vector<float> & edges, unsigned cell)
+{
+  if (cell % 2 == 1) {
+    return edges[cell / 2];
+  }
+  return intervalValue(edges, cell / 2);
+}
+
+std::vector<float> sortedEdges(std::vector<float> edges)
+{
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  return edges;
+}
+
+}  // anonymous namespace
+
+
 BTagCalibrationReader::BTagCalibrationReaderImpl::BTagCalibrationReaderImpl(
                                              BTagEntry::OperatingPoint op,
                                              const std::string & sysType,
@@ -423,7 +547,9 @@ BTagCalibrationReader::BTagCalibrationReaderImpl::BTagCalibrationReaderImpl(
   op_(op),
   sysType_(sysType),
   tmpData_(3),
-  useAbsEta_(3, true)
+  useAbsEta_(3, true),
+  index_(3),
+  sysReaders_{{this, nullptr, nullptr}}
 {
   for (const std::string & ost : otherSysTypes) {
     if (otherSysTypeReaders_.count(ost)) {
@@ -436,6 +562,17 @@ throw std::exception();
         new BTagCalibrationReaderImpl(op, ost)
     );
   }
+
+  if (otherSysTypeReaders_.count("up")) {
+    sysReaders_[SYS_UP] = otherSysTypeReaders_.at("up").get();
+  }
+  if (otherSysTypeReaders_.count("down")) {
+    sysReaders_[SYS_DOWN] = otherSysTypeReaders_.at("down").get();
+  }
+
+  for (unsigned jf = 0; jf < index_.size(); ++jf) {
+    build_index(BTagEntry::JetFlavor(jf));
+  }
 }
 
 void BTagCalibrationReader::BTagCalibrationReaderImpl::load(
@@ -466,12 +603,17 @@ throw std::exception();
     te.discrMin = be.params.discrMin;
     te.discrMax = be.params.discrMax;
 
-    if (op_ == BTagEntry::OP_RESHAPING) {
-      te.func = TF1("", be.formula.c_str(),
-                    be.params.discrMin, be.params.discrMax);
-    } else {
-      te.func = TF1("", be.formula.c_str(),
-                    be.params.ptMin, be.params.ptMax);
+    try {
+      te.compiledFunc = std::make_shared<FormulaEvaluator>(be.formula);
+    } catch (std::runtime_error const &) {
+      // e.g. the ternary operator in formulas made from histograms
+      if (op_ == BTagEntry::OP_RESHAPING) {
+        te.func = std::make_shared<TF1>("", be.formula.c_str(),
+                                        be.params.discrMin, be.params.discrMax);
+      } else {
+        te.func = std::make_shared<TF1>("", be.formula.c_str(),
+                                        be.params.ptMin, be.params.ptMax);
+      }
     }
 
     tmpData_[be.params.jetFlavor].push_back(te);
@@ -480,11 +622,68 @@ throw std::exception();
     }
   }
 
+  build_index(jf);
+
   for (auto & p : otherSysTypeReaders_) {
     p.second->load(c, jf, measurementType);
   }
 }
 
+void BTagCalibrationReader::BTagCalibrationReaderImpl::build_index(
+                                             BTagEntry::JetFlavor jf)
+{
+  bool use_discr = (op_ == BTagEntry::OP_RESHAPING);
+  const auto &entries = tmpData_.at(jf);
+  FlavorIndex &index = index_.at(jf);
+
+  std::vector<float> etaEdges, ptEdges, discrEdges;
+  for (const auto &e : entries) {
+    etaEdges.push_back(e.etaMin);
+    etaEdges.push_back(e.etaMax);
+    ptEdges.push_back(e.ptMin);
+    ptEdges.push_back(e.ptMax);
+    if (use_discr) {
+      discrEdges.push_back(e.discrMin);
+      discrEdges.push_back(e.discrMax);
+    }
+  }
+  index.etaEdges = sortedEdges(etaEdges);
+  index.ptEdges = sortedEdges(ptEdges);
+  index.discrEdges = sortedEdges(discrEdges);
+
+  unsigned nEta = 2*index.etaEdges.size() + 1;
+  unsigned nPt = index.ptEdges.size() + 1;
+  unsigned nDiscr = index.discrEdges.size() + 1;
+
+  // The linear searches are run once for a value inside each cell
+  index.entries.assign(nEta * nPt * nDiscr, -1);
+  index.ptBounds.assign(nEta * nDiscr, std::make_pair(-1.f, -1.f));
+  index.etaBounds.assign(nDiscr, std::make_pair(0.f, 0.f));
+  for (unsigned iDiscr = 0; iDiscr < nDiscr; ++iDiscr) {
+    float discr = intervalValue(index.discrEdges, iDiscr);
+    index.etaBounds[iDiscr] = min_max_eta_linear(jf, discr);
+    for (unsigned iEta = 0; iEta < nEta; ++iEta) {
+      float eta = etaCellValue(index.etaEdges, iEta);
+      index.ptBounds[iEta*nDiscr + iDiscr] = min_max_pt_linear(jf, eta, discr);
+      for (unsigned iPt = 0; iPt < nPt; ++iPt) {
+        float pt = intervalValue(index.ptEdges, iPt);
+        index.entries[(iEta*nPt + iPt)*nDiscr + iDiscr] =
+          find_entry_linear(jf, eta, pt, discr);
+      }
+    }
+  }
+}
+
+unsigned BTagCalibrationReader::BTagCalibrationReaderImpl::discr_cell(
+                                             const FlavorIndex & index,
+                                             float discr) const
+{
+  if (index.discrEdges.empty()) {
+    return 0;
+  }
+  return discrCell(index.discrEdges, discr);
+}
+
 double BTagCalibrationReader::BTagCalibrationReaderImpl::eval(
                                              BTagEntry::JetFlavor jf,
                                              float eta,
@@ -496,8 +695,33 @@ double BTagCalibrationReader::BTagCalibrationReaderImpl::eval(
     eta = -eta;
   }
 
-  // search linearly through eta, pt and discr ranges and eval
-  // future: find some clever data structure based on intervals
+  const FlavorIndex &index = index_[jf];
+  unsigned nPt = index.ptEdges.size() + 1;
+  unsigned nDiscr = index.discrEdges.size() + 1;
+  int i = index.entries[
+    (etaCell(index.etaEdges, eta)*nPt + ptCell(index.ptEdges, pt))*nDiscr
+    + discr_cell(index, discr)];
+  if (i < 0) {
+    return 0.;  // default value
+  }
+
+  const auto &e = tmpData_[jf][i];
+  double x = (use_discr) ? discr : pt;
+  if (e.compiledFunc) {
+    return e.compiledFunc->evaluate(&x, nullptr);
+  }
+  return e.func->Eval(x);
+}
+
+int BTagCalibrationReader::BTagCalibrationReaderImpl::find_entry_linear(
+                                             BTagEntry::JetFlavor jf,
+                                             float eta,
+                                             float pt,
+                                             float discr) const
+{
+  bool use_discr = (op_ == BTagEntry::OP_RESHAPING);
+
+  // search linearly through eta, pt and discr ranges
   const auto &entries = tmpData_.at(jf);
   for (unsigned i=0; i<entries.size(); ++i) {
     const auto &e = entries.at(i);
@@ -507,23 +731,23 @@ double BTagCalibrationReader::BTagCalibrationReaderImpl::eval(
     ){
       if (use_discr) {                                    // discr. reshaping?
         if (e.discrMin <= discr && discr < e.discrMax) {  // check discr
-          return e.func.Eval(discr);
+          return i;
         }
       } else {
-        return e.func.Eval(pt);
+        return i;
       }
     }
   }
 
-  return 0.;  // default value
+  return -1;
 }
 
-double BTagCalibrationReader::BTagCalibrationReaderImpl::eval_auto_bounds(
-                                             const std::string & sys,
+bool BTagCalibrationReader::BTagCalibrationReaderImpl::auto_bounds(
                                              BTagEntry::JetFlavor jf,
-                                             float eta,
-                                             float pt,
-                                             float discr) const
+                                             float & eta,
+                                             float & pt,
+                                             float discr,
+                                             bool & is_out_of_bounds) const
 {
   auto sf_bounds_eta = min_max_eta(jf, discr);
   bool eta_is_out_of_bounds = false;
@@ -539,36 +763,79 @@ double BTagCalibrationReader::BTagCalibrationReaderImpl::eval_auto_bounds(
   }
    
   if (eta_is_out_of_bounds) {
-    return 1.;
+    return false;
   }
 
 
    auto sf_bounds = min_max_pt(jf, eta, discr);
-   float pt_for_eval = pt;
-   bool is_out_of_bounds = false;
+   is_out_of_bounds = false;
 
    if (pt <= sf_bounds.first) {
-    pt_for_eval = sf_bounds.first + .0001;
+    pt = sf_bounds.first + .0001;
     is_out_of_bounds = true;
   } else if (pt > sf_bounds.second) {
-    pt_for_eval = sf_bounds.second - .0001;
+    pt = sf_bounds.second - .0001;
     is_out_of_bounds = true;
   }
 
+  return true;
+}
+
+double BTagCalibrationReader::BTagCalibrationReaderImpl::eval_auto_bounds(
+                                             const std::string & sys,
+                                             BTagEntry::JetFlavor jf,
+                                             float eta,
+                                             float pt,
+                                             float discr) const
+{
+  const BTagCalibrationReaderImpl * sysReader = nullptr;
+  if (sys == sysType_) {
+    sysReader = this;
+  } else if (otherSysTypeReaders_.count(sys)) {
+    sysReader = otherSysTypeReaders_.at(sys).get();
+  }
+  return eval_auto_bounds(sysReader, sys, jf, eta, pt, discr);
+}
+
+double BTagCalibrationReader::BTagCalibrationReaderImpl::eval_auto_bounds(
+                                             SysVariation sys,
+                                             BTagEntry::JetFlavor jf,
+                                             float eta,
+                                             float pt,
+                                             float discr) const
+{
+  static const char * const names[] = {"central", "up", "down"};
+  return eval_auto_bounds(sysReaders_[sys], names[sys], jf, eta, pt, discr);
+}
+
+double BTagCalibrationReader::BTagCalibrationReaderImpl::eval_auto_bounds(
+                                             const BTagCalibrationReaderImpl * sysReader,
+                                             const std::string & sys,
+                                             BTagEntry::JetFlavor jf,
+                                             float eta,
+                                             float pt,
+                                             float discr) const
+{
+  float pt_for_eval = pt;
+  bool is_out_of_bounds = false;
+  if (!auto_bounds(jf, eta, pt_for_eval, discr, is_out_of_bounds)) {
+    return 1.;
+  }
+
   // get central SF (and maybe return)
   double sf = eval(jf, eta, pt_for_eval, discr);
-  if (sys == sysType_) {
+  if (sysReader == this) {
     return sf;
   }
 
   // get sys SF (and maybe return)
-  if (!otherSysTypeReaders_.count(sys)) {
+  if (!sysReader) {
 std::cerr << "ERROR in BTagCalibration: "
         << "sysType not available (maybe not loaded?): "
         << sys;
 throw std::exception();
   }
-  double sf_err = otherSysTypeReaders_.at(sys)->eval(jf, eta, pt_for_eval, discr);
+  double sf_err = sysReader->eval(jf, eta, pt_for_eval, discr);
   if (!is_out_of_bounds) {
     return sf_err;
   }
@@ -578,16 +845,66 @@ throw std::exception();
   return sf_err;
 }
 
+std::array<double, 3> BTagCalibrationReader::BTagCalibrationReaderImpl::eval_auto_bounds_all(
+                                             BTagEntry::JetFlavor jf,
+                                             float eta,
+                                             float pt,
+                                             float discr) const
+{
+  if (!sysReaders_[SYS_UP] || !sysReaders_[SYS_DOWN]) {
+std::cerr << "ERROR in BTagCalibration: "
+        << "sysTypes up and down must be loaded to evaluate all variations";
+throw std::exception();
+  }
+
+  float pt_for_eval = pt;
+  bool is_out_of_bounds = false;
+  if (!auto_bounds(jf, eta, pt_for_eval, discr, is_out_of_bounds)) {
+    return {{1., 1., 1.}};
+  }
+
+  std::array<double, 3> sfs;
+  double sf = eval(jf, eta, pt_for_eval, discr);
+  sfs[SYS_CENTRAL] = sf;
+  for (int sys : {SYS_UP, SYS_DOWN}) {
+    double sf_err = sysReaders_[sys]->eval(jf, eta, pt_for_eval, discr);
+    // double uncertainty on out-of-bounds
+    sfs[sys] = (is_out_of_bounds) ? sf + 2*(sf_err - sf) : sf_err;
+  }
+  return sfs;
+}
+
 std::pair<float, float> BTagCalibrationReader::BTagCalibrationReaderImpl::min_max_pt(
                                                BTagEntry::JetFlavor jf,
                                                float eta,
                                                float discr) const
 {
-  bool use_discr = (op_ == BTagEntry::OP_RESHAPING);
   if (useAbsEta_[jf] && eta < 0) {
     eta = -eta;
   }
 
+  const FlavorIndex &index = index_[jf];
+  unsigned nDiscr = index.discrEdges.size() + 1;
+  return index.ptBounds[etaCell(index.etaEdges, eta)*nDiscr
+                        + discr_cell(index, discr)];
+}
+
+std::pair<float, float> BTagCalibrationReader::BTagCalibrationReaderImpl::min_max_eta(
+                                               BTagEntry::JetFlavor jf,
+                                               float discr) const
+{
+  const FlavorIndex &index = index_[jf];
+  return index.etaBounds[discr_cell(index, discr)];
+}
+
+std::pair<float, float> BTagCalibrationReader::BTagCalibrationReaderImpl::min_max_pt_linear(
+                                               BTagEntry::JetFlavor jf,
+                                               float eta,
+                                               float discr) const
+{
+  // eta is already made absolute if needed
+  bool use_discr = (op_ == BTagEntry::OP_RESHAPING);
+
   const auto &entries = tmpData_.at(jf);
   float min_pt = -1., max_pt = -1.;
   for (const auto & e: entries) {
@@ -615,7 +932,7 @@ std::pair<float, float> BTagCalibrationReader::BTagCalibrationReaderImpl::min_ma
   return std::make_pair(min_pt, max_pt);
 }
 
-std::pair<float, float> BTagCalibrationReader::BTagCalibrationReaderImpl::min_max_eta(
+std::pair<float, float> BTagCalibrationReader::BTagCalibrationReaderImpl::min_max_eta_linear(
                                                BTagEntry::JetFlavor jf,
                                                float discr) const
 {
@@ -670,13 +987,26 @@ double BTagCalibrationReader::eval_auto_bounds(const std::string & sys,
   return pimpl->eval_auto_bounds(sys, jf, eta, pt, discr);
 }
 
+double BTagCalibrationReader::eval_auto_bounds(SysVariation sys,
+                                               BTagEntry::JetFlavor jf,
+                                               float eta,
+                                               float pt,
+                                               float discr) const
+{
+  return pimpl->eval_auto_bounds(sys, jf, eta, pt, discr);
+}
+
+std::array<double, 3> BTagCalibrationReader::eval_auto_bounds_all(BTagEntry::JetFlavor jf,
+                                                                  float eta,
+                                                                  float pt,
+                                                                  float discr) const
+{
+  return pimpl->eval_auto_bounds_all(jf, eta, pt, discr);
+}
+
 std::pair<float, float> BTagCalibrationReader::min_max_pt(BTagEntry::JetFlavor jf,
                                                           float eta,
                                                           float discr) const
 {
   return pimpl->min_max_pt(jf, eta, discr);
 }
-
-
-
-
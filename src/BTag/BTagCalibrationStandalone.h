@@ -141,10 +141,17 @@ protected:
  * BTagCalibrationReader
  *
  * Helper class to pull out a specific set of BTagEntry's out of a
- * BTagCalibration. TF1 functions are set up at initialization time.
+ * BTagCalibration. Formulas are compiled at initialization time. For each jet
+ * flavor, an index of the cells in (eta, pt, discr) is built, so that the
+ * entry and the pt and eta bounds are found without scanning all entries.
+ *
+ * Systematic variations "up" and "down", if given in otherSysTypes, can also
+ * be accessed with enum SysVariation, and eval_auto_bounds_all returns the
+ * central, up, and down scale factors at once.
  *
  ************************************************************/
 
+#include <array>
 #include <memory>
 #include <string>
 
@@ -155,6 +162,12 @@ class BTagCalibrationReader
 public:
   class BTagCalibrationReaderImpl;
 
+  enum SysVariation {
+    SYS_CENTRAL=0,
+    SYS_UP=1,
+    SYS_DOWN=2,
+  };
+
   BTagCalibrationReader() {}
   BTagCalibrationReader(BTagEntry::OperatingPoint op,
                         const std::string & sysType="central",
@@ -175,6 +188,18 @@ public:
                           float pt,
                           float discr=0.) const;
 
+  double eval_auto_bounds(SysVariation sys,
+                          BTagEntry::JetFlavor jf,
+                          float eta,
+                          float pt,
+                          float discr=0.) const;
+
+  // indexed with SysVariation
+  std::array<double, 3> eval_auto_bounds_all(BTagEntry::JetFlavor jf,
+                                             float eta,
+                                             float pt,
+                                             float discr=0.) const;
+
   std::pair<float, float> min_max_pt(BTagEntry::JetFlavor jf,
                                      float eta,
                                      float discr=0.) const;
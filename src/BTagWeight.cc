@@ -6,6 +6,7 @@
 #include <cstdlib>
 
 #include <TFile.h>
+#include <TH2.h>
 
 #include "BTag/BTagCalibrationStandalone.h"
 
@@ -24,7 +25,9 @@ BTagWeight::BTagWeight(Dataset &dataset, Options const &options,
       scaleFactorReader_{new BTagCalibrationReader{
         // BTagEntry::OP_LOOSE, "central", {"up", "down"}}},
         BTagEntry::OP_MEDIUM, "central", {"up", "down"}}},
-      cache_{dataset.Reader()} {
+      node_{dataset.Graph(), "BTagWeight", [this]{Update();},
+            &jetBuilder->GetShapeSyst()} {
+  node_.AddInput(jetBuilder->GetNode());
 
   std::string const scaleFactorsPath{FileInPath::Resolve(
     Options::NodeAs<std::string>(
@@ -84,48 +87,21 @@ std::string_view BTagWeight::VariationName(int variation) const {
 }
 
 
-double BTagWeight::ComputeWeight(Variation variation) const {
-  double weight = 1.;
-
-  for (auto const &jet : jetBuilder_->Get()) {
-    if (not bTagger_->IsTaggable(jet))
-      continue;
-
-    double const sf = GetScaleFactor(
-      jet.p4.Pt(), jet.p4.Eta(), jet.hadronFlavour, variation);
-
-    if ((*bTagger_)(jet)) {
-      weight *= sf;
-    } else {
-      double const eff = GetEfficiency(
-          jet.p4.Pt(), jet.p4.Eta(), jet.hadronFlavour);
-      weight *= (1 - sf * eff) / (1 - eff);
-    }
-  }
-
-  return weight;
-}
-
-
-double BTagWeight::GetEfficiency(double pt, double eta, int flavour) const {
-
-  std::string flavourLabel;
-  eta = std::fabs(eta);
-
-  switch (std::abs(flavour)) {
+BTagWeight::Flavour BTagWeight::TranslateFlavour(int hadronFlavour) {
+  switch (std::abs(hadronFlavour)) {
     case 5:
-      flavourLabel = "b";
-      break;
-
+      return Flavour::kBottom;
     case 4:
-      flavourLabel = "c";
-      break;
-
+      return Flavour::kCharm;
     default:
-      flavourLabel = "udsg";
+      return Flavour::kLight;
   }
-  int const globalBin = effTables_.at(flavourLabel)->FindFixBin(pt, eta);
-  return effTables_.at(flavourLabel)->GetBinContent(globalBin);
+}
+
+
+double BTagWeight::GetEfficiency(double pt, double eta,
+                                 Flavour flavour) const {
+  return effTables_[int(flavour)](pt, std::fabs(eta));
 }
 
 
@@ -139,62 +115,67 @@ void BTagWeight::LoadEffTables() {
     throw exception;
   }
 
-  for(std::string const &flavor : {"b", "c", "udsg"}) { 
-    if (flavor == "b"){
-      effTables_[flavor].reset(inputFile.Get<TH2>(bottomHistName_.c_str()));
-    }
-    else if (flavor == "c")
-      effTables_[flavor].reset(inputFile.Get<TH2>(charmHistName_.c_str()));
-    else if (flavor == "udsg")
-      effTables_[flavor].reset(inputFile.Get<TH2>(lightHistName_.c_str()));
-    
-    if (not effTables_[flavor]) {
+  std::array<std::string const *, 3> const histNames{
+      &bottomHistName_, &charmHistName_, &lightHistName_};
+
+  for (int flavour = 0; flavour < int(effTables_.size()); ++flavour) {
+    std::unique_ptr<TH2> hist{inputFile.Get<TH2>(histNames[flavour]->c_str())};
+
+    if (not hist) {
       HZZException exception;
       exception << "File " << effTablesPath_ <<
-        " does not contain required histogram \"" << flavor << "\".";
+        " does not contain required histogram \"" << *histNames[flavour]
+        << "\".";
       throw exception;
     }
-    
-    effTables_[flavor]->SetDirectory(nullptr);
+
+    hist->SetDirectory(nullptr);
+    effTables_[flavour] = BinnedTable2D{*hist};
   }
   inputFile.Close();
 }
 
 
-double BTagWeight::GetScaleFactor(double pt, double eta, int flavour,
-                                  Variation variation) const {
-  BTagEntry::JetFlavor translatedFlavour;
-  switch (std::abs(flavour)) {
-    case 5:
-      translatedFlavour = BTagEntry::FLAV_B;
-      break;
-    case 4:
-      translatedFlavour = BTagEntry::FLAV_C;
-      break;
-    default:
-      translatedFlavour = BTagEntry::FLAV_UDSG;
-  }
-
-  std::string version{"central"};
-  if (translatedFlavour != BTagEntry::FLAV_UDSG) {
-    if (variation == Variation::kTagUp)
-      version = "up";
-    else if (variation == Variation::kTagDown)
-      version = "down";
-  } else {
-    if (variation == Variation::kMistagUp)
-      version = "up";
-    else if (variation == Variation::kMistagDown)
-      version = "down";
-  }
-
-  return scaleFactorReader_->eval_auto_bounds(
-    version, translatedFlavour, eta, pt);
+std::array<double, 3> BTagWeight::GetScaleFactors(
+    double pt, double eta, Flavour flavour) const {
+  return scaleFactorReader_->eval_auto_bounds_all(
+    BTagEntry::JetFlavor(flavour), eta, pt);
 }
 
 
 void BTagWeight::Update() const {
-  for (int i = 0; i < int(weights_.size()); ++i)
-    weights_[i] = ComputeWeight(Variation(i));
-}
+  weights_.fill(1.);
+
+  // All variations are computed in a single loop over jets. For each jet, the
+  // scale factors for every variation in the reader are evaluated together,
+  // and the efficiency is only looked up when needed.
+  for (auto const &jet : jetBuilder_->Get()) {
+    if (not bTagger_->IsTaggable(jet))
+      continue;
+
+    double const pt = jet.p4.Pt(), eta = jet.p4.Eta();
+    Flavour const flavour = TranslateFlavour(jet.hadronFlavour);
+    auto const sfs = GetScaleFactors(pt, eta, flavour);
+
+    // Variations in the tagging of heavy-flavour jets only affect the b and c
+    // jets, while variations in the mistagging only affect the light ones
+    std::array<int, 5> sfIndices;
+    sfIndices.fill(BTagCalibrationReader::SYS_CENTRAL);
+    if (flavour != Flavour::kLight) {
+      sfIndices[int(Variation::kTagUp)] = BTagCalibrationReader::SYS_UP;
+      sfIndices[int(Variation::kTagDown)] = BTagCalibrationReader::SYS_DOWN;
+    } else {
+      sfIndices[int(Variation::kMistagUp)] = BTagCalibrationReader::SYS_UP;
+      sfIndices[int(Variation::kMistagDown)] = BTagCalibrationReader::SYS_DOWN;
+    }
 
+    if ((*bTagger_)(jet)) {
+      for (int i = 0; i < int(weights_.size()); ++i)
+        weights_[i] *= sfs[sfIndices[i]];
+    } else {
+      double const eff = GetEfficiency(pt, eta, flavour);
+      for (int i = 0; i < int(weights_.size()); ++i)
+        weights_[i] *= (1 - sfs[sfIndices[i]] * eff) / (1 - eff);
+    }
+  }
+}
@@ -0,0 +1,82 @@
+#include <BinnedTable.h>
+
+#include <algorithm>
+
+
+BinnedAxis::BinnedAxis()
+    : numBins_{1}, min_{0.}, max_{1.}, uniform_{true}, edges_{0., 1.} {}
+
+
+BinnedAxis::BinnedAxis(TAxis const &axis)
+    : numBins_{axis.GetNbins()}, min_{axis.GetXmin()}, max_{axis.GetXmax()},
+      uniform_{axis.GetXbins()->GetSize() == 0} {
+  edges_.reserve(numBins_ + 1);
+  for (int bin = 1; bin <= numBins_ + 1; ++bin)
+    edges_.emplace_back(axis.GetBinLowEdge(bin));
+}
+
+
+BinnedAxis::BinnedAxis(std::vector<double> const &edges)
+    : numBins_{int(edges.size()) - 1}, min_{edges.front()}, max_{edges.back()},
+      edges_{edges} {
+  // Treat the binning as uniform only if the edges are exactly the same as
+  // would be computed by TAxis for a uniform binning
+  double const width = (max_ - min_) / numBins_;
+  uniform_ = true;
+  for (int i = 0; i < numBins_; ++i)
+    if (edges_[i] != min_ + i * width) {
+      uniform_ = false;
+      break;
+    }
+}
+
+
+int BinnedAxis::BinarySearch(double x) const {
+  // The value is known to be within [min_, max_). Same as
+  // TMath::BinarySearch, find the last edge that is not larger than x.
+  return std::upper_bound(edges_.begin(), edges_.end(), x) - edges_.begin();
+}
+
+
+BinnedTable1D::BinnedTable1D()
+    : values_(3, 0.f) {}
+
+
+BinnedTable1D::BinnedTable1D(TH1 const &hist)
+    : axis_{*hist.GetXaxis()} {
+  int const numBins = axis_.NumBins() + 2;
+  values_.reserve(numBins);
+  for (int bin = 0; bin < numBins; ++bin)
+    values_.emplace_back(hist.GetBinContent(bin));
+}
+
+
+void BinnedTable1D::Lookup(
+    std::size_t n, double const *x, double *values) const {
+  for (std::size_t i = 0; i < n; ++i)
+    values[i] = values_[axis_.FindBin(x[i])];
+}
+
+
+BinnedTable2D::BinnedTable2D()
+    : values_(9, 0.f) {}
+
+
+BinnedTable2D::BinnedTable2D(TH2 const &hist)
+    : xAxis_{*hist.GetXaxis()}, yAxis_{*hist.GetYaxis()} {
+  int const numBinsX = xAxis_.NumBins() + 2;
+  int const numBinsY = yAxis_.NumBins() + 2;
+  values_.reserve(numBinsX * numBinsY);
+
+  // The layout is the same as for global bin numbers in TH2
+  for (int binY = 0; binY < numBinsY; ++binY)
+    for (int binX = 0; binX < numBinsX; ++binX)
+      values_.emplace_back(hist.GetBinContent(binX, binY));
+}
+
+
+void BinnedTable2D::Lookup(
+    std::size_t n, double const *x, double const *y, double *values) const {
+  for (std::size_t i = 0; i < n; ++i)
+    values[i] = Value(xAxis_.FindBin(x[i]), yAxis_.FindBin(y[i]));
+}
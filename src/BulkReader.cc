@@ -0,0 +1,172 @@
+#include <BulkReader.h>
+
+#include <algorithm>
+
+#include <TFile.h>
+#include <TLeaf.h>
+#include <TMath.h>
+#include <TObjArray.h>
+
+#include <Dataset.h>
+#include <HZZException.h>
+#include <Logger.h>
+
+
+BulkColumnBase::BulkColumnBase(std::string const &branchName, EDataType type,
+                               bool optional)
+    : index_{0}, branchName_{branchName}, type_{type}, optional_{optional},
+      branch_{nullptr}, first_{0}, end_{0}, buffer_{TBuffer::kWrite, 10000} {}
+
+
+void BulkColumnBase::Attach(TTree *tree) {
+  branch_ = tree->GetBranch(branchName_.c_str());
+  first_ = end_ = 0;
+
+  if (not branch_) {
+    if (optional_)
+      return;
+
+    HZZException exception;
+    exception << "Branch \"" << branchName_ << "\" is not found in tree \""
+        << tree->GetName() << "\" in file \""
+        << tree->GetCurrentFile()->GetName() << "\".";
+    throw exception;
+  }
+
+  TObjArray const *leaves = branch_->GetListOfLeaves();
+  TLeaf const *leaf = (leaves->GetEntries() == 1) ?
+      static_cast<TLeaf const *>(leaves->At(0)) : nullptr;
+  std::string const typeName{TDataType::GetTypeName(type_)};
+
+  if (not leaf or leaf->GetLeafCount() or leaf->GetLenStatic() != 1
+      or typeName != leaf->GetTypeName()) {
+    HZZException exception;
+    exception << "Branch \"" << branchName_ << "\" does not contain a single "
+        "value of type " << typeName << " per entry.";
+    throw exception;
+  }
+
+  if (not branch_->GetBulkRead().SupportsBulkRead()) {
+    HZZException exception;
+    exception << "Branch \"" << branchName_ << "\" cannot be read in bulk.";
+    throw exception;
+  }
+}
+
+
+void BulkColumnBase::Load(int64_t entry) {
+  if (not branch_)
+    return;
+
+  if (entry < first_ or entry >= end_) {
+    // Find the basket that contains the entry and request the entries starting
+    // from its beginning, so that the returned values are aligned with it
+    Long64_t const *basketEntries = branch_->GetBasketEntry();
+    Long64_t const basket = TMath::BinarySearch(
+        Long64_t(branch_->GetWriteBasket()) + 1, basketEntries,
+        Long64_t(entry));
+    int64_t const first = basketEntries[basket];
+    int const count = branch_->GetBulkRead().GetEntriesSerialized(
+        first, buffer_);
+
+    if (count <= 0 or entry >= first + count) {
+      HZZException exception;
+      exception << "Failed to read entry " << entry << " of branch \""
+          << branchName_ << "\" in bulk.";
+      throw exception;
+    }
+
+    Decode(buffer_.GetCurrent(), count);
+    first_ = first;
+    end_ = first + count;
+  }
+
+  index_ = entry - first_;
+}
+
+
+BulkValueBase::BulkValueBase(Dataset &dataset, std::string const &branchName,
+                             EDataType type, bool optional,
+                             ColumnFactory factory)
+    : column_{dataset.Bulk().GetColumn(branchName, type, optional, factory)} {}
+
+
+BulkReader::BulkReader(TChain &chain)
+    : chain_{chain}, notify_{this}, attached_{false} {
+  // The TTreeReader of the dataset prepends its own link later, keeping this
+  // one in the list
+  notify_.PrependLink(chain_);
+}
+
+
+BulkReader::~BulkReader() noexcept {
+  notify_.RemoveLink(chain_);
+}
+
+
+std::vector<std::string> BulkReader::GetBranchNames() const {
+  std::vector<std::string> names;
+
+  for (auto const &column : columns_)
+    if (std::find(names.begin(), names.end(), column->GetBranchName())
+        == names.end())
+      names.emplace_back(column->GetBranchName());
+
+  return names;
+}
+
+
+bool BulkReader::Notify() {
+  // Branches of the previous tree might have been deleted already, so the
+  // columns are reattached before they are used again, even if the same tree
+  // has been loaded anew
+  attached_ = false;
+  return true;
+}
+
+
+void BulkReader::SetEntry(int64_t entry) {
+  int const treeIndex = chain_.GetTreeNumber();
+
+  if (treeIndex < 0)
+    return;
+
+  if (not attached_) {
+    LOG_TRACE << "Attaching " << columns_.size()
+        << " bulk columns to tree " << treeIndex << ".";
+
+    for (auto &column : columns_)
+      column->Attach(chain_.GetTree());
+
+    attached_ = true;
+  }
+
+  int64_t const localEntry = entry - chain_.GetTreeOffset()[treeIndex];
+
+  for (auto &column : columns_)
+    column->Load(localEntry);
+}
+
+
+BulkColumnBase *BulkReader::GetColumn(
+    std::string const &branchName, EDataType type, bool optional,
+    BulkValueBase::ColumnFactory factory) {
+  for (auto &column : columns_) {
+    if (column->branchName_ == branchName and column->type_ == type) {
+      if (not optional and column->optional_) {
+        column->optional_ = false;
+
+        // Check that the branch is present in the current tree
+        attached_ = false;
+      }
+
+      return column.get();
+    }
+  }
+
+  columns_.emplace_back(factory(branchName, optional));
+
+  // The new column needs to be attached to the current tree
+  attached_ = false;
+  return columns_.back().get();
+}
@@ -2,6 +2,7 @@
 
 #include <cmath>
 
+#include <HZZException.h>
 #include <Utils.h>
 
 
@@ -22,17 +23,67 @@ bool CollectionBuilderBase::MomentaWrapper::HasOverlap(
 
 void CollectionBuilderBase::EnableCleaning(
     std::initializer_list<CollectionBuilderBase const *> builders) {
-  for (auto *b : builders)
+  for (auto *b : builders) {
     prioritizedBuilders_.emplace_back(b);
+    node_.AddInput(b->node_);
+  }
+}
+
+
+DirectionColumns CollectionBuilderBase::GetDirections() const {
+  // This also triggers the construction of the collection if needed
+  auto const momenta = GetMomenta();
+  std::size_t const size = momenta.size();
+  Momentum const *source = (size > 0) ? &momenta[0] : nullptr;
+
+  if (source != directionsSource_ or size != directionEta_.size()) {
+    HZZException exception;
+    exception << "Directions requested for a collection other than the one "
+        "constructed in the current event.";
+    throw exception;
+  }
+
+  return {{directionEta_.data(), size}, {directionPhi_.data(), size}};
 }
 
 
 bool CollectionBuilderBase::IsDuplicate(Momentum const &p4, double maxDR) const {
+  double const maxDR2 = std::pow(maxDR, 2);
+  double const eta = p4.Eta(), phi = p4.Phi();
+
   for (auto *builder : prioritizedBuilders_) {
-    if (builder->GetMomenta().HasOverlap(p4, maxDR))
-      return true;
+    auto const directions = builder->GetDirections();
+
+    for (std::size_t i = 0; i < directions.size(); ++i) {
+      if (utils::DeltaR2(directions.eta[i], directions.phi[i], eta, phi)
+          < maxDR2)
+        return true;
+    }
   }
+
   return false;
 }
 
 
+void CollectionBuilderBase::RejectDuplicates(
+    DirectionColumns const &candidates, double maxDR,
+    SelectionMask &mask) const {
+  for (auto *builder : prioritizedBuilders_)
+    mask.RequireNoOverlap(candidates, builder->GetDirections(), maxDR);
+}
+
+
+void CollectionBuilderBase::FillDirections() const {
+  auto const momenta = GetMomenta();
+  std::size_t const size = momenta.size();
+  directionEta_.resize(size);
+  directionPhi_.resize(size);
+
+  for (std::size_t i = 0; i < size; ++i) {
+    Momentum const &p4 = momenta[i];
+    directionEta_[i] = p4.Eta();
+    directionPhi_[i] = p4.Phi();
+  }
+
+  directionsSource_ = (size > 0) ? &momenta[0] : nullptr;
+}
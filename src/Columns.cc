@@ -0,0 +1,75 @@
+#include <Columns.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/math/constants/constants.hpp>
+
+
+void SelectionMask::Reset(std::size_t size) {
+  mask_.assign(size, 1);
+  indicesValid_ = false;
+}
+
+
+SelectionMask &SelectionMask::Require(SelectionMask const &other) {
+  std::size_t const size = mask_.size();
+  for (std::size_t i = 0; i < size; ++i)
+    mask_[i] &= other.mask_[i];
+
+  indicesValid_ = false;
+  return *this;
+}
+
+
+SelectionMask &SelectionMask::RequireNoOverlap(
+    DirectionColumns const &objects, DirectionColumns const &others,
+    double maxDR) {
+  // Computations are done in single precision, same as the precision of the
+  // inputs. This allows the compiler to vectorize the loop over objects.
+  float const twoPi = boost::math::constants::two_pi<float>();
+  float const maxDR2 = std::pow(maxDR, 2);
+
+  std::size_t const size = mask_.size();
+  uint8_t *mask = mask_.data();
+  float const *eta = objects.eta.data();
+  float const *phi = objects.phi.data();
+
+  for (std::size_t j = 0; j < others.size(); ++j) {
+    float const otherEta = others.eta[j], otherPhi = others.phi[j];
+
+    for (std::size_t i = 0; i < size; ++i) {
+      float const dEta = eta[i] - otherEta;
+
+      // Since both angles are in [-pi, pi], the absolute difference between
+      // them is brought into [0, pi] with a single reflection
+      float const absDPhi = std::abs(phi[i] - otherPhi);
+      float const dPhi = std::min(absDPhi, twoPi - absDPhi);
+
+      mask[i] &= uint8_t(dEta * dEta + dPhi * dPhi >= maxDR2);
+    }
+  }
+
+  indicesValid_ = false;
+  return *this;
+}
+
+
+std::vector<int> const &SelectionMask::Indices() const {
+  if (indicesValid_)
+    return indices_;
+
+  // Write the index unconditionally and only advance the output position for
+  // selected objects to avoid branching
+  std::size_t const size = mask_.size();
+  indices_.resize(size);
+  std::size_t numSelected = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    indices_[numSelected] = i;
+    numSelected += mask_[i];
+  }
+
+  indices_.resize(numSelected);
+  indicesValid_ = true;
+  return indices_;
+}
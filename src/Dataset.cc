@@ -5,6 +5,9 @@
 #include <map>
 #include <utility>
 
+#include <TBranch.h>
+#include <TTreeCache.h>
+
 #include <FileInPath.h>
 #include <HZZException.h>
 #include <Logger.h>
@@ -13,6 +16,17 @@
 namespace fs = std::filesystem;
 
 
+namespace {
+
+/// Size of the cache used until the registered branches are known, in bytes
+int64_t constexpr initialCacheSize = 10 << 20;
+
+/// Allowed range for the size of the cache, in bytes
+int64_t constexpr minCacheSize = 1 << 20, maxCacheSize = 512 << 20;
+
+}  // anonymous namespace
+
+
 DatasetInfo::DatasetInfo(fs::path const &path, Options const &options)
     : definitionFile_{path},
       crossSection_{std::numeric_limits<double>::quiet_NaN()},
@@ -173,7 +187,7 @@ void DatasetInfo::SpliceYaml(YAML::Node info) const {
 
 
 Dataset::Dataset(DatasetInfo info, int skipFiles, int maxFiles)
-    : info_{std::move(info)}, chain_{"Events"} {
+    : info_{std::move(info)}, chain_{"Events"}, bulk_{chain_} {
 
   if (skipFiles < 0) {
     HZZException exception;
@@ -213,3 +227,110 @@ Dataset::Dataset(DatasetInfo info, int skipFiles, int maxFiles)
   // [1] https://github.com/root-project/root/issues/6641
   reader_.GetEntries(true);
 }
+
+
+std::vector<int64_t> Dataset::ClusterBoundaries() {
+  std::vector<int64_t> boundaries;
+  int64_t const numEntries = NumEntries();
+
+  for (int iTree = 0; iTree < chain_.GetNtrees(); ++iTree) {
+    int64_t const offset = chain_.GetTreeOffset()[iTree];
+    if (chain_.LoadTree(offset) < 0)
+      continue;
+
+    TTree *tree = chain_.GetTree();
+    int64_t const numTreeEntries = tree->GetEntries();
+    auto clusterIt = tree->GetClusterIterator(0);
+    int64_t start;
+
+    while ((start = clusterIt()) < numTreeEntries)
+      boundaries.emplace_back(offset + start);
+  }
+
+  boundaries.emplace_back(numEntries);
+  return boundaries;
+}
+
+
+void Dataset::ReportReadStatistics() {
+  TTreeCache const *cache = chain_.GetReadCache(chain_.GetCurrentFile());
+
+  if (not cache) {
+    LOG_INFO << "No TTreeCache was used to read the input files.";
+    return;
+  }
+
+  // The same cache object is reused for all files in the chain, so the
+  // statistics accumulate over the files
+  int64_t const bytesCached = cache->GetBytesRead();
+  int64_t const bytesUncached = cache->GetNoCacheBytesRead();
+  LOG_INFO << "Read " << (bytesCached + bytesUncached) / 1e6
+      << " MB from input files, of which " << bytesUncached / 1e6
+      << " MB bypassed the cache. Cache hit rate: "
+      << 100. * cache->GetEfficiencyRel() << "%.";
+}
+
+
+void Dataset::SetUpCache(int64_t firstEntry) {
+  // TTreeReader adds the branches of all registered readers to the cache when
+  // it attaches to a tree and stops the learning phase of the cache. Make sure
+  // that the cache exists at that point.
+  chain_.SetCacheSize(initialCacheSize);
+  reader_.SetEntry(firstEntry);
+
+  TTreeCache *cache = chain_.GetReadCache(chain_.GetCurrentFile());
+
+  if (not cache) {
+    LOG_WARN << "Failed to set up TTreeCache for input files.";
+    return;
+  }
+
+  // Branches read in bulk bypass the TTreeReader and need to be added to the
+  // cache explicitly
+  for (auto const &name : bulk_.GetBranchNames())
+    if (chain_.GetBranch(name.c_str()))
+      chain_.AddBranchToCache(name.c_str(), true);
+
+  TObjArray const *branches = cache->GetCachedBranches();
+
+  if (not branches or branches->GetEntries() == 0) {
+    LOG_DEBUG << "No branches registered. Disabling TTreeCache.";
+    chain_.SetCacheSize(0);
+    return;
+  }
+
+  int64_t const cacheSize = ComputeCacheSize(branches);
+  chain_.SetCacheSize(cacheSize);
+  LOG_DEBUG << "TTreeCache of " << cacheSize / 1e6 << " MB set up for "
+      << branches->GetEntries() << " registered branches.";
+
+  for (int i = 0; i < branches->GetEntries(); ++i)
+    LOG_TRACE << "Cached branch: " << branches->At(i)->GetName();
+}
+
+
+int64_t Dataset::ComputeCacheSize(TObjArray const *branches) {
+  TTree *tree = chain_.GetTree();
+  int64_t const numEntries = tree->GetEntries();
+
+  if (numEntries == 0)
+    return initialCacheSize;
+
+  int64_t zipBytes = 0;
+
+  for (int i = 0; i < branches->GetEntries(); ++i)
+    zipBytes += static_cast<TBranch *>(branches->At(i))->GetZipBytes("*");
+
+  int64_t maxClusterSize = 0;
+  auto clusterIt = tree->GetClusterIterator(0);
+  int64_t start;
+
+  while ((start = clusterIt()) < numEntries)
+    maxClusterSize = std::max(
+        maxClusterSize,
+        std::min<int64_t>(clusterIt.GetNextEntry(), numEntries) - start);
+
+  // Baskets are not always aligned with cluster boundaries, so leave a margin
+  double const size = 1.2 * zipBytes / numEntries * maxClusterSize;
+  return std::clamp(int64_t(size), minCacheSize, maxCacheSize);
+}
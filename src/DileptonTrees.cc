@@ -5,9 +5,9 @@
 #include <cstdlib>
 #include <stdexcept>
 
-#include <TLorentzVector.h>
 #include <TVector2.h>
 
+#include <FourMomentum.h>
 #include <Utils.h>
 
 
@@ -18,12 +18,12 @@ int const DileptonTrees::maxSize_;
 
 
 DileptonTrees::DileptonTrees(Options const &options, Dataset &dataset)
-    : EventTrees{options, dataset},
+    : EventTrees{options, dataset, "Vars", true},
       storeMoreVariables_{options.Exists("more-vars")},
       ptMissCut_{options.GetAs<double>("ptmiss-cut")},
       triggerFilter_{dataset, options, &runSampler_},
-      srcEvent_{dataset.Reader(), "event"},
-      srcNumPVGood_{dataset.Reader(), "PV_npvsGood"} {
+      srcEvent_{dataset, "event"},
+      srcNumPVGood_{dataset, "PV_npvsGood"} {
 
   if (isSim_) {
     auto const &node = dataset.Info().Parameters()["zz_2l2nu"];
@@ -78,6 +78,11 @@ po::options_description DileptonTrees::OptionsDescription() {
 
 
 bool DileptonTrees::ProcessEvent() {
+  return ForEachShapeVariation([this]{return ProcessVariation();});
+}
+
+
+bool DileptonTrees::ProcessVariation() {
   if (not ApplyCommonFilters())
     return false;
 
@@ -105,7 +110,7 @@ bool DileptonTrees::ProcessEvent() {
   }
 
   leptonCat_ = int(leptonCat);
-  TLorentzVector const p4LL = l1->p4 + l2->p4;
+  FourMomentum const p4LL = l1->p4 + l2->p4;
   llPt_ = p4LL.Pt();
   llEta_ = p4LL.Eta();
   llPhi_ = p4LL.Phi();
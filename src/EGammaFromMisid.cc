@@ -5,9 +5,9 @@
 #include <cstdlib>
 #include <stdexcept>
 
-#include <TLorentzVector.h>
 #include <TVector2.h>
 
+#include <FourMomentum.h>
 #include <Utils.h>
 
 
@@ -21,10 +21,10 @@ EGammaFromMisid::EGammaFromMisid(Options const &options, Dataset &dataset)
       photonBuilder_{dataset},
       // photonFilter_{dataset, options},
       photonWeight_{dataset, options, &photonBuilder_},
-      srcRun_{dataset.Reader(), "run"},
-      srcLumi_{dataset.Reader(), "luminosityBlock"},
-      srcEvent_{dataset.Reader(), "event"},
-      srcNumPVGood_{dataset.Reader(), "PV_npvsGood"} {
+      srcRun_{dataset, "run"},
+      srcLumi_{dataset, "luminosityBlock"},
+      srcEvent_{dataset, "event"},
+      srcNumPVGood_{dataset, "PV_npvsGood"} {
 
   if (isSim_) {
     srcLHEVpt_.reset(new TTreeReaderValue<Float_t>(dataset.Reader(), "LHE_Vpt"));
@@ -166,7 +166,7 @@ bool EGammaFromMisid::ProcessEvent() {
     }
   }
 
-  TLorentzVector p4tot;
+  FourMomentum p4tot;
   switch (eventCat) {
     case EventCat::kEE:
       e0 = &electrons[0];
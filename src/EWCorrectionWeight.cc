@@ -13,14 +13,10 @@ namespace fs = std::filesystem;
 using namespace std;
 
 
-EWCorrectionWeight::EWCorrectionWeight(Dataset &dataset, Options const &options)
-    : cache_{dataset.Reader()},
-      genPartPt_{dataset.Reader(), "GenPart_pt"},
-      genPartEta_{dataset.Reader(), "GenPart_eta"},
-      genPartPhi_{dataset.Reader(), "GenPart_phi"},
-      genPartMass_{dataset.Reader(), "GenPart_mass"},
-      genPartPdgId_{dataset.Reader(), "GenPart_pdgId"},
-      genPartIdxMother_{dataset.Reader(), "GenPart_genPartIdxMother"},
+EWCorrectionWeight::EWCorrectionWeight(Dataset &dataset, Options const &options,
+                                       GenParticleIndex const *genParticles)
+    : node_{dataset.Graph(), "EWCorrectionWeight", [this]{Update();}},
+      genParticles_{genParticles},
       generatorX1_{dataset.Reader(), "Generator_x1"},
       generatorX2_{dataset.Reader(), "Generator_x2"},
       generatorId1_{dataset.Reader(), "Generator_id1"},
@@ -47,6 +43,8 @@ EWCorrectionWeight::EWCorrectionWeight(Dataset &dataset, Options const &options)
   if (correctionType_ != Type::None) {
     LOG_DEBUG << "Will apply EW corrections of type \"" << typeLabel << "\".";
     readFile_and_loadEwkTable();
+    node_.AddInput(genParticles_->GetNode());
+    node_.SetPrefetch([this]{Prefetch();});
   } else
     LOG_DEBUG << "Will not apply EW corrections.";
 
@@ -63,8 +61,7 @@ EWCorrectionWeight::EWCorrectionWeight(Dataset &dataset, Options const &options)
 double EWCorrectionWeight::NominalWeight() const {
   if (correctionType_ == Type::None)
     return 1.;
-  if (cache_.IsUpdated())
-    Update();
+  node_.Evaluate();
   return weightNominal_;
 }
 
@@ -79,15 +76,13 @@ int EWCorrectionWeight::NumVariations() const {
 double EWCorrectionWeight::operator()() const {
   if (correctionType_ == Type::None)
     return 1.;
-  if (cache_.IsUpdated())
-    Update();
+  node_.Evaluate();
   return weightNominal_ + systDirection_ * weightError_;
 }
 
 
 double EWCorrectionWeight::RelWeight(int variation) const {
-  if (cache_.IsUpdated())
-    Update();
+  node_.Evaluate();
   if (variation == 0)
     return 1. + weightError_ / weightNominal_;
   else
@@ -180,16 +175,18 @@ std::map<std::string,std::pair<TLorentzVector,TLorentzVector>> EWCorrectionWeigh
   std::map<std::string,std::pair<TLorentzVector,TLorentzVector>> genLevelLeptons; //Convention: For Z, first is lepton and second is antilepton. For W, first is charged lepton and second is neutrino. Warning: does not work for ZZ->4l or for WW->2l2nu.
   //std::cout << "====================================================================================================================================" << std::endl;
   //std::cout << "New event." << std::endl;
-  for (int i = 0; i < int(genPartPt_.GetSize()); i++) {
-    //std::cout << "BareLepton with ID = " << genPartPdgId_[i] << " and status = " << GenPart_status[0] << " and MomId = " << genPartPdgId_[genPartIdxMother_[i]] <<  " and pT = " << genPartPt_[i] << std::endl;
-    if(fabs(genPartPdgId_[genPartIdxMother_[i]]) == 23 && (genPartPdgId_[i] == 11 || genPartPdgId_[i] == 13 || genPartPdgId_[i] == 15)) genLevelLeptons["leptonsFromZ"].first.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
-    if(fabs(genPartPdgId_[genPartIdxMother_[i]]) == 23 && (genPartPdgId_[i] == -11 || genPartPdgId_[i] == -13 || genPartPdgId_[i] == -15)) genLevelLeptons["leptonsFromZ"].second.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
-    if(fabs(genPartPdgId_[genPartIdxMother_[i]]) == 23 && (genPartPdgId_[i] == 12 || genPartPdgId_[i] == 14 || genPartPdgId_[i] == 16)) genLevelLeptons["neutrinosFromZ"].first.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
-    if(fabs(genPartPdgId_[genPartIdxMother_[i]]) == 23 && (genPartPdgId_[i] == -12 || genPartPdgId_[i] == -14 || genPartPdgId_[i] == -16)) genLevelLeptons["neutrinosFromZ"].second.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
-    if(genPartPdgId_[genPartIdxMother_[i]] == 24 && (fabs(genPartPdgId_[i]) == 11 || fabs(genPartPdgId_[i]) == 13 || fabs(genPartPdgId_[i]) == 15)) genLevelLeptons["leptonsFromWp"].first.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
-    if(genPartPdgId_[genPartIdxMother_[i]] == 24 && (fabs(genPartPdgId_[i]) == 12 || fabs(genPartPdgId_[i]) == 14 || fabs(genPartPdgId_[i]) == 16)) genLevelLeptons["leptonsFromWp"].second.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
-    if(genPartPdgId_[genPartIdxMother_[i]] == -24 && (fabs(genPartPdgId_[i]) == 11 || fabs(genPartPdgId_[i]) == 13 || fabs(genPartPdgId_[i]) == 15)) genLevelLeptons["leptonsFromWm"].first.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
-    if(genPartPdgId_[genPartIdxMother_[i]] == -24 && (fabs(genPartPdgId_[i]) == 12 || fabs(genPartPdgId_[i]) == 14 || fabs(genPartPdgId_[i]) == 16)) genLevelLeptons["leptonsFromWm"].second.SetPtEtaPhiM(genPartPt_[i],genPartEta_[i],genPartPhi_[i],genPartMass_[i]);
+  auto const &genKinematics = genParticles_->Kinematics();
+  for (int i = 0; i < genParticles_->Size(); i++) {
+    int const pdgId = genParticles_->PdgId(i);
+    int const motherPdgId = genParticles_->MotherPdgId(i);
+    if(fabs(motherPdgId) == 23 && (pdgId == 11 || pdgId == 13 || pdgId == 15)) genLevelLeptons["leptonsFromZ"].first.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
+    if(fabs(motherPdgId) == 23 && (pdgId == -11 || pdgId == -13 || pdgId == -15)) genLevelLeptons["leptonsFromZ"].second.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
+    if(fabs(motherPdgId) == 23 && (pdgId == 12 || pdgId == 14 || pdgId == 16)) genLevelLeptons["neutrinosFromZ"].first.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
+    if(fabs(motherPdgId) == 23 && (pdgId == -12 || pdgId == -14 || pdgId == -16)) genLevelLeptons["neutrinosFromZ"].second.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
+    if(motherPdgId == 24 && (fabs(pdgId) == 11 || fabs(pdgId) == 13 || fabs(pdgId) == 15)) genLevelLeptons["leptonsFromWp"].first.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
+    if(motherPdgId == 24 && (fabs(pdgId) == 12 || fabs(pdgId) == 14 || fabs(pdgId) == 16)) genLevelLeptons["leptonsFromWp"].second.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
+    if(motherPdgId == -24 && (fabs(pdgId) == 11 || fabs(pdgId) == 13 || fabs(pdgId) == 15)) genLevelLeptons["leptonsFromWm"].first.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
+    if(motherPdgId == -24 && (fabs(pdgId) == 12 || fabs(pdgId) == 14 || fabs(pdgId) == 16)) genLevelLeptons["leptonsFromWm"].second.SetPtEtaPhiM(genKinematics.pt[i],genKinematics.eta[i],genKinematics.phi[i],genKinematics.mass[i]);
   }
   return genLevelLeptons;
 }
@@ -332,6 +329,14 @@ double EWCorrectionWeight::getEwkCorrections(std::map<std::string,std::pair<TLor
 }
 
 
+void EWCorrectionWeight::Prefetch() const {
+  *generatorX1_;
+  *generatorX2_;
+  *generatorId1_;
+  *generatorId2_;
+}
+
+
 void EWCorrectionWeight::Update() const {
   if (correctionType_ == Type::None)
     return;
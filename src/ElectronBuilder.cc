@@ -6,7 +6,7 @@
 
 
 ElectronBuilder::ElectronBuilder(Dataset &dataset, Options const &)
-    : CollectionBuilder{dataset.Reader()},
+    : CollectionBuilder{dataset, "ElectronBuilder"},
       minPtLoose_{10.}, minPtTight_{15.},
       // maxRelIsoLoose_{0.4}, maxRelIsoTight_{0.1},
       srcPt_{dataset.Reader(), "Electron_pt"},
@@ -18,7 +18,9 @@ ElectronBuilder::ElectronBuilder(Dataset &dataset, Options const &)
       srcCharge_{dataset.Reader(), "Electron_charge"},
       srcIdLoose_{dataset.Reader(), "Electron_mvaFall17V2Iso_WPL"},
       srcIdTight_{dataset.Reader(), "Electron_mvaFall17V2Iso_WP90"},
-      srcECorr_{dataset.Reader(), "Electron_eCorr"} {}
+      srcECorr_{dataset.Reader(), "Electron_eCorr"} {
+  GetNode().SetPrefetch([this]{Prefetch();});
+}
 
 
 std::vector<Electron> const &ElectronBuilder::GetLoose() const {
@@ -38,46 +40,50 @@ void ElectronBuilder::Build() const {
   looseElectrons_.clear();
   tightElectrons_.clear();
 
-  for (unsigned i = 0; i < srcPt_.GetSize(); ++i) {
-    double const eta = srcEta_[i];
-    double const etaSc = srcDeltaEtaSc_[i] + eta;
-    double const absEtaSc = std::abs(etaSc);
-    bool const passIdLoose = srcIdLoose_[i];
-    bool const passIdTight = srcIdTight_[i];
-
-    if (not passIdLoose)
-      continue;
-
-    if (not (srcPt_[i] > minPtLoose_))
-      continue;
-
-    if (not (absEtaSc < 2.5))
-      continue;
-
+  KinematicColumns const columns{
+      srcPt_.View(), srcEta_.View(), srcPhi_.View(), srcMass_.View()};
+  auto const deltaEtaSc = srcDeltaEtaSc_.View();
+
+  // Apply the selections that only depend on the input columns to all
+  // electrons at once
+  double const minPtLoose = minPtLoose_, minPtTight = minPtTight_;
+  auto const absEtaSc = [](float deltaEtaSc, float eta){
+    return std::abs(deltaEtaSc + double(eta));
+  };
+
+  looseMask_.Reset(columns.size());
+  looseMask_.Require(srcIdLoose_.View(), [](bool id){return id;})
+      .Require(columns.pt, [=](float pt){return pt > minPtLoose;})
+      .Require(deltaEtaSc, columns.eta, [=](float deltaEtaSc, float eta){
+        return absEtaSc(deltaEtaSc, eta) < 2.5;
+      });
+
+  tightMask_.Reset(columns.size());
+  tightMask_.Require(srcIdTight_.View(), [](bool id){return id;})
+      .Require(columns.pt, [=](float pt){return pt > minPtTight;})
+      .Require(deltaEtaSc, columns.eta, [=](float deltaEtaSc, float eta){
+        // EB-EE gap
+        double const value = absEtaSc(deltaEtaSc, eta);
+        return not (value > 1.4442 and value < 1.5660);
+      });
+
+  // Angular cleaning
+  RejectDuplicates(columns.Directions(), 0.1, looseMask_);
+
+  for (int i : looseMask_.Indices()) {
     Electron electron;
-    electron.p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], srcMass_[i]);
+    electron.p4 = columns.Momentum(i);
     electron.charge = srcCharge_[i];
-    electron.etaSc = etaSc;
-
-    if (IsDuplicate(electron.p4, 0.1))
-      continue;
+    electron.etaSc = deltaEtaSc[i] + double(columns.eta[i]);
 
     looseElectrons_.emplace_back(electron);
 
     // Propagate corrections to momenta of loose electrons to ptmiss
-    TLorentzVector const uncorrP4 = electron.p4 * (1. / srcECorr_[i]);
+    FourMomentum const uncorrP4 = electron.p4 * (1. / srcECorr_[i]);
     AddMomentumShift(uncorrP4, electron.p4);
 
-    if (not passIdTight)
-      continue;
-
-    if (not (srcPt_[i] > minPtTight_))
-      continue;
-
-    if (absEtaSc > 1.4442 and absEtaSc < 1.5660)  // EB-EE gap
-      continue;
-
-    tightElectrons_.emplace_back(electron);
+    if (tightMask_[i])
+      tightElectrons_.emplace_back(electron);
   }
 
   // Make sure the collections are ordered in pt
@@ -85,3 +91,13 @@ void ElectronBuilder::Build() const {
   std::sort(tightElectrons_.begin(), tightElectrons_.end(), PtOrdered);
 }
 
+
+void ElectronBuilder::Prefetch() const {
+  for (auto *src : {&srcPt_, &srcEta_, &srcPhi_, &srcMass_, &srcDeltaEtaSc_,
+                    &srcECorr_})
+    src->Prefetch();
+
+  srcCharge_.Prefetch();
+  srcIdLoose_.Prefetch();
+  srcIdTight_.Prefetch();
+}
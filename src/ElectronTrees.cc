@@ -20,13 +20,13 @@ int const ElectronTrees::maxSize_;
 ElectronTrees::ElectronTrees(Options const &options, Dataset &dataset)
     : EventTrees{options, dataset},
       storeMoreVariables_{options.Exists("more-vars")},
-      srcRun_{dataset.Reader(), "run"},
-      srcLumi_{dataset.Reader(), "luminosityBlock"},
-      srcEvent_{dataset.Reader(), "event"},
+      srcRun_{dataset, "run"},
+      srcLumi_{dataset, "luminosityBlock"},
+      srcEvent_{dataset, "event"},
       photonBuilder_{dataset},
       // photonWeight_{dataset, options, &photonBuilder_},
       // photonFilter_{dataset, options},
-      srcNumPVGood_{dataset.Reader(), "PV_npvsGood"} {
+      srcNumPVGood_{dataset, "PV_npvsGood"} {
 
   if (isSim_) {
     srcLHEVpt_.reset(new TTreeReaderValue<Float_t>(dataset.Reader(), "LHE_Vpt"));
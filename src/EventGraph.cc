@@ -0,0 +1,363 @@
+#include <EventGraph.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <thread>
+
+#include <HZZException.h>
+#include <Logger.h>
+#include <ShapeSyst.h>
+
+
+/**
+ * \brief Persistent pool of threads that execute tasks with dependencies
+ *
+ * The thread that calls \ref Run also executes tasks, so that a pool with
+ * n - 1 helper threads provides n threads in total.
+ */
+class EventGraph::TaskPool {
+ public:
+  TaskPool(int numHelpers);
+  ~TaskPool() noexcept;
+
+  /**
+   * \brief Executes a batch of tasks and waits for their completion
+   *
+   * \param[in] task  Function called with the index of a task to execute it.
+   * \param[in] pending  Number of prerequisites of each task.
+   * \param[in] dependents  Indices of tasks that depend on each task.
+   *
+   * If any of the tasks throws an exception, the first one is rethrown after
+   * all tasks have been executed.
+   */
+  void Run(std::function<void(int)> const &task, std::vector<int> pending,
+           std::vector<std::vector<int>> const &dependents);
+
+ private:
+  /// Main function of helper threads
+  void HelperLoop();
+
+  /**
+   * \brief Executes one ready task
+   *
+   * The given lock must hold \ref mutex_. It is released while the task is
+   * being executed.
+   */
+  void RunReady(std::unique_lock<std::mutex> &lock);
+
+  std::vector<std::thread> helpers_;
+
+  /// Protects all data members below
+  std::mutex mutex_;
+
+  /// Notified when new tasks become ready or all tasks are done
+  std::condition_variable changed_;
+
+  /// Indicates that helper threads should exit
+  bool stop_;
+
+  /// State of the current batch
+  std::function<void(int)> const *task_;
+  std::vector<int> pending_;
+  std::vector<std::vector<int>> const *dependents_;
+  std::vector<int> ready_;
+  int numUnfinished_;
+  std::exception_ptr error_;
+};
+
+
+EventGraph::TaskPool::TaskPool(int numHelpers)
+    : stop_{false}, task_{nullptr}, dependents_{nullptr}, numUnfinished_{0} {
+  for (int i = 0; i < numHelpers; ++i)
+    helpers_.emplace_back(&TaskPool::HelperLoop, this);
+}
+
+
+EventGraph::TaskPool::~TaskPool() noexcept {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stop_ = true;
+  }
+  changed_.notify_all();
+
+  for (auto &helper : helpers_)
+    helper.join();
+}
+
+
+void EventGraph::TaskPool::Run(
+    std::function<void(int)> const &task, std::vector<int> pending,
+    std::vector<std::vector<int>> const &dependents) {
+  std::unique_lock<std::mutex> lock{mutex_};
+  task_ = &task;
+  pending_ = std::move(pending);
+  dependents_ = &dependents;
+  numUnfinished_ = pending_.size();
+  ready_.clear();
+
+  for (int i = 0; i < int(pending_.size()); ++i)
+    if (pending_[i] == 0)
+      ready_.push_back(i);
+
+  changed_.notify_all();
+
+  while (numUnfinished_ > 0) {
+    if (ready_.empty())
+      changed_.wait(lock);
+    else
+      RunReady(lock);
+  }
+
+  task_ = nullptr;
+  dependents_ = nullptr;
+
+  if (error_) {
+    auto error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+
+void EventGraph::TaskPool::HelperLoop() {
+  std::unique_lock<std::mutex> lock{mutex_};
+
+  while (true) {
+    changed_.wait(lock, [this]{return stop_ or not ready_.empty();});
+
+    if (stop_)
+      return;
+
+    RunReady(lock);
+  }
+}
+
+
+void EventGraph::TaskPool::RunReady(std::unique_lock<std::mutex> &lock) {
+  int const index = ready_.back();
+  ready_.pop_back();
+
+  lock.unlock();
+  std::exception_ptr error;
+
+  try {
+    (*task_)(index);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  lock.lock();
+
+  if (error and not error_)
+    error_ = error;
+
+  for (int dependent : (*dependents_)[index])
+    if (--pending_[dependent] == 0)
+      ready_.push_back(dependent);
+
+  --numUnfinished_;
+  changed_.notify_all();
+}
+
+
+EventGraph::EventGraph()
+    : generation_{1}, numThreads_{1} {}
+
+
+EventGraph::~EventGraph() noexcept = default;
+
+
+int EventGraph::AddNode(std::string name, std::function<void()> evaluate,
+                        ShapeSyst const *shapeSyst) {
+  auto &node = nodes_.emplace_back(std::make_unique<Node>());
+  node->name = std::move(name);
+  node->evaluate = std::move(evaluate);
+  node->shapeSyst = shapeSyst;
+  node->evaluatedKey = std::numeric_limits<uint64_t>::max();
+  node->evaluating = false;
+  return nodes_.size() - 1;
+}
+
+
+void EventGraph::AddInput(int node, int input) {
+  auto &inputs = nodes_.at(node)->inputs;
+
+  if (std::find(inputs.begin(), inputs.end(), input) != inputs.end())
+    return;
+
+  if (node == input or IsReachable(input, node)) {
+    HZZException exception;
+    exception << "Making node \"" << nodes_[input]->name
+        << "\" an input for node \"" << nodes_[node]->name
+        << "\" would create a cycle.";
+    throw exception;
+  }
+
+  LOG_TRACE << "Node \"" << nodes_[node]->name << "\" uses node \""
+      << nodes_[input]->name << "\".";
+  inputs.push_back(input);
+}
+
+
+void EventGraph::Evaluate(int index) {
+  Node &node = *nodes_[index];
+  uint64_t const key = StateKey(node);
+
+  if (node.evaluatedKey.load(std::memory_order_acquire) == key)
+    return;
+
+  std::lock_guard<std::recursive_mutex> lock{node.mutex};
+
+  // The node might have been evaluated by another thread while this one was
+  // waiting for the lock, or the evaluation function of the node might be
+  // accessing its own results
+  if (node.evaluatedKey.load(std::memory_order_relaxed) == key
+      or node.evaluating)
+    return;
+
+  node.evaluating = true;
+
+  try {
+    for (int input : node.inputs)
+      Evaluate(input);
+
+    node.evaluate();
+  } catch (...) {
+    node.evaluating = false;
+    throw;
+  }
+
+  node.evaluating = false;
+  node.evaluatedKey.store(key, std::memory_order_release);
+}
+
+
+void EventGraph::EvaluateEager() {
+  if (numThreads_ <= 1 or eagerNodes_.empty())
+    return;
+
+  std::vector<int> order;
+  std::vector<uint8_t> visited(nodes_.size(), 0);
+
+  for (int index : eagerNodes_)
+    CollectInputs(index, order, visited);
+
+  // Nodes that cannot be evaluated concurrently are evaluated serially first,
+  // in the topological order. This also evaluates their inputs.
+  for (int index : order) {
+    Node const &node = *nodes_[index];
+
+    if (not node.prefetch or node.shapeSyst)
+      Evaluate(index);
+  }
+
+  // Remaining outdated nodes are evaluated concurrently. Their positions in
+  // the batch are recorded, shifted by one so that zero means no position.
+  std::vector<int> batch;
+  std::vector<int> positions(nodes_.size(), 0);
+
+  for (int index : order) {
+    Node &node = *nodes_[index];
+
+    if (node.evaluatedKey.load(std::memory_order_relaxed) == StateKey(node))
+      continue;
+
+    node.prefetch();
+    batch.push_back(index);
+    positions[index] = batch.size();
+  }
+
+  if (batch.empty())
+    return;
+
+  std::vector<int> pending(batch.size(), 0);
+  std::vector<std::vector<int>> dependents(batch.size());
+
+  for (int i = 0; i < int(batch.size()); ++i) {
+    for (int input : nodes_[batch[i]]->inputs) {
+      if (positions[input] > 0) {
+        ++pending[i];
+        dependents[positions[input] - 1].push_back(i);
+      }
+    }
+  }
+
+  if (not pool_)
+    pool_ = std::make_unique<TaskPool>(numThreads_ - 1);
+
+  pool_->Run([this, &batch](int i){Evaluate(batch[i]);}, std::move(pending),
+             dependents);
+}
+
+
+void EventGraph::ScheduleEager(int node) {
+  nodes_.at(node);
+
+  if (std::find(eagerNodes_.begin(), eagerNodes_.end(), node)
+      == eagerNodes_.end())
+    eagerNodes_.push_back(node);
+}
+
+
+void EventGraph::SetNumThreads(int numThreads) {
+  if (numThreads == numThreads_)
+    return;
+
+  LOG_DEBUG << "Eagerly evaluated nodes of the event graph will use "
+      << numThreads << " thread(s).";
+  numThreads_ = numThreads;
+  pool_.reset();
+}
+
+
+void EventGraph::SetPrefetch(int node, std::function<void()> prefetch) {
+  nodes_.at(node)->prefetch = std::move(prefetch);
+}
+
+
+void EventGraph::CollectInputs(int index, std::vector<int> &order,
+                               std::vector<uint8_t> &visited) const {
+  if (visited[index])
+    return;
+
+  visited[index] = 1;
+
+  for (int input : nodes_[index]->inputs)
+    CollectInputs(input, order, visited);
+
+  order.push_back(index);
+}
+
+
+bool EventGraph::IsReachable(int source, int target) const {
+  std::vector<uint8_t> visited(nodes_.size(), 0);
+  std::vector<int> stack{source};
+  visited[source] = 1;
+
+  while (not stack.empty()) {
+    int const index = stack.back();
+    stack.pop_back();
+
+    if (index == target)
+      return true;
+
+    for (int input : nodes_[index]->inputs) {
+      if (not visited[input]) {
+        visited[input] = 1;
+        stack.push_back(input);
+      }
+    }
+  }
+
+  return false;
+}
+
+
+uint64_t EventGraph::StateKey(Node const &node) const {
+  // The number of shape variations is small, so that 8 bits are sufficient
+  uint64_t const variation =
+      (node.shapeSyst) ? node.shapeSyst->GetCurrentIndex() : 0;
+  return (generation_ << 8) | variation;
+}
@@ -9,9 +9,9 @@ EventNumberFilter::EventNumberFilter(Dataset &dataset, Options const &options)
       isSim_{dataset.Info().IsSimulation()},
       runMap_{LoadEventList(dataset, options)},
       eventMap_{runMap_.end()},
-      run_{dataset.Reader(), "run"},
-      lumiBlock_{dataset.Reader(), "luminosityBlock"},
-      event_{dataset.Reader(), "event"}
+      run_{dataset, "run"},
+      lumiBlock_{dataset, "luminosityBlock"},
+      event_{dataset, "event"}
 {}
 
 EventNumberFilter::RunMap EventNumberFilter::LoadEventList(
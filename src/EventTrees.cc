@@ -1,27 +1,46 @@
 #include <EventTrees.h>
 
+#include <HZZException.h>
+
 
 EventTrees::EventTrees(Options const &options, Dataset &dataset,
-                       std::string const treeName)
+                       std::string const treeName,
+                       bool supportsShapeVariations)
     : AnalysisCommon{options, dataset},
       storeWeightSyst_{options.GetAs<std::string>("syst") == "weights"},
       outputFile_{options.GetAs<std::string>("output").c_str(), "recreate"} {
-  tree_ = new TTree(treeName.c_str(), "");
-  tree_->SetDirectory(&outputFile_);
 
+  if (shapeSyst_.IsMultiple() and not supportsShapeVariations)
+    throw HZZException{
+        "This analysis does not support evaluation of multiple shape "
+        "variations in a single pass."};
+
+  for (int i = 0; i < shapeSyst_.NumVariations(); ++i) {
+    std::string name{treeName};
+    if (shapeSyst_.IsMultiple() and not shapeSyst_.Label(i).empty())
+      name += "_" + std::string{shapeSyst_.Label(i)};
+
+    auto *tree = new TTree(name.c_str(), "");
+    tree->SetDirectory(&outputFile_);
+    trees_.emplace_back(tree);
+  }
+
+  if (options.Exists("pipeline"))
+    writer_ = std::make_unique<AsyncTreeWriter>(trees_);
 }
 
 void EventTrees::CreateWeightBranches() {
   if (isSim_) {
-    tree_->Branch("weight", &weight_);
+    AddBranch("weight", &weight_);
 
     if (storeWeightSyst_) {
       int const numVariations = weightCollector_.NumVariations();
       systWeights_.resize(numVariations);
+      weightBuffer_.resize(numVariations + 1);
       for (int i = 0; i < numVariations; ++i) {
         auto const name = "weight_"
             + std::string{weightCollector_.VariationName(i)};
-        tree_->Branch(name.c_str(), &systWeights_[i]);
+        AddBranch(name.c_str(), &systWeights_[i]);
       }
     }
   }
@@ -29,6 +48,9 @@ void EventTrees::CreateWeightBranches() {
 
 
 void EventTrees::PostProcessing() {
+  if (writer_)
+    writer_->Finish();
+
   outputFile_.Write();
   outputFile_.Close();
 }
@@ -39,11 +61,16 @@ void EventTrees::FillTree() {
     if (not storeWeightSyst_)
       weight_ = weightCollector_() * intLumi_;
     else {
-      weight_ = weightCollector_.NominalWeight() * intLumi_;
+      weightCollector_.FillVariations(weightBuffer_.data());
+      weight_ = weightBuffer_[0] * intLumi_;
       for (int i = 0; i < int(systWeights_.size()); ++i)
-        systWeights_[i] = weightCollector_.RelWeight(i) * weight_;
+        systWeights_[i] = weightBuffer_[i + 1] * weight_;
     }
   }
-  tree_->Fill();
+
+  if (writer_)
+    writer_->Fill(shapeSyst_.GetCurrentIndex());
+  else
+    trees_[shapeSyst_.GetCurrentIndex()]->Fill();
 }
 
@@ -4,7 +4,7 @@
 
 
 GenJetBuilder::GenJetBuilder(Dataset &dataset, Options const &)
-    : CollectionBuilder{dataset.Reader()},
+    : CollectionBuilder{dataset, "GenJetBuilder"},
       srcPt_{dataset.Reader(), "GenJet_pt"},
       srcEta_{dataset.Reader(), "GenJet_eta"},
       srcPhi_{dataset.Reader(), "GenJet_phi"},
@@ -20,13 +20,14 @@ std::vector<GenJet> const &GenJetBuilder::Get() const {
 void GenJetBuilder::Build() const {
   jets_.clear();
 
-  for (unsigned i = 0; i < srcPt_.GetSize(); ++i) {
-    GenJet jet;
-    jet.p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], srcMass_[i]);
-
-    if (IsDuplicate(jet.p4, 0.4))
-      continue;
+  KinematicColumns const columns{
+      srcPt_.View(), srcEta_.View(), srcPhi_.View(), srcMass_.View()};
+  mask_.Reset(columns.size());
+  RejectDuplicates(columns.Directions(), 0.4, mask_);
 
+  for (int i : mask_.Indices()) {
+    GenJet jet;
+    jet.p4 = columns.Momentum(i);
     jets_.emplace_back(jet);
   }
 
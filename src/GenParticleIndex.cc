@@ -0,0 +1,152 @@
+#include <GenParticleIndex.h>
+
+#include <boost/math/constants/constants.hpp>
+
+
+GenParticleIndex::GenParticleIndex(Dataset &dataset)
+    : node_{dataset.Graph(), "GenParticleIndex", [this]{Build();}},
+      srcPt_{dataset.Reader(), "GenPart_pt"},
+      srcEta_{dataset.Reader(), "GenPart_eta"},
+      srcPhi_{dataset.Reader(), "GenPart_phi"},
+      srcMass_{dataset.Reader(), "GenPart_mass"},
+      srcPdgId_{dataset.Reader(), "GenPart_pdgId"},
+      srcStatus_{dataset.Reader(), "GenPart_status"},
+      srcStatusFlags_{dataset.Reader(), "GenPart_statusFlags"},
+      srcMother_{dataset.Reader(), "GenPart_genPartIdxMother"} {
+  double const twoPi = boost::math::constants::two_pi<double>();
+  numEtaCells_ = int(std::round(2 * kMaxAbsEta_ / kCellSize_));
+  numPhiCells_ = int(std::ceil(twoPi / kCellSize_));
+  phiCellSize_ = twoPi / numPhiCells_;
+  node_.SetPrefetch([this]{Prefetch();});
+}
+
+
+int GenParticleIndex::Size() const {
+  Update();
+  return kinematics_.size();
+}
+
+
+KinematicColumns const &GenParticleIndex::Kinematics() const {
+  Update();
+  return kinematics_;
+}
+
+
+ColumnView<int> GenParticleIndex::Daughters(int index) const {
+  Update();
+  int const begin = daughterOffsets_[index];
+  return {daughters_.data() + begin,
+          std::size_t(daughterOffsets_[index + 1] - begin)};
+}
+
+
+ColumnView<int> GenParticleIndex::WithPdgId(int pdgId) const {
+  Update();
+  return FindGroup(pdgIdGroups_, pdgIdIndices_, pdgId);
+}
+
+
+ColumnView<int> GenParticleIndex::WithStatus(int status) const {
+  Update();
+  return FindGroup(statusGroups_, statusIndices_, status);
+}
+
+
+void GenParticleIndex::BuildGroups(
+    ColumnView<int> const &keys, std::vector<std::pair<int, int>> &groups,
+    std::vector<int> &indices) {
+  int const size = keys.size();
+  indices.resize(size);
+  for (int i = 0; i < size; ++i)
+    indices[i] = i;
+
+  // Stable sorting keeps indices within each group in the increasing order
+  std::stable_sort(indices.begin(), indices.end(),
+                   [&keys](int i1, int i2){return keys[i1] < keys[i2];});
+
+  groups.clear();
+  for (int k = 0; k < size; ++k) {
+    int const key = keys[indices[k]];
+    if (groups.empty() or groups.back().first != key)
+      groups.emplace_back(key, k);
+  }
+
+  // Sentinel that marks the end of the last group
+  groups.emplace_back(std::numeric_limits<int>::max(), size);
+}
+
+
+void GenParticleIndex::Prefetch() const {
+  for (auto *src : {&srcPt_, &srcEta_, &srcPhi_, &srcMass_})
+    src->Prefetch();
+
+  for (auto *src : {&srcPdgId_, &srcStatus_, &srcStatusFlags_, &srcMother_})
+    src->Prefetch();
+}
+
+
+ColumnView<int> GenParticleIndex::FindGroup(
+    std::vector<std::pair<int, int>> const &groups,
+    std::vector<int> const &indices, int key) {
+  // The sentinel is excluded from the search
+  auto const group = std::lower_bound(
+      groups.begin(), groups.end() - 1, key,
+      [](std::pair<int, int> const &g, int key){return g.first < key;});
+
+  if (group == groups.end() - 1 or group->first != key)
+    return {};
+
+  int const begin = group->second;
+  return {indices.data() + begin, std::size_t((group + 1)->second - begin)};
+}
+
+
+void GenParticleIndex::Build() const {
+  kinematics_ = {srcPt_.View(), srcEta_.View(), srcPhi_.View(),
+                 srcMass_.View()};
+  pdgId_ = srcPdgId_.View();
+  status_ = srcStatus_.View();
+  statusFlags_ = srcStatusFlags_.View();
+  mother_ = srcMother_.View();
+  int const size = kinematics_.size();
+
+  BuildGroups(pdgId_, pdgIdGroups_, pdgIdIndices_);
+  BuildGroups(status_, statusGroups_, statusIndices_);
+
+  // Links to daughters and the grid in (eta, phi) are constructed with
+  // counting sorts. Offsets are first set to the ends of the ranges, and then
+  // particles are placed in the decreasing order, which moves the offsets to
+  // the beginnings of the ranges and keeps the indices in each range sorted.
+  daughterOffsets_.assign(size + 1, 0);
+  for (int i = 0; i < size; ++i) {
+    int const mother = mother_[i];
+    if (mother >= 0 and mother < size)
+      ++daughterOffsets_[mother];
+  }
+  for (int i = 1; i <= size; ++i)
+    daughterOffsets_[i] += daughterOffsets_[i - 1];
+
+  daughters_.resize(daughterOffsets_[size]);
+  for (int i = size - 1; i >= 0; --i) {
+    int const mother = mother_[i];
+    if (mother >= 0 and mother < size)
+      daughters_[--daughterOffsets_[mother]] = i;
+  }
+
+  int const numCells = numEtaCells_ * numPhiCells_;
+  particleCells_.resize(size);
+  cellOffsets_.assign(numCells + 1, 0);
+  for (int i = 0; i < size; ++i) {
+    int const cell = EtaCell(kinematics_.eta[i]) * numPhiCells_
+        + PhiCell(kinematics_.phi[i]);
+    particleCells_[i] = cell;
+    ++cellOffsets_[cell];
+  }
+  for (int c = 1; c <= numCells; ++c)
+    cellOffsets_[c] += cellOffsets_[c - 1];
+
+  cellParticles_.resize(size);
+  for (int i = size - 1; i >= 0; --i)
+    cellParticles_[--cellOffsets_[particleCells_[i]]] = i;
+}
@@ -13,8 +13,8 @@ GenPhotonBuilder::GenPhotonBuilder(Dataset &dataset)
       srcPhi_{dataset.Reader(), "LHEPart_phi"},
       srcMass_{dataset.Reader(), "LHEPart_mass"} {}
 
-TLorentzVector GenPhotonBuilder::P4Gamma() const {
-  TLorentzVector p4;
+FourMomentum GenPhotonBuilder::P4Gamma() const {
+  FourMomentum p4;
   bool photonFound = false;
   for (int i = 0; i < int(srcPdgId_.GetSize()); i++) {
     if (std::abs(srcPdgId_[i]) != 22)
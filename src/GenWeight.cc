@@ -1,6 +1,7 @@
 #include <GenWeight.h>
 
 #include <algorithm>
+#include <cmath>
 #include <initializer_list>
 #include <regex>
 #include <string>
@@ -13,8 +14,9 @@
 
 
 GenWeight::GenWeight(Dataset &dataset, Options const &options)
-  : srcLheNominalWeight_{dataset.Reader(), "LHEWeight_originalXWGTUP"},
-    srcGenNominalWeight_{dataset.Reader(), "Generator_weight"},
+  : node_{dataset.Graph(), "GenWeight", [this]{Update();}},
+    srcLheNominalWeight_{dataset.Reader(), "LHEWeight_originalXWGTUP"},
+    srcGenNominalWeight_{dataset, "Generator_weight"},
     srcScaleWeights_{dataset.Reader(), "LHEScaleWeight"},
     srcPdfWeights_{dataset.Reader(), "LHEPdfWeight"} {
 
@@ -45,6 +47,8 @@ GenWeight::GenWeight(Dataset &dataset, Options const &options)
     defaultVariationIndex_ = -1;
   else
     defaultVariationIndex_ = r - availableVariations_.begin();
+
+  relWeights_.reserve(availableVariations_.size());
 }
 
 
@@ -69,66 +73,24 @@ double GenWeight::EnvelopeMEScale(Var direction) const {
 }
 
 
+void GenWeight::FillVariations(float *weights) const {
+  weights[0] = NominalWeight();
+  node_.Evaluate();
+  std::copy(relWeights_.begin(), relWeights_.end(), weights + 1);
+}
+
+
 double GenWeight::NominalWeight() const {
   return *srcGenNominalWeight_ * datasetWeight_;
 }
 
 
 double GenWeight::RelWeight(int variation) const {
-  enum class Group {
-    None,
-    MEScale,
-    PDF,
-    AlphaS
-  };
-
-  Group group = Group::None;
-  int index = variation;
-  for (auto const &[g, offset, present] : {
-      std::make_tuple(Group::MEScale, 4, lheScaleWeightsPresent_),
-      std::make_tuple(Group::PDF, 2, pdfWeightsPresent_),
-      std::make_tuple(Group::AlphaS, 2, alphaSWeightsPresent_)}) {
-    if (not present)
-      continue;
-    if (index < offset) {
-      group = g;
-      break;
-    } else {
-      index -= offset;
-    }
-  }
-  if (group == Group::None)
+  if (variation < 0 or variation >= int(availableVariations_.size()))
     throw HZZException{"Illegal variation index."};
 
-  if (group == Group::MEScale) {
-    switch (index) {
-      case 0:
-        return RelWeightMEScale(Var::Up, Var::Nominal);
-      case 1:
-        return RelWeightMEScale(Var::Down, Var::Nominal);
-      case 2:
-        return RelWeightMEScale(Var::Nominal, Var::Up);
-      case 3:
-        return RelWeightMEScale(Var::Nominal, Var::Down);
-    }
-  } else if (group == Group::PDF) {
-    switch (index) {
-      case 0:
-        return RelWeightPdf(Var::Up);
-      case 1:
-        return RelWeightPdf(Var::Down);
-    }
-  } else if (group == Group::AlphaS) {
-    switch (index) {
-      case 0:
-        return RelWeightAlphaS(Var::Up);
-      case 1:
-        return RelWeightAlphaS(Var::Down);
-    }
-  }
-
-  // Should never reach this point
-  throw HZZException{"Illegal variation index."};
+  node_.Evaluate();
+  return relWeights_[variation];
 }
 
 
@@ -136,28 +98,17 @@ double GenWeight::RelWeightAlphaS(Var direction) const {
   if (not alphaSWeightsPresent_ or direction == Var::Nominal)
     return 1.;
 
-  double weight;
-  if (direction == Var::Up)
-    weight = srcPdfWeights_[alphaSWeightsIndices_[0]];
-  else
-    weight = srcPdfWeights_[alphaSWeightsIndices_[1]];
-  double const scaledWeight = 1. + (weight - 1.) * alphaSVarScaleFactor_;
-  return scaledWeight;
+  node_.Evaluate();
+  return alphaSWeights_[(direction == Var::Up) ? 0 : 1];
 }
 
 
 double GenWeight::RelWeightMEScale(Var renorm, Var factor) const {
   if (not lheScaleWeightsPresent_)
     return 1.;
-  if (srcScaleWeights_.GetSize() < 9) {
-    HZZException exception;
-    exception << "Cannot access ME scale variations (weights with indices 0 "
-        << "to 8) because only " << srcScaleWeights_.GetSize()
-        << " weights are available.";
-    throw exception;
-  }
-  double const weight = srcScaleWeights_[meScaleIndices_.at({renorm, factor})];
-  return weight / srcScaleWeights_[4];
+
+  node_.Evaluate();
+  return meScaleWeights_[kMEScaleIndices_[int(renorm)][int(factor)]];
 }
 
 
@@ -165,30 +116,14 @@ double GenWeight::RelWeightPdf(Var direction) const {
   if (not pdfWeightsPresent_ or direction == Var::Nominal)
     return 1.;
 
-  double sumW = 0., sumW2 = 0.;
-  for (int i = pdfWeightsIndices_.first; i < pdfWeightsIndices_.second; ++i) {
-    double const w = srcPdfWeights_[i];
-    sumW += w;
-    sumW2 += w * w;
-  }
-  int const n = pdfWeightsIndices_.second - pdfWeightsIndices_.first;
-  double const meanWeight = sumW / n;
-  double const sumDiff2 = sumW2 - n * std::pow(meanWeight, 2);
-
-  double deltaWeight;
-  if (pdfVarType_ == PdfVarType::Hessian)
-    // Deviations from mean weight are summed up in quadrature
-    deltaWeight = std::sqrt(sumDiff2);
-  else
-    // Standard deviation of the weights
-    deltaWeight = std::sqrt(sumDiff2 / (n - 1));
+  node_.Evaluate();
 
   // When applying the variation, assume that the mean weight is 1. In practice,
   // it's very close to 1.
   if (direction == Var::Up)
-    return 1. + deltaWeight;
+    return 1. + pdfDeltaWeight_;
   else
-    return 1. - deltaWeight;
+    return 1. - pdfDeltaWeight_;
 }
 
 
@@ -205,19 +140,6 @@ void GenWeight::InitializeLheScale(Dataset &dataset) {
   auto const WGNode = dataset.Info().Parameters()["wgamma_lnugamma"];
   if (WGNode and not WGNode.IsNull())  // Also drop the LO case for consistency
     lheScaleWeightsPresent_ = false;
-
-  // Set up the mapping between the ME scale variations and indices in the
-  // vector of weights. The convention for the weights is extracted from [1].
-  // [1] https://cms-nanoaod-integration.web.cern.ch/integration/master-102X/mc80X_doc.html#LHEScaleWeight
-  meScaleIndices_[{Var::Down, Var::Down}] = 0;
-  meScaleIndices_[{Var::Down, Var::Nominal}] = 1;
-  meScaleIndices_[{Var::Down, Var::Up}] = 2;
-  meScaleIndices_[{Var::Nominal, Var::Down}] = 3;
-  meScaleIndices_[{Var::Nominal, Var::Nominal}] = 4;
-  meScaleIndices_[{Var::Nominal, Var::Up}] = 5;
-  meScaleIndices_[{Var::Up, Var::Down}] = 6;
-  meScaleIndices_[{Var::Up, Var::Nominal}] = 7;
-  meScaleIndices_[{Var::Up, Var::Up}] = 8;
 }
 
 
@@ -336,3 +258,98 @@ GenWeight::LookUpPdfSet(int lhapdf) {
 
   return {pdfVarType, alphaSVarIndices, alphaSVarSize};
 }
+
+
+std::pair<double, double> GenWeight::SumWeights(
+    float const *weights, int size) {
+  constexpr int numLanes = 4;
+  std::array<double, numLanes> sumW{}, sumW2{};
+  int i = 0;
+
+  for (; i + numLanes <= size; i += numLanes) {
+    for (int k = 0; k < numLanes; ++k) {
+      double const w = weights[i + k];
+      sumW[k] += w;
+      sumW2[k] += w * w;
+    }
+  }
+
+  for (; i < size; ++i) {
+    double const w = weights[i];
+    sumW[0] += w;
+    sumW2[0] += w * w;
+  }
+
+  return {(sumW[0] + sumW[1]) + (sumW[2] + sumW[3]),
+          (sumW2[0] + sumW2[1]) + (sumW2[2] + sumW2[3])};
+}
+
+
+void GenWeight::Update() const {
+  if (lheScaleWeightsPresent_) {
+    auto const weights = srcScaleWeights_.View();
+
+    if (weights.size() < 9) {
+      HZZException exception;
+      exception << "Cannot access ME scale variations (weights with indices 0 "
+          << "to 8) because only " << weights.size()
+          << " weights are available.";
+      throw exception;
+    }
+
+    double const nominalWeight = weights[4];
+    for (int i = 0; i < 9; ++i)
+      meScaleWeights_[i] = weights[i] / nominalWeight;
+  } else
+    meScaleWeights_.fill(1.);
+
+  pdfDeltaWeight_ = 0.;
+  alphaSWeights_ = {1., 1.};
+
+  if (pdfWeightsPresent_) {
+    auto const weights = srcPdfWeights_.View();
+    int const n = pdfWeightsIndices_.second - pdfWeightsIndices_.first;
+    auto const [sumW, sumW2] = SumWeights(
+        weights.data() + pdfWeightsIndices_.first, n);
+    double const meanWeight = sumW / n;
+    double const sumDiff2 = sumW2 - n * std::pow(meanWeight, 2);
+
+    if (pdfVarType_ == PdfVarType::Hessian)
+      // Deviations from mean weight are summed up in quadrature
+      pdfDeltaWeight_ = std::sqrt(sumDiff2);
+    else
+      // Standard deviation of the weights
+      pdfDeltaWeight_ = std::sqrt(sumDiff2 / (n - 1));
+
+    if (alphaSWeightsPresent_) {
+      for (int i = 0; i < 2; ++i) {
+        double const weight = weights[alphaSWeightsIndices_[i]];
+        alphaSWeights_[i] = 1. + (weight - 1.) * alphaSVarScaleFactor_;
+      }
+    }
+  }
+
+  // Relative weights for the standard interface, in the order documented in
+  // RelWeight
+  relWeights_.clear();
+
+  if (lheScaleWeightsPresent_) {
+    for (auto const &[renorm, factor] : {
+        std::make_pair(Var::Up, Var::Nominal),
+        std::make_pair(Var::Down, Var::Nominal),
+        std::make_pair(Var::Nominal, Var::Up),
+        std::make_pair(Var::Nominal, Var::Down)})
+      relWeights_.push_back(
+          meScaleWeights_[kMEScaleIndices_[int(renorm)][int(factor)]]);
+  }
+
+  if (pdfWeightsPresent_) {
+    relWeights_.push_back(1. + pdfDeltaWeight_);
+    relWeights_.push_back(1. - pdfDeltaWeight_);
+  }
+
+  if (alphaSWeightsPresent_) {
+    relWeights_.push_back(alphaSWeights_[0]);
+    relWeights_.push_back(alphaSWeights_[1]);
+  }
+}
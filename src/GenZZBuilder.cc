@@ -14,8 +14,8 @@ GenZZBuilder::GenZZBuilder(Dataset &dataset)
       srcMass_{dataset.Reader(), "LHEPart_mass"} {}
 
 
-TLorentzVector GenZZBuilder::P4ZZ() const {
-  TLorentzVector sumP4;
+FourMomentum GenZZBuilder::P4ZZ() const {
+  FourMomentum sumP4;
   int numLeptons = 0;
 
   for (int i = 0; i < int(srcPdgId_.GetSize()); ++i) {
@@ -25,7 +25,7 @@ TLorentzVector GenZZBuilder::P4ZZ() const {
     if (absPdgId < 11 or absPdgId > 18)
       continue;
 
-    TLorentzVector p4;
+    FourMomentum p4;
     p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], srcMass_[i]);
     sumP4 += p4;
     ++numLeptons;
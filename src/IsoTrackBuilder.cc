@@ -8,7 +8,7 @@
 
 
 IsoTrackBuilder::IsoTrackBuilder(Dataset &dataset, Options const &)
-    : CollectionBuilder{dataset.Reader()},
+    : CollectionBuilder{dataset, "IsoTrackBuilder"},
       minLepPt_{5.}, minHadPt_{10.},
       srcPt_{dataset.Reader(), "IsoTrack_pt"},
       srcEta_{dataset.Reader(), "IsoTrack_eta"},
@@ -29,6 +29,10 @@ std::vector<IsoTrack> const &IsoTrackBuilder::Get() const {
 void IsoTrackBuilder::Build() const {
   IsoTracks_.clear();
 
+  // Angular cleaning, performed for all IsoTracks at once
+  cleaningMask_.Reset(srcPt_.GetSize());
+  RejectDuplicates({srcEta_.View(), srcPhi_.View()}, 0.3, cleaningMask_);
+
   // Selection follows: https://indico.cern.ch/event/885275/contributions/3757314/
   for (unsigned i = 0; i < srcPt_.GetSize(); ++i) {
     //std::cout<<"isotrk No."<<i<< " pt="<<srcPt_[i]<<" eta="<<srcEta_[i]<<" phi="<<srcPhi_[i]<<" pdgID="<<srcPdgId_[i]<<std::endl;
@@ -52,8 +56,7 @@ void IsoTrackBuilder::Build() const {
     IsoTrack isotrk;
     isotrk.p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], 0.);
 
-    // Perform angular cleaning
-    if (IsDuplicate(isotrk.p4, 0.3))
+    if (not cleaningMask_[i])
       continue;
 
     IsoTracks_.emplace_back(isotrk);
@@ -395,6 +395,47 @@ std::vector<float> FactorizedJetCorrector::getSubCorrections()
   return factors; 
 }
 //------------------------------------------------------------------------ 
+//--- Returns the subcorrections for a collection of jets ----------------
+//------------------------------------------------------------------------
+void FactorizedJetCorrector::getSubCorrections(unsigned fN, const float* fJetPt, const float* fJetEta,
+                                               const float* fJetA, float fRho, float* fSubCorrections,
+                                               unsigned fNLevels)
+{
+  if (fNLevels > mLevels.size())
+    handleError("FactorizedJetCorrector","too many levels requested");
+  // The buffer only grows, so there is no allocation in a steady state
+  if (mBatchPt.size() < fN)
+    mBatchPt.resize(fN);
+  float* pt = mBatchPt.data();
+  for(unsigned j=0;j<fN;j++)
+    pt[j] = fJetPt[j];
+  for(unsigned int i=0;i<fNLevels;i++)
+    {
+      const std::vector<VarTypes>& binTypes = mBinTypes[i];
+      const std::vector<VarTypes>& parTypes = mParTypes[i];
+      if (binTypes.size() > 4 || parTypes.size() > 4)
+        handleError("FactorizedJetCorrector","too many variables for the batch interface");
+      float* scale = fSubCorrections + i*fN;
+      for(unsigned j=0;j<fN;j++)
+        {
+          float x[4], y[4];
+          fillArray(binTypes,pt[j],fJetEta[j],fJetA[j],fRho,x);
+          fillArray(parTypes,pt[j],fJetEta[j],fJetA[j],fRho,y);
+          scale[j] = mCorrectors[i]->correction(x,binTypes.size(),y,parTypes.size());
+        }
+      // Rescale pt for the next level and accumulate the factors. These loops
+      // are kept free of calls so that they can be vectorized.
+      for(unsigned j=0;j<fN;j++)
+        pt[j] *= scale[j];
+      if (i > 0)
+        {
+          const float* prev = fSubCorrections + (i-1)*fN;
+          for(unsigned j=0;j<fN;j++)
+            scale[j] *= prev[j];
+        }
+    }
+}
+//------------------------------------------------------------------------ 
 //--- Reads the parameter names and fills a vector of floats -------------
 //------------------------------------------------------------------------
 std::vector<float> FactorizedJetCorrector::fillVector(std::vector<VarTypes> fVarTypes)
@@ -473,6 +514,29 @@ std::vector<float> FactorizedJetCorrector::fillVector(std::vector<VarTypes> fVar
   return result;      
 }
 //------------------------------------------------------------------------ 
+//--- Fills an array of variables for the batch interface ----------------
+//------------------------------------------------------------------------
+void FactorizedJetCorrector::fillArray(const std::vector<VarTypes>& fVarTypes, float fJetPt, float fJetEta,
+                                       float fJetA, float fRho, float* fX) const
+{
+  for(unsigned i=0;i<fVarTypes.size();i++)
+    {
+      switch (fVarTypes[i])
+        {
+          case kJetPt:  fX[i] = fJetPt;  break;
+          case kJetEta: fX[i] = fJetEta; break;
+          case kJetA:   fX[i] = fJetA;   break;
+          case kRho:    fX[i] = fRho;    break;
+          default:
+            {
+              std::stringstream sserr; 
+              sserr<<"parameter "<<fVarTypes[i]<<" is not supported by the batch interface";
+              handleError("FactorizedJetCorrector",sserr.str());
+            }
+        }
+    }
+}
+//------------------------------------------------------------------------ 
 //--- Calculate the lepPt (needed for the SLB) ---------------------------
 //------------------------------------------------------------------------
 float FactorizedJetCorrector::getLepPt() const
@@ -35,6 +35,15 @@ class FactorizedJetCorrector
     void setAddLepToJet (bool fAddLepToJet);
     float getCorrection();
     std::vector<float> getSubCorrections();
+    //---- Batch interface: sub-corrections for all fN jets of an event. Only
+    //---- JetPt, JetEta, JetA, and Rho can be used as variables. Only the
+    //---- first fNLevels levels are evaluated. The result for level i and
+    //---- jet j is written to fSubCorrections[i*fN+j], so the output array
+    //---- must hold fNLevels*fN numbers.
+    void getSubCorrections(unsigned fN, const float* fJetPt, const float* fJetEta,
+                           const float* fJetA, float fRho, float* fSubCorrections,
+                           unsigned fNLevels);
+    unsigned nLevels() const {return mLevels.size();}
     
        
   private:
@@ -50,6 +59,8 @@ class FactorizedJetCorrector
     void initCorrectors(const std::string& fLevels, const std::string& fFiles, const std::string& fOptions);
     void checkConsistency(const std::vector<std::string>& fLevels, const std::vector<std::string>& fTags);
     std::vector<float> fillVector(std::vector<VarTypes> fVarTypes);
+    void fillArray(const std::vector<VarTypes>& fVarTypes, float fJetPt, float fJetEta,
+                   float fJetA, float fRho, float* fX) const;
     std::vector<VarTypes> mapping(const std::vector<std::string>& fNames);
     //---- Member Data ---------
     int   mNPV;
@@ -83,5 +94,6 @@ class FactorizedJetCorrector
     std::vector<std::vector<float> > vvx; // MV
     std::vector<std::vector<float> > vvy; // MV
     std::vector<float> factors; // MV
+    std::vector<float> mBatchPt; // jet pt after each level in the batch interface
 };
 #endif
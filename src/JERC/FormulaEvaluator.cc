@@ -0,0 +1,349 @@
+#include "FormulaEvaluator.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+  using Instruction = FormulaEvaluator::Instruction;
+  using OpCode      = FormulaEvaluator::OpCode;
+
+  //----------------------------------------------------------------------
+  //--- Functions known to the parser ------------------------------------
+  //----------------------------------------------------------------------
+  struct Function
+  {
+    const char* name;
+    OpCode      op;
+    unsigned    arity;
+  };
+
+  const Function kFunctions[] =
+  {
+    {"exp",   OpCode::Exp,   1}, {"TMath::Exp",   OpCode::Exp,   1},
+    {"log",   OpCode::Log,   1}, {"TMath::Log",   OpCode::Log,   1},
+    {"log10", OpCode::Log10, 1}, {"TMath::Log10", OpCode::Log10, 1},
+    {"sqrt",  OpCode::Sqrt,  1}, {"TMath::Sqrt",  OpCode::Sqrt,  1},
+    {"abs",   OpCode::Abs,   1}, {"TMath::Abs",   OpCode::Abs,   1},
+    {"fabs",  OpCode::Abs,   1},
+    {"sin",   OpCode::Sin,   1}, {"TMath::Sin",   OpCode::Sin,   1},
+    {"cos",   OpCode::Cos,   1}, {"TMath::Cos",   OpCode::Cos,   1},
+    {"tan",   OpCode::Tan,   1}, {"TMath::Tan",   OpCode::Tan,   1},
+    {"atan",  OpCode::Atan,  1}, {"TMath::ATan",  OpCode::Atan,  1},
+    {"tanh",  OpCode::Tanh,  1}, {"TMath::TanH",  OpCode::Tanh,  1},
+    {"erf",   OpCode::Erf,   1}, {"TMath::Erf",   OpCode::Erf,   1},
+    {"pow",   OpCode::Pow,   2}, {"TMath::Power", OpCode::Pow,   2},
+    {"max",   OpCode::Max,   2}, {"TMath::Max",   OpCode::Max,   2},
+    {"min",   OpCode::Min,   2}, {"TMath::Min",   OpCode::Min,   2},
+    {"atan2", OpCode::Atan2, 2}, {"TMath::ATan2", OpCode::Atan2, 2}
+  };
+
+  //----------------------------------------------------------------------
+  //--- runs a sequence of instructions and returns the top of the stack -
+  //----------------------------------------------------------------------
+  inline double run(const Instruction* fBegin, const Instruction* fEnd,
+                    const double* fX, const float* fPar)
+  {
+    double stack[FormulaEvaluator::kMaxStackSize];
+    unsigned n = 0;
+    for (const Instruction* ins = fBegin; ins != fEnd; ++ins)
+      {
+        switch (ins->op)
+          {
+            case OpCode::Const:     stack[n++] = ins->value;      break;
+            case OpCode::Var:       stack[n++] = fX[ins->index];   break;
+            case OpCode::Par:       stack[n++] = fPar[ins->index]; break;
+            case OpCode::Add:       --n; stack[n-1] += stack[n];   break;
+            case OpCode::Sub:       --n; stack[n-1] -= stack[n];   break;
+            case OpCode::Mul:       --n; stack[n-1] *= stack[n];   break;
+            case OpCode::Div:       --n; stack[n-1] /= stack[n];   break;
+            case OpCode::Pow:       --n; stack[n-1] = std::pow(stack[n-1], stack[n]);     break;
+            case OpCode::Less:      --n; stack[n-1] = (stack[n-1] <  stack[n]) ? 1. : 0.; break;
+            case OpCode::LessEq:    --n; stack[n-1] = (stack[n-1] <= stack[n]) ? 1. : 0.; break;
+            case OpCode::Greater:   --n; stack[n-1] = (stack[n-1] >  stack[n]) ? 1. : 0.; break;
+            case OpCode::GreaterEq: --n; stack[n-1] = (stack[n-1] >= stack[n]) ? 1. : 0.; break;
+            case OpCode::Equal:     --n; stack[n-1] = (stack[n-1] == stack[n]) ? 1. : 0.; break;
+            case OpCode::NotEqual:  --n; stack[n-1] = (stack[n-1] != stack[n]) ? 1. : 0.; break;
+            // Same conventions as in TMath::Max and TMath::Min
+            case OpCode::Max:       --n; stack[n-1] = (stack[n-1] >= stack[n]) ? stack[n-1] : stack[n]; break;
+            case OpCode::Min:       --n; stack[n-1] = (stack[n-1] <= stack[n]) ? stack[n-1] : stack[n]; break;
+            case OpCode::Atan2:     --n; stack[n-1] = std::atan2(stack[n-1], stack[n]);   break;
+            case OpCode::Neg:       stack[n-1] = -stack[n-1];            break;
+            case OpCode::Exp:       stack[n-1] = std::exp(stack[n-1]);   break;
+            case OpCode::Log:       stack[n-1] = std::log(stack[n-1]);   break;
+            case OpCode::Log10:     stack[n-1] = std::log10(stack[n-1]); break;
+            case OpCode::Sqrt:      stack[n-1] = std::sqrt(stack[n-1]);  break;
+            case OpCode::Abs:       stack[n-1] = std::abs(stack[n-1]);   break;
+            case OpCode::Sin:       stack[n-1] = std::sin(stack[n-1]);   break;
+            case OpCode::Cos:       stack[n-1] = std::cos(stack[n-1]);   break;
+            case OpCode::Tan:       stack[n-1] = std::tan(stack[n-1]);   break;
+            case OpCode::Atan:      stack[n-1] = std::atan(stack[n-1]);  break;
+            case OpCode::Tanh:      stack[n-1] = std::tanh(stack[n-1]);  break;
+            case OpCode::Erf:       stack[n-1] = std::erf(stack[n-1]);   break;
+          }
+      }
+    return stack[0];
+  }
+
+  //----------------------------------------------------------------------
+  //--- recursive descent parser that emits instructions in postfix order
+  //----------------------------------------------------------------------
+  class Parser
+  {
+    public:
+      Parser(const std::string& fFormula, std::vector<Instruction>& fCode)
+        : mFormula(fFormula), mCode(fCode), mPos(0), mNVariables(0), mNParameters(0) {}
+      void parse()
+      {
+        parseComparison();
+        if (peek() != '\0')
+          fail("unexpected character");
+      }
+      unsigned nVariables()  const {return mNVariables; }
+      unsigned nParameters() const {return mNParameters;}
+
+    private:
+      //-------- grammar rules, in order of increasing precedence ---------
+      void parseComparison()
+      {
+        parseSum();
+        while (true)
+          {
+            OpCode op;
+            if (accept("<="))      op = OpCode::LessEq;
+            else if (accept(">=")) op = OpCode::GreaterEq;
+            else if (accept("==")) op = OpCode::Equal;
+            else if (accept("!=")) op = OpCode::NotEqual;
+            else if (accept("<"))  op = OpCode::Less;
+            else if (accept(">"))  op = OpCode::Greater;
+            else return;
+            parseSum();
+            emitOp(op, 2);
+          }
+      }
+      void parseSum()
+      {
+        parseProduct();
+        while (true)
+          {
+            if (accept("+"))      {parseProduct(); emitOp(OpCode::Add, 2);}
+            else if (accept("-")) {parseProduct(); emitOp(OpCode::Sub, 2);}
+            else return;
+          }
+      }
+      void parseProduct()
+      {
+        parseUnary();
+        while (true)
+          {
+            if (accept("*"))      {parseUnary(); emitOp(OpCode::Mul, 2);}
+            else if (accept("/")) {parseUnary(); emitOp(OpCode::Div, 2);}
+            else return;
+          }
+      }
+      void parseUnary()
+      {
+        if (accept("-"))
+          {
+            parseUnary();
+            emitOp(OpCode::Neg, 1);
+          }
+        else if (accept("+"))
+          parseUnary();
+        else
+          parsePower();
+      }
+      void parsePower()
+      {
+        parsePrimary();
+        // Right-associative, binds tighter than the unary minus on its left
+        if (accept("^"))
+          {
+            parseUnary();
+            emitOp(OpCode::Pow, 2);
+          }
+      }
+      void parsePrimary()
+      {
+        char c = peek();
+        if (std::isdigit(c) || c == '.')
+          {
+            const char* begin = mFormula.c_str() + mPos;
+            char* end;
+            double value = std::strtod(begin, &end);
+            if (end == begin)
+              fail("can't convert token to number");
+            mPos += end - begin;
+            emit({OpCode::Const, 0, value});
+          }
+        else if (accept("["))
+          {
+            unsigned index = parseIndex();
+            if (!accept("]"))
+              fail("expected ']'");
+            mNParameters = std::max(mNParameters, index + 1);
+            emit({OpCode::Par, index, 0.});
+          }
+        else if (accept("("))
+          {
+            parseComparison();
+            if (!accept(")"))
+              fail("expected ')'");
+          }
+        else if (std::isalpha(c) || c == '_')
+          parseName();
+        else
+          fail("unexpected character");
+      }
+      void parseName()
+      {
+        size_t begin = mPos;
+        while (mPos < mFormula.size() && (std::isalnum(mFormula[mPos]) || mFormula[mPos] == '_' || mFormula[mPos] == ':'))
+          ++mPos;
+        std::string name = mFormula.substr(begin, mPos - begin);
+
+        if (accept("("))
+          {
+            if ((name == "TMath::Pi" || name == "pi") && accept(")"))
+              {
+                emit({OpCode::Const, 0, M_PI});
+                return;
+              }
+            const Function* function = nullptr;
+            for (const auto& f : kFunctions)
+              if (name == f.name)
+                function = &f;
+            if (!function)
+              fail("unknown function '" + name + "'");
+            for (unsigned i = 0; i < function->arity; ++i)
+              {
+                if (i > 0 && !accept(","))
+                  fail("expected ',' in arguments of '" + name + "'");
+                parseComparison();
+              }
+            if (!accept(")"))
+              fail("expected ')' after arguments of '" + name + "'");
+            emitOp(function->op, function->arity);
+            return;
+          }
+
+        if (name == "pi")
+          {
+            emit({OpCode::Const, 0, M_PI});
+            return;
+          }
+        static const char* variables[] = {"x", "y", "z", "t"};
+        for (unsigned i = 0; i < 4; ++i)
+          if (name == variables[i])
+            {
+              mNVariables = std::max(mNVariables, i + 1);
+              emit({OpCode::Var, i, 0.});
+              return;
+            }
+        fail("unknown variable '" + name + "'");
+      }
+      unsigned parseIndex()
+      {
+        if (!std::isdigit(peek()))
+          fail("expected parameter index");
+        unsigned index = 0;
+        while (mPos < mFormula.size() && std::isdigit(mFormula[mPos]))
+          index = 10 * index + (mFormula[mPos++] - '0');
+        return index;
+      }
+
+      //-------- emission of instructions ---------------------------------
+      void emit(const Instruction& fInstruction)
+      {
+        mCode.push_back(fInstruction);
+      }
+      //--- an operation whose operands are all constants is evaluated ----
+      //--- right away and replaced with its result ------------------------
+      void emitOp(OpCode fOp, unsigned fArity)
+      {
+        bool constant = (mCode.size() >= fArity);
+        for (unsigned i = 0; constant && i < fArity; ++i)
+          if (mCode[mCode.size() - 1 - i].op != OpCode::Const)
+            constant = false;
+        emit({fOp, 0, 0.});
+        if (constant)
+          {
+            auto begin = mCode.end() - fArity - 1;
+            double value = run(&*begin, &*begin + fArity + 1, nullptr, nullptr);
+            mCode.erase(begin, mCode.end());
+            emit({OpCode::Const, 0, value});
+          }
+      }
+
+      //-------- tokenization ----------------------------------------------
+      char peek()
+      {
+        while (mPos < mFormula.size() && std::isspace(mFormula[mPos]))
+          ++mPos;
+        return (mPos < mFormula.size()) ? mFormula[mPos] : '\0';
+      }
+      bool accept(const char* fToken)
+      {
+        peek();
+        size_t n = std::strlen(fToken);
+        if (mFormula.compare(mPos, n, fToken) != 0)
+          return false;
+        mPos += n;
+        return true;
+      }
+      void fail(const std::string& fMessage)
+      {
+        std::stringstream sserr;
+        sserr<<"(formula "<<mFormula<<", position "<<mPos<<"): "<<fMessage;
+        handleError("FormulaEvaluator",sserr.str());
+      }
+
+      //-------- Member variables -----------
+      const std::string&        mFormula;
+      std::vector<Instruction>& mCode;
+      size_t                    mPos;
+      unsigned                  mNVariables;
+      unsigned                  mNParameters;
+  };
+}
+
+//------------------------------------------------------------------------
+//--- FormulaEvaluator constructor ---------------------------------------
+//--- compiles the formula -----------------------------------------------
+//------------------------------------------------------------------------
+FormulaEvaluator::FormulaEvaluator(const std::string& fFormula)
+  : mFormula(fFormula)
+{
+  Parser parser(mFormula, mCode);
+  parser.parse();
+  mNVariables  = parser.nVariables();
+  mNParameters = parser.nParameters();
+
+  unsigned depth = 0, maxDepth = 0;
+  for (const auto& ins : mCode)
+    {
+      if (ins.op == OpCode::Const || ins.op == OpCode::Var || ins.op == OpCode::Par)
+        ++depth;
+      else if (ins.op < OpCode::Neg || (ins.op > OpCode::Neg && ins.op <= OpCode::Atan2))
+        --depth;
+      maxDepth = std::max(maxDepth, depth);
+    }
+  if (maxDepth > kMaxStackSize)
+    {
+      std::stringstream sserr;
+      sserr<<"(formula "<<mFormula<<"): nesting is too deep";
+      handleError("FormulaEvaluator",sserr.str());
+    }
+}
+//------------------------------------------------------------------------
+//--- evaluates the formula ----------------------------------------------
+//--- fX must contain nVariables() values and fPar nParameters() values --
+//------------------------------------------------------------------------
+double FormulaEvaluator::evaluate(const double* fX, const float* fPar) const
+{
+  return run(mCode.data(), mCode.data() + mCode.size(), fX, fPar);
+}
@@ -0,0 +1,57 @@
+#ifndef FormulaEvaluator_h
+#define FormulaEvaluator_h
+
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+//--- Compiled evaluator for formulas in JEC and JER text files ----------
+//--- Replaces TFormula. The formula is parsed once into a sequence of ---
+//--- instructions for a small stack machine, with constant parts -------
+//--- folded at this point. Evaluation does not allocate memory. --------
+//---
+//--- Supported grammar: numbers; variables x, y, z, t; parameters [i]; -
+//--- operators + - * / ^ and comparisons < <= > >= == !=, which give --
+//--- 0 or 1; functions exp, log, log10, sqrt, abs, fabs, pow, max, min, -
+//--- sin, cos, tan, atan, atan2, tanh, erf, and their TMath versions ---
+//--- (e.g. TMath::Log, TMath::Power). --------------------------------------
+//------------------------------------------------------------------------
+class FormulaEvaluator
+{
+ public:
+  //-------- Constructors --------------
+  FormulaEvaluator(const std::string& fFormula);
+  //-------- Member functions -----------
+  double evaluate(const double* fX, const float* fPar) const;
+  unsigned nVariables()           const {return mNVariables; }
+  unsigned nParameters()          const {return mNParameters;}
+  const std::string& formula()    const {return mFormula;    }
+
+  //-------- Instructions of the stack machine ----------
+  enum class OpCode : unsigned char
+  {
+    Const, Var, Par,
+    Add, Sub, Mul, Div, Pow, Neg,
+    Less, LessEq, Greater, GreaterEq, Equal, NotEqual,
+    Max, Min, Atan2,
+    Exp, Log, Log10, Sqrt, Abs, Sin, Cos, Tan, Atan, Tanh, Erf
+  };
+  struct Instruction
+  {
+    OpCode   op;
+    unsigned index;
+    double   value;
+  };
+
+  //-------- Maximal depth of the evaluation stack ----------
+  static constexpr unsigned kMaxStackSize = 32;
+
+ private:
+  //-------- Member variables -----------
+  std::string              mFormula;
+  std::vector<Instruction> mCode;
+  unsigned                 mNVariables;
+  unsigned                 mNParameters;
+};
+
+#endif
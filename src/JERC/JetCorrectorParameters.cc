@@ -163,20 +163,206 @@ JetCorrectorParameters::JetCorrectorParameters(const std::string& fFile, const s
     }
   std::sort(mRecords.begin(), mRecords.end());
   valid_ = true;
+  buildIndex();
+}
+//------------------------------------------------------------------------
+//--- builds the bin index and precomputes neighbours and sizes ----------
+//--- binIndex, neighbourBin, and size(fVar) are evaluated for each jet, --
+//--- so the linear scans over all records are done here only once -------
+//------------------------------------------------------------------------
+void JetCorrectorParameters::buildIndex()
+{
+  unsigned N = mDefinitions.nBinVar();
+  mIndexNodes.clear();
+  mNeighbours.clear();
+  mSizes.clear();
+  mIndexValid = false;
+  if (N == 0 || mRecords.empty())
+    return;
+  // A placeholder record without parameters is added when no records are
+  // found. It doesn't define bins, so the linear scans are kept in this case.
+  for (unsigned i = 0; i < size(); ++i)
+    if (record(i).nParameters() == 0)
+      return;
+
+  std::vector<unsigned> all(size());
+  for (unsigned i = 0; i < size(); ++i)
+    all[i] = i;
+  mIndexValid = buildIndexNode(all, 0);
+  if (!mIndexValid)
+    mIndexNodes.clear();
+
+  for (unsigned j = 0; j < N; ++j)
+    mSizes.push_back(sizeLinear(j));
+
+  // The neighbour must share the lower edges in all other variables and
+  // touch the given bin along fVar. With a valid index it is found by a
+  // lookup just outside the given bin, and then verified with the same
+  // criteria as in the linear scan. Only if the verification fails, the
+  // full scan is performed.
+  mNeighbours.resize(size() * N * 2, -1);
+  std::vector<float> x(N);
+  for (unsigned i = 0; i < size(); ++i)
+    for (unsigned j = 0; j < N; ++j)
+      for (unsigned next = 0; next < 2; ++next)
+        {
+          int result = -1;
+          bool found = false;
+          if (mIndexValid)
+            {
+              for (unsigned k = 0; k < N; ++k)
+                x[k] = record(i).xMiddle(k);
+              x[j] = (next) ? record(i).xMax(j) :
+                std::nextafter(record(i).xMin(j), -INFINITY);
+              int candidate = binIndex(x);
+              if (candidate >= 0)
+                {
+                  found = true;
+                  for (unsigned k = 0; k < N; ++k)
+                    if (k != j && fabs(record(candidate).xMin(k)-record(i).xMin(k)) >= 0.0001)
+                      found = false;
+                  if (next && fabs(record(candidate).xMin(j)-record(i).xMax(j)) >= 0.0001)
+                    found = false;
+                  if (!next && fabs(record(candidate).xMax(j)-record(i).xMin(j)) >= 0.0001)
+                    found = false;
+                  if (found)
+                    result = candidate;
+                }
+            }
+          if (!found)
+            result = neighbourBinLinear(i, j, next);
+          mNeighbours[(i * N + j) * 2 + next] = result;
+        }
+}
+//------------------------------------------------------------------------
+//--- adds a node of the index for the given records along fVar ----------
+//--- returns false if bins along fVar overlap ---------------------------
+//------------------------------------------------------------------------
+bool JetCorrectorParameters::buildIndexNode(std::vector<unsigned> fRecords, unsigned fVar)
+{
+  unsigned N = mDefinitions.nBinVar();
+  std::stable_sort(fRecords.begin(), fRecords.end(),
+    [this, fVar](unsigned a, unsigned b)
+      {
+        if (record(a).xMin(fVar) != record(b).xMin(fVar))
+          return record(a).xMin(fVar) < record(b).xMin(fVar);
+        return record(a).xMax(fVar) < record(b).xMax(fVar);
+      });
+
+  unsigned node = mIndexNodes.size();
+  mIndexNodes.emplace_back();
+  unsigned begin = 0;
+  while (begin < fRecords.size())
+    {
+      float xMin = record(fRecords[begin]).xMin(fVar);
+      float xMax = record(fRecords[begin]).xMax(fVar);
+      unsigned end = begin + 1;
+      while (end < fRecords.size() && record(fRecords[end]).xMin(fVar) == xMin
+             && record(fRecords[end]).xMax(fVar) == xMax)
+        ++end;
+
+      // Overlapping bins cannot be resolved with a binary search
+      if (!mIndexNodes[node].mMax.empty() && xMin < mIndexNodes[node].mMax.back())
+        return false;
+      // Bins that are never matched in the linear scan are skipped
+      if (!(xMin < xMax))
+        {
+          begin = end;
+          continue;
+        }
+
+      unsigned child;
+      if (fVar + 1 == N)
+        // The linear scan returns the first record among identical ones
+        child = *std::min_element(fRecords.begin() + begin, fRecords.begin() + end);
+      else
+        {
+          child = mIndexNodes.size();
+          if (!buildIndexNode(std::vector<unsigned>(fRecords.begin() + begin, fRecords.begin() + end), fVar + 1))
+            return false;
+        }
+      // Access via the index as the vector of nodes may have been reallocated
+      mIndexNodes[node].mMin.push_back(xMin);
+      mIndexNodes[node].mMax.push_back(xMax);
+      mIndexNodes[node].mChild.push_back(child);
+      begin = end;
+    }
+  return true;
 }
 //------------------------------------------------------------------------
 //--- returns the index of the record defined by fX ----------------------
+//--- uses a binary search along each axis in the bin index --------------
 //------------------------------------------------------------------------
 int JetCorrectorParameters::binIndex(const std::vector<float>& fX) const 
 {
-  int result = -1;
+  return binIndex(fX.data(), fX.size());
+}
+//------------------------------------------------------------------------
+//--- same as above for an array of fN bin variables ---------------------
+//------------------------------------------------------------------------
+int JetCorrectorParameters::binIndex(const float* fX, unsigned fN) const 
+{
   unsigned N = mDefinitions.nBinVar();
-  if (N != fX.size()) 
+  if (N != fN) 
     {
       std::stringstream sserr; 
-      sserr<<"# bin variables "<<N<<" doesn't correspont to requested #: "<<fX.size();
+      sserr<<"# bin variables "<<N<<" doesn't correspont to requested #: "<<fN;
       handleError("JetCorrectorParameters",sserr.str());
     }
+  if (!mIndexValid)
+    return binIndexLinear(fX);
+  unsigned node = 0;
+  for (unsigned j = 0; j < N; ++j)
+    {
+      const IndexNode& n = mIndexNodes[node];
+      auto it = std::upper_bound(n.mMin.begin(), n.mMin.end(), fX[j]);
+      if (it == n.mMin.begin())
+        return -1;
+      unsigned k = it - n.mMin.begin() - 1;
+      if (!(fX[j] < n.mMax[k]))
+        return -1;
+      node = n.mChild[k];
+    }
+  return node;
+}
+//------------------------------------------------------------------------
+//--- returns the neighbouring bins of fIndex in the direction of fVar ---
+//------------------------------------------------------------------------
+int JetCorrectorParameters::neighbourBin(unsigned fIndex, unsigned fVar, bool fNext) const 
+{
+  unsigned N = mDefinitions.nBinVar();
+  if (fVar >= N) 
+    {
+      std::stringstream sserr; 
+      sserr<<"# of bin variables "<<N<<" doesn't correspond to requested #: "<<fVar;
+      handleError("JetCorrectorParameters",sserr.str()); 
+    }
+  if (mNeighbours.empty())
+    return neighbourBinLinear(fIndex, fVar, fNext);
+  return mNeighbours[(fIndex * N + fVar) * 2 + (fNext ? 1 : 0)];
+}
+//------------------------------------------------------------------------
+//--- returns the number of bins in the direction of fVar ----------------
+//------------------------------------------------------------------------
+unsigned JetCorrectorParameters::size(unsigned fVar) const
+{
+  if (fVar >= mDefinitions.nBinVar()) 
+    { 
+      std::stringstream sserr; 
+      sserr<<"requested bin variable index "<<fVar<<" is greater than number of variables "<<mDefinitions.nBinVar();
+      handleError("JetCorrectorParameters",sserr.str()); 
+    }    
+  if (mSizes.empty())
+    return sizeLinear(fVar);
+  return mSizes[fVar];
+}
+//------------------------------------------------------------------------
+//--- linear scan for the record defined by fX, used if bins overlap -----
+//------------------------------------------------------------------------
+int JetCorrectorParameters::binIndexLinear(const float* fX) const 
+{
+  int result = -1;
+  unsigned N = mDefinitions.nBinVar();
   unsigned tmp;
   for (unsigned i = 0; i < size(); ++i) 
     {
@@ -193,9 +379,9 @@ int JetCorrectorParameters::binIndex(const std::vector<float>& fX) const
   return result;
 }
 //------------------------------------------------------------------------
-//--- returns the neighbouring bins of fIndex in the direction of fVar ---
+//--- linear scan for the neighbouring bin, used when building the index -
 //------------------------------------------------------------------------
-int JetCorrectorParameters::neighbourBin(unsigned fIndex, unsigned fVar, bool fNext) const 
+int JetCorrectorParameters::neighbourBinLinear(unsigned fIndex, unsigned fVar, bool fNext) const 
 {
   int result = -1;
   unsigned N = mDefinitions.nBinVar();
@@ -235,9 +421,9 @@ int JetCorrectorParameters::neighbourBin(unsigned fIndex, unsigned fVar, bool fN
   return result;
 }
 //------------------------------------------------------------------------
-//--- returns the number of bins in the direction of fVar ----------------
+//--- counts the bins in the direction of fVar, used to build the index ---
 //------------------------------------------------------------------------
-unsigned JetCorrectorParameters::size(unsigned fVar) const
+unsigned JetCorrectorParameters::sizeLinear(unsigned fVar) const
 {
   if (fVar >= mDefinitions.nBinVar()) 
     { 
@@ -61,6 +61,7 @@ class JetCorrectorParameters
         float xMiddle(unsigned fVar)        const {return 0.5*(xMin(fVar)+xMax(fVar));}
         float parameter(unsigned fIndex)    const {return mParameters[fIndex];        }
         std::vector<float> parameters()     const {return mParameters;                }
+        const std::vector<float>& parametersRef() const {return mParameters;          }
         unsigned nParameters()              const {return mParameters.size();         }
         int operator< (const Record& other) const {return xMin(0) < other.xMin(0);    }
       private:
@@ -72,17 +73,18 @@ class JetCorrectorParameters
     };
      
     //-------- Constructors --------------
-    JetCorrectorParameters() { valid_ = false;}
+    JetCorrectorParameters() { valid_ = false; mIndexValid = false;}
     JetCorrectorParameters(const std::string& fFile, const std::string& fSection = "");
     JetCorrectorParameters(const JetCorrectorParameters::Definitions& fDefinitions,
 			 const std::vector<JetCorrectorParameters::Record>& fRecords) 
-      : mDefinitions(fDefinitions),mRecords(fRecords) { valid_ = true;}
+      : mDefinitions(fDefinitions),mRecords(fRecords) { valid_ = true; buildIndex();}
     //-------- Member functions ----------
     const Record& record(unsigned fBin)                          const {return mRecords[fBin]; }
     const Definitions& definitions()                             const {return mDefinitions;   }
     unsigned size()                                              const {return mRecords.size();}
     unsigned size(unsigned fVar)                                 const;
     int binIndex(const std::vector<float>& fX)                   const;
+    int binIndex(const float* fX, unsigned fN)                   const;
     int neighbourBin(unsigned fIndex, unsigned fVar, bool fNext) const;
     std::vector<float> binCenters(unsigned fVar)                 const;
     void printScreen()                                           const;
@@ -90,10 +92,31 @@ class JetCorrectorParameters
     bool isValid() const { return valid_; }
 
   private:
+    //-------- Bin index -----------------
+    //-- One node per axis and per bin in the preceding axes. Bins of the
+    //-- node are sorted in their lower edges and do not overlap. On the
+    //-- last axis the children are indices of records, on other axes they
+    //-- are indices of nodes for the next axis.
+    struct IndexNode
+    {
+      std::vector<float>    mMin;
+      std::vector<float>    mMax;
+      std::vector<unsigned> mChild;
+    };
+    //-------- Member functions ----------
+    void buildIndex();
+    bool buildIndexNode(std::vector<unsigned> fRecords, unsigned fVar);
+    int  binIndexLinear(const float* fX)                            const;
+    int  neighbourBinLinear(unsigned fIndex, unsigned fVar, bool fNext) const;
+    unsigned sizeLinear(unsigned fVar)                              const;
     //-------- Member variables ----------
     JetCorrectorParameters::Definitions         mDefinitions;
     std::vector<JetCorrectorParameters::Record> mRecords;
     bool                                        valid_; /// is this a valid set?
+    std::vector<IndexNode>                      mIndexNodes; /// index for binIndex
+    bool                                        mIndexValid; /// false if bins overlap
+    std::vector<int>                            mNeighbours; /// [(bin*nvar+var)*2+next]
+    std::vector<unsigned>                       mSizes;      /// size(fVar) for each axis
 };
 
 
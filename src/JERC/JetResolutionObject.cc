@@ -195,7 +195,7 @@ namespace JME {
 #ifndef STANDALONE
             m_formula = std::make_shared<reco::FormulaEvaluator>(m_formula_str);
 #else
-            m_formula = std::make_shared<TFormula>("jet_resolution_formula", m_formula_str.c_str());
+            m_formula = std::make_shared<FormulaEvaluator>(m_formula_str);
 #endif
          else
           m_parameters_name = getTokens(m_formula_str);
@@ -408,11 +408,10 @@ namespace JME {
 #ifndef STANDALONE
         const auto* formula = m_definition.getFormula();
 #else
-        // Set parameters
-        auto const* pFormula = m_definition.getFormula();
-        if (! pFormula)
+        // The formula is shared and evaluated in place, without copies
+        auto const* formula = m_definition.getFormula();
+        if (! formula)
             return 1;
-        auto formula = *pFormula;
 #endif
         // Create vector of variables value. Throw if some values are missing
         std::vector<float> variables = variables_parameters.createVector(m_definition.getVariables());
@@ -431,11 +430,10 @@ namespace JME {
             reco::formula::ArrayAdaptor(parametersD.data(),parametersD.size())
         );
 #else
-        for (size_t index = 0; index < parameters.size(); index++) {
-            formula.SetParameter(index, parameters[index]);
-        }
+        if (parameters.size() < formula->nParameters())
+            throwException(edm::errors::NotFound, "The formula requires " + std::to_string(formula->nParameters()) + " parameters, but only " + std::to_string(parameters.size()) + " are available");
 
-        return formula.EvalPar(variables_);
+        return formula->evaluate(variables_, parameters.data());
 #endif
     }
 }
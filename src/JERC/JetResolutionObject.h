@@ -24,7 +24,7 @@
 #ifndef STANDALONE
 #include "CommonTools/Utils/interface/FormulaEvaluator.h"
 #else
-#include <TFormula.h>
+#include "FormulaEvaluator.h"
 #endif
 
 enum class Variation {
@@ -200,7 +200,7 @@ namespace JME {
                         return m_formula.get();
                     }
 #else
-                    TFormula const * getFormula() const {
+                    FormulaEvaluator const * getFormula() const {
                         return m_formula.get();
                     }
 #endif
@@ -214,7 +214,7 @@ namespace JME {
 #ifndef STANDALONE
                     std::shared_ptr<reco::FormulaEvaluator> m_formula COND_TRANSIENT;
 #else
-                    std::shared_ptr<TFormula> m_formula COND_TRANSIENT;
+                    std::shared_ptr<FormulaEvaluator> m_formula COND_TRANSIENT;
 #endif
                     std::vector<Binning> m_bins COND_TRANSIENT;
                     std::vector<Binning> m_variables COND_TRANSIENT;
@@ -1,4 +1,5 @@
 #include "SimpleJetCorrector.h"
+#include "FormulaEvaluator.h"
 #include "JetCorrectorParameters.h"
 #include "Utilities.h"
 #include <iostream>
@@ -10,7 +11,7 @@
 //------------------------------------------------------------------------
 SimpleJetCorrector::SimpleJetCorrector() 
 { 
-  mFunc            = new TFormula(); 
+  mFunc            = nullptr; 
   mParameters      = new JetCorrectorParameters();
   mDoInterpolation = false;
   mInvertVar       = 9999;
@@ -22,8 +23,9 @@ SimpleJetCorrector::SimpleJetCorrector()
 SimpleJetCorrector::SimpleJetCorrector(const std::string& fDataFile, const std::string& fOption) 
 {
   mParameters      = new JetCorrectorParameters(fDataFile,fOption);
-  mFunc            = new TFormula("function",((mParameters->definitions()).formula()).c_str());
+  mFunc            = new FormulaEvaluator((mParameters->definitions()).formula());
   mDoInterpolation = false;
+  checkParameters();
   if (mParameters->definitions().isResponse())
     mInvertVar = findInvertVar(); 
 }
@@ -34,8 +36,9 @@ SimpleJetCorrector::SimpleJetCorrector(const std::string& fDataFile, const std::
 SimpleJetCorrector::SimpleJetCorrector(const JetCorrectorParameters& fParameters)
 {
   mParameters      = new JetCorrectorParameters(fParameters);
-  mFunc            = new TFormula("function",((mParameters->definitions()).formula()).c_str());
+  mFunc            = new FormulaEvaluator((mParameters->definitions()).formula());
   mDoInterpolation = false;
+  checkParameters();
   if (mParameters->definitions().isResponse())
     mInvertVar = findInvertVar();
 }
@@ -51,15 +54,22 @@ SimpleJetCorrector::~SimpleJetCorrector()
 //--- calculates the correction ------------------------------------------
 //------------------------------------------------------------------------
 float SimpleJetCorrector::correction(const std::vector<float>& fX,const std::vector<float>& fY) const 
+{
+  return correction(fX.data(),fX.size(),fY.data(),fY.size());
+}
+//------------------------------------------------------------------------ 
+//--- same as above for arrays of bin variables and parameters -----------
+//------------------------------------------------------------------------
+float SimpleJetCorrector::correction(const float* fX, unsigned fNX, const float* fY, unsigned fNY) const 
 {
   float result = 1.;
   float tmp    = 0.0;
   float cor    = 0.0;
-  int bin = mParameters->binIndex(fX);
+  int bin = mParameters->binIndex(fX,fNX);
   if (bin<0) 
     return result;
   if (!mDoInterpolation)
-    result = correctionBin(bin,fY);
+    result = correctionBin(bin,fY,fNY);
   else
     { 
       for(unsigned i=0;i<mParameters->definitions().nBinVar();i++)
@@ -73,15 +83,15 @@ float SimpleJetCorrector::correction(const std::vector<float>& fX,const std::vec
               xMiddle[0] = mParameters->record(prevBin).xMiddle(i);
               xMiddle[1] = mParameters->record(bin).xMiddle(i);
               xMiddle[2] = mParameters->record(nextBin).xMiddle(i);
-              xValue[0]  = correctionBin(prevBin,fY);
-              xValue[1]  = correctionBin(bin,fY);
-              xValue[2]  = correctionBin(nextBin,fY);
+              xValue[0]  = correctionBin(prevBin,fY,fNY);
+              xValue[1]  = correctionBin(bin,fY,fNY);
+              xValue[2]  = correctionBin(nextBin,fY,fNY);
               cor = quadraticInterpolation(fX[i],xMiddle,xValue);
               tmp+=cor;
             }
           else
             {
-              cor = correctionBin(bin,fY);
+              cor = correctionBin(bin,fY,fNY);
               tmp+=cor;
             }
         }
@@ -92,7 +102,7 @@ float SimpleJetCorrector::correction(const std::vector<float>& fX,const std::vec
 //------------------------------------------------------------------------ 
 //--- calculates the correction for a specific bin -----------------------
 //------------------------------------------------------------------------
-float SimpleJetCorrector::correctionBin(unsigned fBin,const std::vector<float>& fY) const 
+float SimpleJetCorrector::correctionBin(unsigned fBin,const float* fY,unsigned N) const 
 {
   if (fBin >= mParameters->size()) 
     {
@@ -100,7 +110,6 @@ float SimpleJetCorrector::correctionBin(unsigned fBin,const std::vector<float>&
       sserr<<"wrong bin: "<<fBin<<": only "<<mParameters->size()<<" available!";
       handleError("SimpleJetCorrector",sserr.str());
     }
-  unsigned N = fY.size();
   if (N > 4)
     {
       std::stringstream sserr;
@@ -108,22 +117,20 @@ float SimpleJetCorrector::correctionBin(unsigned fBin,const std::vector<float>&
       handleError("SimpleJetCorrector",sserr.str());
     } 
   float result = -1;
-  const std::vector<float>& par = mParameters->record(fBin).parameters();
-  for(unsigned int i=2*N;i<par.size();i++)
-    mFunc->SetParameter(i-2*N,par[i]);
-  float x[4];
-  //std::vector<float> tmp;
-  std::vector<float> tmp(4); // MV
+  // Avoid copying the parameters of the record. Formula parameters follow
+  // the ranges of the N variables.
+  const std::vector<float>& par = mParameters->record(fBin).parametersRef();
+  double x[4] = {0.0,0.0,0.0,0.0};
+  float xf[4] = {0.0,0.0,0.0,0.0};
   for(unsigned i=0;i<N;i++)
     {
-      x[i] = (fY[i] < par[2*i]) ? par[2*i] : (fY[i] > par[2*i+1]) ? par[2*i+1] : fY[i];
-      //tmp.push_back(x[i]);
-      tmp[i] = x[i]; // MV
+      xf[i] = (fY[i] < par[2*i]) ? par[2*i] : (fY[i] > par[2*i+1]) ? par[2*i+1] : fY[i];
+      x[i] = xf[i];
     }
   if (mParameters->definitions().isResponse())
-    result = invert(tmp);
+    result = invert(xf,N,&par[2*N]);
   else
-    result = mFunc->Eval(x[0],x[1],x[2],x[3]);  
+    result = mFunc->evaluate(x,&par[2*N]);
   return result;
 }
 //------------------------------------------------------------------------ 
@@ -144,22 +151,43 @@ unsigned SimpleJetCorrector::findInvertVar()
   return result;
 }
 //------------------------------------------------------------------------ 
+//--- checks that every record provides all parameters of the formula ----
+//------------------------------------------------------------------------
+void SimpleJetCorrector::checkParameters() const
+{
+  unsigned N = mParameters->definitions().nParVar();
+  for(unsigned i=0;i<mParameters->size();i++)
+    {
+      if (mParameters->record(i).nParameters() == 0)
+        continue;
+      if (mParameters->record(i).nParameters() < 2*N + mFunc->nParameters())
+        {
+          std::stringstream sserr;
+          sserr<<"record "<<i<<" provides "<<mParameters->record(i).nParameters()
+               <<" numbers, but "<<2*N + mFunc->nParameters()<<" are needed";
+          handleError("SimpleJetCorrector",sserr.str());
+        }
+    }
+}
+//------------------------------------------------------------------------ 
 //--- inversion ----------------------------------------------------------
 //------------------------------------------------------------------------
-float SimpleJetCorrector::invert(std::vector<float> fX) const
+float SimpleJetCorrector::invert(const float* fX, unsigned N, const float* fPar) const
 {
   unsigned nMax = 50;
-  unsigned N = fX.size();
   float precision = 0.0001;
   float rsp = 1.0;
   float e = 1.0;
   float x[4] = {0.0,0.0,0.0,0.0};
+  double xd[4] = {0.0,0.0,0.0,0.0};
   for(unsigned i=0;i<N;i++)
     x[i] = fX[i]; 
   unsigned nLoop=0;
   while(e > precision && nLoop < nMax) 
     {
-      rsp = mFunc->Eval(x[0],x[1],x[2],x[3]);
+      for(unsigned i=0;i<N;i++)
+        xd[i] = x[i];
+      rsp = mFunc->evaluate(xd,fPar);
       float tmp = x[mInvertVar] * rsp;
       e = fabs(tmp - fX[mInvertVar])/fX[mInvertVar];
       x[mInvertVar] = fX[mInvertVar]/rsp;
@@ -4,9 +4,7 @@
 #include <string>
 #include <vector>
 
-#include <TFormula.h>
-
-
+class FormulaEvaluator;
 class JetCorrectorParameters;
 
 class SimpleJetCorrector 
@@ -21,19 +19,21 @@ class SimpleJetCorrector
   //-------- Member functions -----------
   void   setInterpolation(bool fInterpolation) {mDoInterpolation = fInterpolation;}
   float  correction(const std::vector<float>& fX,const std::vector<float>& fY) const;  
+  float  correction(const float* fX, unsigned fNX, const float* fY, unsigned fNY) const;
   const  JetCorrectorParameters& parameters() const {return *mParameters;} 
 
  private:
   //-------- Member functions -----------
   SimpleJetCorrector(const SimpleJetCorrector&);
   SimpleJetCorrector& operator= (const SimpleJetCorrector&);
-  float    invert(std::vector<float> fX) const;
-  float    correctionBin(unsigned fBin,const std::vector<float>& fY) const;
+  float    invert(const float* fX, unsigned N, const float* fPar) const;
+  float    correctionBin(unsigned fBin,const float* fY,unsigned N) const;
   unsigned findInvertVar();
+  void     checkParameters() const;
   //-------- Member variables -----------
   bool                    mDoInterpolation;
   unsigned                mInvertVar; 
-  TFormula*               mFunc;
+  FormulaEvaluator*       mFunc;
   JetCorrectorParameters* mParameters;
 };
 
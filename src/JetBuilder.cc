@@ -9,13 +9,18 @@
 
 
 JetBuilder::JetBuilder(
-    Dataset &dataset, Options const &options, TabulatedRngEngine &rngEngine,
-    PileUpIdFilter const *pileUpIdFilter)
-    : CollectionBuilder{dataset.Reader()},
+    Dataset &dataset, Options const &options, RngEngine &rngEngine,
+    ShapeSyst const &shapeSyst, PileUpIdFilter const *pileUpIdFilter)
+    : CollectionBuilder{dataset, "JetBuilder"},
       genJetBuilder_{nullptr}, pileUpIdFilter_{pileUpIdFilter},
       minPtType1Corr_{15.}, ptMissEeNoise_{false}, ptMissPogJets_{false},
+      shapeSyst_{shapeSyst},
+      jets_(shapeSyst.NumVariations()),
+      lowptJets_(shapeSyst.NumVariations()),
+      rejectedJets_(shapeSyst.NumVariations()),
+      sumP4Shifts_(shapeSyst.NumVariations()),
       isSim_{dataset.Info().IsSimulation()},
-      jetCorrector_{dataset, options, rngEngine},
+      jetCorrector_{dataset, options, rngEngine, shapeSyst},
       srcPt_{dataset.Reader(), "Jet_pt"},
       srcEta_{dataset.Reader(), "Jet_eta"},
       srcPhi_{dataset.Reader(), "Jet_phi"},
@@ -29,7 +34,7 @@ JetBuilder::JetBuilder(
         options.GetConfig(), {"b_tagger", "branch_name"})).c_str()},
       srcId_{dataset.Reader(), "Jet_jetId"},
       srcPileUpId_{dataset.Reader(), "Jet_puId"},
-      puRho_{dataset.Reader(), "fixedGridRhoFastjetAll"},
+      puRho_{dataset, "fixedGridRhoFastjetAll"},
       softRawPt_{dataset.Reader(), "CorrT1METJet_rawPt"},
       softEta_{dataset.Reader(), "CorrT1METJet_eta"},
       softPhi_{dataset.Reader(), "CorrT1METJet_phi"},
@@ -70,28 +75,36 @@ JetBuilder::JetBuilder(
 
 std::vector<Jet> const &JetBuilder::Get() const {
   Update();
-  return jets_;
+  return jets_[shapeSyst_.GetCurrentIndex()];
 }
 
 
 std::vector<Jet> const &JetBuilder::GetRejected() const {
   Update();
-  return rejectedJets_;
+  return rejectedJets_[shapeSyst_.GetCurrentIndex()];
 }
 
 std::vector<Jet> const &JetBuilder::GetLowPt() const {
   Update();
-  return lowptJets_;
+  return lowptJets_[shapeSyst_.GetCurrentIndex()];
+}
+
+
+JetBuilder::Momentum const &JetBuilder::GetSumMomentumShift() const {
+  Update();
+  return sumP4Shifts_[shapeSyst_.GetCurrentIndex()];
 }
 
 void JetBuilder::SetGenJetBuilder(GenJetBuilder const *genJetBuilder) {
-  if (isSim_)
+  if (isSim_) {
     genJetBuilder_ = genJetBuilder;
+    GetNode().AddInput(genJetBuilder->GetNode());
+  }
 }
 
 
 void JetBuilder::AddType1Correction(
-    TLorentzVector const &rawP4, double area,
+    int variation, FourMomentum const &rawP4, double jecL1,
     double jecOrig, double jecNew, double jerFactor,
     double emFraction, double muonFraction) const {
   // If jets are to be treated as in the standard type 1 correction [1], skip
@@ -116,10 +129,11 @@ void JetBuilder::AddType1Correction(
     isEeNoise = (rawP4.Pt() < 50. and absEta > 2.65 and absEta < 3.139);
   }
 
+  auto &sumP4Shift = sumP4Shifts_[variation];
+
   // The normal type 1 correction for jets not affected by the EE noise
-  double const jecL1 = jetCorrector_.GetJecL1(rawP4, area);
   if (not isEeNoise and rawP4.Pt() * corrFactorNew * rescale > minPtType1Corr_)
-    AddMomentumShift(rawP4 * jecL1 * rescale, rawP4 * corrFactorNew * rescale);
+    sumP4Shift += rawP4 * corrFactorNew * rescale - rawP4 * jecL1 * rescale;
 
   // If the EE noise mitigation is enabled, the computation starts from an
   // adjusted ptmiss instead of the raw one, and some of the contributions in it
@@ -136,13 +150,22 @@ void JetBuilder::AddType1Correction(
     double const rescale = 1. - muonFraction;
 
     if (rawP4.Pt() * jecOrig * rescale > minPtType1Corr_)
-      AddMomentumShift(rawP4 * jecL1 * rescale, rawP4 * jecOrig * rescale);
+      sumP4Shift += rawP4 * jecOrig * rescale - rawP4 * jecL1 * rescale;
   }
 }
 
 
 void JetBuilder::Build() const {
+  for (auto &sumP4Shift : sumP4Shifts_)
+    sumP4Shift = Momentum{};
+
   jetCorrector_.UpdateIov();
+  ComputeJec();
+
+  // Random numbers for the stochastic JER smearing of all jets and soft jets
+  if (isSim_)
+    jetCorrector_.GetJerRandomNumbers(
+        int(srcPt_.GetSize() + softRawPt_.GetSize()), jerRandomNumbers_);
   ProcessJets();
 
   // Soft jets not included into the main collection contribute to the type 1
@@ -151,7 +174,7 @@ void JetBuilder::Build() const {
 }
 
 
-GenJet const *JetBuilder::FindGenMatch(TLorentzVector const &p4,
+GenJet const *JetBuilder::FindGenMatch(FourMomentum const &p4,
                                        double ptResolution) const {
   if (not genJetBuilder_)
     return nullptr;
@@ -178,91 +201,154 @@ GenJet const *JetBuilder::FindGenMatch(TLorentzVector const &p4,
 }
 
 
-double JetBuilder::GetJerFactor(
-    TLorentzVector const &corrP4, int rngChannel) const {
+void JetBuilder::ComputeJec() const {
+  // The nominal full JEC for the main jets is given by the raw factor stored in
+  // the input, so only the L1 level needs to be evaluated for them
+  int const numJets = srcPt_.GetSize();
+  jecRawPt_.resize(numJets);
+  jecEta_.resize(numJets);
+  jecArea_.resize(numJets);
+
+  for (int i = 0; i < numJets; ++i) {
+    jecRawPt_[i] = srcPt_[i] * (1. - srcRawFactor_[i]);
+    jecEta_[i] = srcEta_[i];
+    jecArea_[i] = srcArea_[i];
+  }
+
+  jetCorrector_.GetJecL1(jecRawPt_, jecEta_, jecArea_, jecL1_);
+
+  int const numSoftJets = softRawPt_.GetSize();
+  jecRawPt_.resize(numSoftJets);
+  jecEta_.resize(numSoftJets);
+  jecArea_.resize(numSoftJets);
+
+  for (int i = 0; i < numSoftJets; ++i) {
+    jecRawPt_[i] = softRawPt_[i];
+    jecEta_[i] = softEta_[i];
+    jecArea_[i] = softArea_[i];
+  }
+
+  jetCorrector_.GetJec(
+      jecRawPt_, jecEta_, jecArea_, softJecL1_, softJecFull_);
+}
+
+
+void JetBuilder::ComputeVariedFactors(
+    FourMomentum const &corrP4, int jetIndex, bool withJer) const {
+  int const numVariations = shapeSyst_.NumVariations();
+  if (not isSim_) {
+    jecUncFactors_.assign(numVariations, 1.);
+    jerFactors_.assign(numVariations, 1.);
+    return;
+  }
+
+  jetCorrector_.GetJecUncFactors(corrP4, jecUncFactors_);
+  if (withJer)
+    GetJerFactors(corrP4, jetIndex, jerFactors_);
+  else
+    jerFactors_.assign(numVariations, 1.);
+}
+
+
+void JetBuilder::GetJerFactors(
+    FourMomentum const &corrP4, int jetIndex,
+    std::vector<double> &factors) const {
   double const ptResolution = jetCorrector_.GetPtResolution(corrP4);
   GenJet const *genJet = FindGenMatch(corrP4, ptResolution);
-  return jetCorrector_.GetJerFactor(
-      corrP4, genJet, ptResolution, rngChannel);
+  jetCorrector_.GetJerFactors(
+      corrP4, genJet, ptResolution, jerRandomNumbers_[jetIndex], factors);
 }
 
 
 void JetBuilder::ProcessJets() const {
-  jets_.clear();
-  lowptJets_.clear();
-  rejectedJets_.clear();
+  int const numVariations = shapeSyst_.NumVariations();
+  for (int v = 0; v < numVariations; ++v) {
+    jets_[v].clear();
+    lowptJets_[v].clear();
+    rejectedJets_[v].clear();
+  }
+
+  KinematicColumns const columns{
+      srcPt_.View(), srcEta_.View(), srcPhi_.View(), srcMass_.View()};
 
- for (unsigned i = 0; i < srcPt_.GetSize(); ++i) {
+  // Jet ID and the requirement on pseudorapidity are not affected by the
+  // rescaling of the momentum, so they are checked only once for all variations
+  // and all jets at once
+  int const jetIdMask = 1 << jetIdBit_;
+  double const maxAbsEta = maxAbsEta_;
+  mask_.Reset(columns.size());
+  mask_.Require(srcId_.View(), [=](int id){return (id & jetIdMask) != 0;})
+      .Require(columns.eta, [=](float eta){
+        return not (std::abs(eta) > maxAbsEta);
+      });
+
+  // The angular cleaning is not affected by the rescaling either
+  RejectDuplicates(columns.Directions(), 0.4, mask_);
+
+  for (unsigned i = 0; i < columns.size(); ++i) {
     Jet jet;
-    jet.p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], srcMass_[i]);
+    jet.p4 = columns.Momentum(i);
 
     double const jecNominal = 1. / (1 - srcRawFactor_[i]);
-    TLorentzVector const rawP4 = jet.p4  * (1. / jecNominal);
-    double jecUncFactor = 1., jerFactor = 1.;
-    if (isSim_) {
-      jecUncFactor = jetCorrector_.GetJecUncFactor(jet.p4);
-      jerFactor = GetJerFactor(jet.p4, i);
-    }
-    jet.p4 *= jecUncFactor * jerFactor;
+    FourMomentum const rawP4 = jet.p4  * (1. / jecNominal);
+    ComputeVariedFactors(jet.p4, i, true);
 
-    AddType1Correction(
-        rawP4, srcArea_[i], jecNominal, jecNominal * jecUncFactor, jerFactor,
-        srcChEmEF_[i] + srcNeEmEF_[i], srcMuonFraction_[i]);
+    double const jecL1 = jecL1_[i];
+    for (int v = 0; v < numVariations; ++v)
+      AddType1Correction(
+          v, rawP4, jecL1, jecNominal, jecNominal * jecUncFactors_[v],
+          jerFactors_[v], srcChEmEF_[i] + srcNeEmEF_[i], srcMuonFraction_[i]);
 
-    // Kinematical cuts and ID selection for jets to be stored in the collection
-    if (not (srcId_[i] & 1 << jetIdBit_))
-      continue;
-    if (std::abs(jet.p4.Eta()) > maxAbsEta_)
-      continue;
-
-    // Perform angular cleaning
-    if (IsDuplicate(jet.p4, 0.4))
+    // Selection for jets to be stored in the collection
+    if (not mask_[i])
       continue;
 
     jet.bTag = srcBTag_[i];
     if (isSim_)
       jet.SetFlavours(srcHadronFlavour_->At(i), srcPartonFlavour_->At(i));
 
-    bool const puIdAccepted = SetPileUpInfo(jet, i);
-    if(jet.p4.Pt() > minPt_)
-    {	
-      if (puIdAccepted)
-        jets_.emplace_back(jet);
-      else
-        rejectedJets_.emplace_back(jet);
+    for (int v = 0; v < numVariations; ++v) {
+      Jet variedJet{jet};
+      variedJet.p4 *= jecUncFactors_[v] * jerFactors_[v];
+
+      bool const puIdAccepted = SetPileUpInfo(variedJet, i);
+      if (variedJet.p4.Pt() > minPt_) {
+        if (puIdAccepted)
+          jets_[v].emplace_back(variedJet);
+        else
+          rejectedJets_[v].emplace_back(variedJet);
+      }
+      else if (variedJet.p4.Pt() > 20.0 && variedJet.p4.Pt() < minPt_)
+        lowptJets_[v].emplace_back(variedJet);
     }
-    else if (jet.p4.Pt() > 20.0 && jet.p4.Pt() < minPt_)
-      lowptJets_.emplace_back(jet);
   }
 
   // Make sure jets are sorted in pt
-  std::sort(jets_.begin(), jets_.end(), PtOrdered);
-  std::sort(rejectedJets_.begin(), rejectedJets_.end(), PtOrdered);
-  std::sort(lowptJets_.begin(), lowptJets_.end(), PtOrdered);
+  for (int v = 0; v < numVariations; ++v) {
+    std::sort(jets_[v].begin(), jets_[v].end(), PtOrdered);
+    std::sort(rejectedJets_[v].begin(), rejectedJets_[v].end(), PtOrdered);
+    std::sort(lowptJets_[v].begin(), lowptJets_[v].end(), PtOrdered);
+  }
 }
 
 
 void JetBuilder::ProcessSoftJets() const {
+  int const numJets = srcPt_.GetSize();
   for (int i = 0; i < int(softRawPt_.GetSize()); ++i) {
     // Jet energy is not stored, but it's not used for missing pt. Set the mass
     // to 0.
-    TLorentzVector rawP4;
+    FourMomentum rawP4;
     rawP4.SetPtEtaPhiM(softRawPt_[i], softEta_[i], softPhi_[i], 0.);
 
-    double const area = softArea_[i];
-    double const jecNominal = jetCorrector_.GetJecFull(rawP4, area);
-    double jecFull = jecNominal, jerFactor = 1.;
-
-    if (isSim_) {
-      TLorentzVector const corrP4{rawP4 * jecNominal};
-      jecFull *= jetCorrector_.GetJecUncFactor(corrP4);
-      if (ptMissJer_)
-        jerFactor = GetJerFactor(corrP4, srcPt_.GetSize() + i);
-    }
+    double const jecNominal = softJecFull_[i];
+    ComputeVariedFactors(rawP4 * jecNominal, numJets + i, ptMissJer_);
 
-    AddType1Correction(
-        rawP4, area, jecNominal, jecFull, jerFactor,
-        0. /* EM fractions are not stored */, softMuonFraction_[i]);
+    double const jecL1 = softJecL1_[i];
+    for (int v = 0; v < shapeSyst_.NumVariations(); ++v)
+      AddType1Correction(
+          v, rawP4, jecL1, jecNominal, jecNominal * jecUncFactors_[v],
+          jerFactors_[v], 0. /* EM fractions are not stored */,
+          softMuonFraction_[i]);
   }
 }
 
@@ -1,7 +1,10 @@
 #include <JetCorrector.h>
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <limits>
+#include <optional>
 #include <string>
 
 #include <FileInPath.h>
@@ -14,13 +17,14 @@
 
 
 JetCorrector::JetCorrector(Dataset &dataset, Options const &options,
-                           TabulatedRngEngine &rngEngine)
-    : syst_{Syst::None},
+                           RngEngine &rngEngine,
+                           ShapeSyst const &shapeSyst)
+    : shapeSyst_{shapeSyst},
       minPtClip_{1e-3},
       currentIov_{nullptr}, cachedRun_{0},
-      tabulatedRng_{rngEngine, 50},
-      run_{dataset.Reader(), "run"},
-      rho_{dataset.Reader(), "fixedGridRhoFastjetAll"} {
+      rng_{rngEngine, 50},
+      run_{dataset, "run"},
+      rho_{dataset, "fixedGridRhoFastjetAll"} {
 
   bool const isSim = dataset.Info().IsSimulation();
 
@@ -40,30 +44,15 @@ JetCorrector::JetCorrector(Dataset &dataset, Options const &options,
             options.GetConfig(),
             {"jets", "resolution", "scale_factors"}))));
 
-    std::string const systLabel{options.GetAs<std::string>("syst")};
-    if (systLabel == "jec_up") {
-      syst_ = Syst::JEC;
-      systDirection_ = SystDirection::Up;
-    } else if (systLabel == "jec_down") {
-      syst_ = Syst::JEC;
-      systDirection_ = SystDirection::Down;
-    } else if (systLabel == "jer_up") {
-      syst_ = Syst::JER;
-      systDirection_ = SystDirection::Up;
-    } else if (systLabel == "jer_down") {
-      syst_ = Syst::JER;
-      systDirection_ = SystDirection::Down;
-    }
-
-    if (syst_ == Syst::JEC)
+    if (shapeSyst_.HasJecVariation()) {
       jecUncProvider_.reset(new JetCorrectionUncertainty(FileInPath::Resolve(
           Options::NodeAs<std::string>(
               options.GetConfig(),
               {"jets", "corrections", "uncertainty"}))));
-
-    if (syst_ == Syst::JEC)
       LOG_DEBUG << "Will apply a variation in JEC.";
-    else if (syst_ == Syst::JER)
+    }
+
+    if (shapeSyst_.HasJerVariation())
       LOG_DEBUG << "Will apply a variation in JER.";
   }
 }
@@ -76,7 +65,7 @@ JetCorrector::~JetCorrector() noexcept {
 }
 
 
-double JetCorrector::GetJecFull(TLorentzVector const &rawP4,
+double JetCorrector::GetJecFull(FourMomentum const &rawP4,
                                 double area) const {
   jetEnergyCorrector_->setJetEta(rawP4.Eta());
   jetEnergyCorrector_->setJetPt(rawP4.Pt());
@@ -87,7 +76,7 @@ double JetCorrector::GetJecFull(TLorentzVector const &rawP4,
 }
 
 
-double JetCorrector::GetJecL1(TLorentzVector const &rawP4, double area) const {
+double JetCorrector::GetJecL1(FourMomentum const &rawP4, double area) const {
   jetEnergyCorrector_->setJetEta(rawP4.Eta());
   jetEnergyCorrector_->setJetPt(rawP4.Pt());
   jetEnergyCorrector_->setJetA(area);
@@ -97,58 +86,133 @@ double JetCorrector::GetJecL1(TLorentzVector const &rawP4, double area) const {
 }
 
 
-double JetCorrector::GetJecUncFactor(TLorentzVector const &corrP4) const {
-  if (syst_ != Syst::JEC)
-    return 1.;
+void JetCorrector::GetJec(
+    std::vector<float> const &rawPt, std::vector<float> const &eta,
+    std::vector<float> const &area, std::vector<double> &jecL1,
+    std::vector<double> &jecFull) const {
+  int const numJets = rawPt.size();
+  int const numLevels = jetEnergyCorrector_->nLevels();
+  jecL1.resize(numJets);
+  jecFull.resize(numJets);
+  if (numJets == 0)
+    return;
+
+  // The buffer never shrinks, so it stops reallocating after a few events
+  if (subCorrections_.size() < std::size_t(numLevels * numJets))
+    subCorrections_.resize(numLevels * numJets);
+  jetEnergyCorrector_->getSubCorrections(
+      numJets, rawPt.data(), eta.data(), area.data(), *rho_,
+      subCorrections_.data(), numLevels);
+
+  float const *l1 = subCorrections_.data();
+  float const *full = subCorrections_.data() + (numLevels - 1) * numJets;
+  for (int i = 0; i < numJets; ++i) {
+    jecL1[i] = ClipFactor(l1[i], rawPt[i]);
+    jecFull[i] = ClipFactor(full[i], rawPt[i]);
+  }
+}
 
-  jecUncProvider_->setJetEta(corrP4.Eta());
-  jecUncProvider_->setJetPt(corrP4.Pt());
-  double const uncertainty = jecUncProvider_->getUncertainty(true);
 
-  double factor;
-  if (systDirection_ == SystDirection::Up)
-    factor = 1. + uncertainty;
-  else
-    factor = 1. - uncertainty;
-  return ClipFactor(factor, corrP4.Pt());
+void JetCorrector::GetJecL1(
+    std::vector<float> const &rawPt, std::vector<float> const &eta,
+    std::vector<float> const &area, std::vector<double> &jecL1) const {
+  int const numJets = rawPt.size();
+  jecL1.resize(numJets);
+  if (numJets == 0)
+    return;
+
+  if (subCorrections_.size() < std::size_t(numJets))
+    subCorrections_.resize(numJets);
+  jetEnergyCorrector_->getSubCorrections(
+      numJets, rawPt.data(), eta.data(), area.data(), *rho_,
+      subCorrections_.data(), 1);
+
+  for (int i = 0; i < numJets; ++i)
+    jecL1[i] = ClipFactor(subCorrections_[i], rawPt[i]);
 }
 
 
-double JetCorrector::GetJerFactor(
-    TLorentzVector const &corrP4, GenJet const *genJet,
-    double ptResolution, int rngChannel) const {
-  // Find data-to-simulation scale factor
-  Variation jerDirection;
+void JetCorrector::GetJecUncFactors(FourMomentum const &corrP4,
+                                    std::vector<double> &factors) const {
+  factors.assign(shapeSyst_.NumVariations(), 1.);
+  if (not jecUncProvider_)
+    return;
 
-  if (syst_ == Syst::JER) {
-    if (systDirection_ == SystDirection::Up)
-      jerDirection = Variation::UP;
+  std::optional<double> uncertainty;
+
+  for (int i = 0; i < int(factors.size()); ++i) {
+    auto const variation = shapeSyst_.Get(i);
+    if (variation != ShapeSyst::Variation::kJecUp
+        and variation != ShapeSyst::Variation::kJecDown)
+      continue;
+
+    if (not uncertainty) {
+      jecUncProvider_->setJetEta(corrP4.Eta());
+      jecUncProvider_->setJetPt(corrP4.Pt());
+      uncertainty = jecUncProvider_->getUncertainty(true);
+    }
+
+    double const factor = (variation == ShapeSyst::Variation::kJecUp) ?
+        1. + *uncertainty : 1. - *uncertainty;
+    factors[i] = ClipFactor(factor, corrP4.Pt());
+  }
+}
+
+
+void JetCorrector::GetJerFactors(
+    FourMomentum const &corrP4, GenJet const *genJet,
+    double ptResolution, double randomNumber,
+    std::vector<double> &factors) const {
+  factors.resize(shapeSyst_.NumVariations());
+
+  // Data-to-simulation scale factors, indexed with the direction of the
+  // variation. They are only evaluated when needed.
+  std::array<std::optional<double>, 3> jerSFs;
+  double const randomShift = randomNumber * ptResolution;
+
+  for (int i = 0; i < int(factors.size()); ++i) {
+    Variation jerDirection;
+    switch (shapeSyst_.Get(i)) {
+      case ShapeSyst::Variation::kJerUp:
+        jerDirection = Variation::UP;
+        break;
+      case ShapeSyst::Variation::kJerDown:
+        jerDirection = Variation::DOWN;
+        break;
+      default:
+        jerDirection = Variation::NOMINAL;
+    }
+
+    auto &jerSF = jerSFs[int(jerDirection)];
+    if (not jerSF)
+      jerSF = jerSFProvider_->getScaleFactor(
+          {{JME::Binning::JetPt, corrP4.Pt()},
+           {JME::Binning::JetEta, corrP4.Eta()}},
+          jerDirection);
+
+    // Depending on the presence of a matching generator-level jet, perform
+    // deterministic or stochastic smearing [1]
+    // [1] https://twiki.cern.ch/twiki/bin/view/CMS/JetResolution?rev=71#Smearing_procedures
+    double jerFactor;
+    if (genJet)
+      jerFactor = 1.
+          + (*jerSF - 1.) * (corrP4.Pt() - genJet->p4.Pt()) / corrP4.Pt();
     else
-      jerDirection = Variation::DOWN;
-  } else
-    jerDirection = Variation::NOMINAL;
+      jerFactor = 1.
+          + randomShift * std::sqrt(std::max(std::pow(*jerSF, 2) - 1., 0.));
+    factors[i] = ClipFactor(jerFactor, corrP4.Pt());
+  }
+}
 
-  double const jerSF = jerSFProvider_->getScaleFactor(
-      {{JME::Binning::JetPt, corrP4.Pt()},
-       {JME::Binning::JetEta, corrP4.Eta()}},
-      jerDirection);
-
-  // Depending on the presence of a matching generator-level jet, perform
-  // deterministic or stochastic smearing [1]
-  // [1] https://twiki.cern.ch/twiki/bin/view/CMS/JetResolution?rev=71#Smearing_procedures
-  double jerFactor;
-  if (genJet)
-    jerFactor = 1.
-        + (jerSF - 1.) * (corrP4.Pt() - genJet->p4.Pt()) / corrP4.Pt();
-  else
-    jerFactor = 1.
-        + tabulatedRng_.Gaus(rngChannel, 0., ptResolution)
-        * std::sqrt(std::max(std::pow(jerSF, 2) - 1., 0.));
-  return ClipFactor(jerFactor, corrP4.Pt());
+
+void JetCorrector::GetJerRandomNumbers(
+    int numJets, std::vector<double> &values) const {
+  values.resize(numJets);
+  rng_.Gaus(0, numJets, values.data());
 }
 
 
-double JetCorrector::GetPtResolution(TLorentzVector const &corrP4) const {
+double JetCorrector::GetPtResolution(FourMomentum const &corrP4) const {
   // Relative jet pt resolution in simulation
   double const ptResolution = jerProvider_->getResolution(
       {{JME::Binning::JetPt, corrP4.Pt()},
@@ -8,11 +8,11 @@
 
 JetGeometricVeto::JetGeometricVeto(
     Dataset &dataset, Options const &options, JetBuilder const *jetBuilder,
-    TabulatedRngEngine &rngEngine)
+    RngEngine &rngEngine)
     : isSim_{dataset.Info().IsSimulation()},
       jetBuilder_{jetBuilder},
-      tabulatedRng_{rngEngine},
-      srcRun_{dataset.Reader(), "run"} {
+      rng_{rngEngine},
+      srcRun_{dataset, "run"} {
   YAML::Node const config = options.GetConfig()["jet_geometric_veto"];
   if (not config) {
     enabled_ = false;
@@ -89,7 +89,7 @@ bool JetGeometricVeto::operator()() const {
     return true;
 
   if (isSim_) {
-    if (tabulatedRng_.Rndm(0) > lumiFraction_)
+    if (rng_.Rndm(0) > lumiFraction_)
       return true;
   } else {
     int const run = *srcRun_;
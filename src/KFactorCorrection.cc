@@ -3,20 +3,16 @@
 #include <string>
 
 #include <FileInPath.h>
+#include <FourMomentum.h>
 #include <HZZException.h>
 #include <Logger.h>
 
 #include <TFile.h>
-#include <TLorentzVector.h>
 
 
-KFactorCorrection::KFactorCorrection(Dataset &dataset, Options const &)
-    : genPartPt_{dataset.Reader(), "GenPart_pt"},
-      genPartEta_{dataset.Reader(), "GenPart_eta"},
-      genPartPhi_{dataset.Reader(), "GenPart_phi"},
-      genPartMass_{dataset.Reader(), "GenPart_mass"},
-      genPartStatus_{dataset.Reader(), "GenPart_status"},
-      genPartStatusFlags_{dataset.Reader(), "GenPart_statusFlags"} {
+KFactorCorrection::KFactorCorrection(
+    Dataset &dataset, Options const &, GenParticleIndex const *genParticles)
+    : genParticles_{genParticles} {
 
   auto const settingsNode = dataset.Info().Parameters()["k_factor"];
 
@@ -47,20 +43,17 @@ KFactorCorrection::KFactorCorrection(Dataset &dataset, Options const &)
 
 double KFactorCorrection::HiggsMass() const {
   if (enabled_) {
-    TLorentzVector higgs;
+    FourMomentum higgs;
     int numberOfLepton = 0;
 
-    for (int i = 0; i < int(genPartPt_.GetSize()); i++) {
-      // Status: 1=stable
+    // Status: 1=stable
+    for (int i : genParticles_->WithStatus(1)) {
       // flags bits are: 0 : isPrompt, 8 : fromHardProcess
-      if (genPartStatus_[i] != 1 || (genPartStatusFlags_[i] & 1 << 0) == 0 ||
-          (genPartStatusFlags_[i] & 1 << 8) == 0 ) 
+      int const statusFlags = genParticles_->StatusFlags(i);
+      if ((statusFlags & 1 << 0) == 0 || (statusFlags & 1 << 8) == 0)
         continue;
 
-      TLorentzVector lepton;
-      lepton.SetPtEtaPhiM(genPartPt_[i], genPartEta_[i], genPartPhi_[i],
-        genPartMass_[i]);
-      higgs += lepton;
+      higgs += genParticles_->Momentum(i);
       numberOfLepton++;
     }
 
@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <boost/algorithm/string.hpp>
 
@@ -11,6 +12,7 @@
 #include <TFile.h>
 #include <yaml-cpp/yaml.h>
 
+#include <BinnedTable.h>
 #include <HZZException.h>
 #include <FileInPath.h>
 #include <Logger.h>
@@ -26,6 +28,8 @@
  * overflow bins in pt can be filled or be empty, which implies that values from
  * the last pt bins should be used. This class provides a consistent interface
  * to read values from the underlying histogram regardless of these aspects.
+ *
+ * The histogram is converted into a BinnedTable2D when loaded.
  */
 class PtEtaHistogram {
  public:
@@ -50,6 +54,19 @@ class PtEtaHistogram {
   /// Retrieves the value from the histogram for the given pt and eta
   double operator()(double pt, double eta) const;
 
+  /**
+   * \brief Multiplies given values by values from the histogram for an array of
+   * leptons
+   *
+   * \param[in] n  Number of leptons.
+   * \param[in] pt  Transverse momenta of the leptons.
+   * \param[in] eta  Pseudorapidities of the leptons.
+   * \param[in,out] product  Array of size \c n, each element of which is
+   *   multiplied by the value for the corresponding lepton.
+   */
+  void Multiply(std::size_t n, double const *pt, double const *eta,
+                double *product) const;
+
  private:
   /**
    * \brief Reads a histogram with given path and name
@@ -60,8 +77,18 @@ class PtEtaHistogram {
   static std::unique_ptr<TH2> ReadHistogram(std::string const &pathsWithNames,
                                             int efficiencyType);
 
-  /// Underlying histogram
-  std::unique_ptr<TH2> histogram_;
+  /**
+   * \brief Lookup table constructed from the underlying histogram
+   *
+   * Not set if the histogram does not exist for the requested efficiency type.
+   */
+  std::optional<BinnedTable2D> table_;
+
+  /// Path to the underlying histogram, for error reporting
+  std::string path_;
+
+  /// Buffers for coordinates and values in batch lookups
+  mutable std::vector<double> xBuffer_, yBuffer_, valueBuffer_;
 
   /// Ordering of dimensions in the underlying 2D histogram
   bool orderPtEta_;
@@ -89,7 +116,10 @@ PtEtaHistogram::PtEtaHistogram(YAML::Node const &config, int efficiencyType) {
         "Configuration for a lepton scale factor component does not contain "
         "mandatory parameter \"path\"."};
   auto const path = config["path"].as<std::string>();
-  histogram_ = ReadHistogram(path, efficiencyType);
+  path_ = path;
+  auto const histogram = ReadHistogram(path, efficiencyType);
+  if (histogram)
+    table_.emplace(*histogram);
 
   auto const &schemaNode = config["schema"];
   if (not schemaNode) {
@@ -138,16 +168,21 @@ PtEtaHistogram::PtEtaHistogram(YAML::Node const &config, int efficiencyType) {
 
   auto const &clipNode = config["clip_pt"];
   clipPt_ = (clipNode and clipNode.as<bool>());
-  if (clipPt_) {
-    if (orderPtEta_)
-      maxPt_ = histogram_->GetXaxis()->GetBinCenter(histogram_->GetNbinsX());
-    else
-      maxPt_ = histogram_->GetYaxis()->GetBinCenter(histogram_->GetNbinsY());
+  if (clipPt_ and table_) {
+    auto const &ptAxis = (orderPtEta_) ? table_->XAxis() : table_->YAxis();
+    maxPt_ = ptAxis.BinCenter(ptAxis.NumBins());
   }
 }
 
 
 double PtEtaHistogram::operator()(double pt, double eta) const {
+  if (not table_) {
+    HZZException exception;
+    exception << "Histogram \"" << path_ << "\" is not available for the "
+        << "requested efficiency type.";
+    throw exception;
+  }
+
   if (clipPt_ and pt > maxPt_)
     pt = maxPt_;
   if (useAbsEta_)
@@ -161,8 +196,34 @@ double PtEtaHistogram::operator()(double pt, double eta) const {
     x = eta;
     y = pt;
   }
-  auto const bin = histogram_->FindFixBin(x, y);
-  return histogram_->GetBinContent(bin);
+  return (*table_)(x, y);
+}
+
+
+void PtEtaHistogram::Multiply(std::size_t n, double const *pt,
+                              double const *eta, double *product) const {
+  if (n == 0)
+    return;
+  if (not table_) {
+    HZZException exception;
+    exception << "Histogram \"" << path_ << "\" is not available for the "
+        << "requested efficiency type.";
+    throw exception;
+  }
+
+  xBuffer_.resize(n);
+  yBuffer_.resize(n);
+  valueBuffer_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    double const clippedPt = (clipPt_ and pt[i] > maxPt_) ? maxPt_ : pt[i];
+    double const transEta = (useAbsEta_) ? std::abs(eta[i]) : eta[i];
+    xBuffer_[i] = (orderPtEta_) ? clippedPt : transEta;
+    yBuffer_[i] = (orderPtEta_) ? transEta : clippedPt;
+  }
+
+  table_->Lookup(n, xBuffer_.data(), yBuffer_.data(), valueBuffer_.data());
+  for (std::size_t i = 0; i < n; ++i)
+    product[i] *= valueBuffer_[i];
 }
 
 
@@ -205,7 +266,11 @@ LeptonWeight::LeptonWeight(Dataset &dataset, Options const &options,
                            ElectronBuilder const *electronBuilder,
                            MuonBuilder const *muonBuilder,
                            int efficiencyType)
-    : cache_{dataset.Reader()}, electronBuilder_{electronBuilder}, muonBuilder_{muonBuilder} {
+    : node_{dataset.Graph(), "LeptonWeight", [this]{Update();}},
+      electronBuilder_{electronBuilder}, muonBuilder_{muonBuilder} {
+  node_.AddInput(electronBuilder_->GetNode());
+  node_.AddInput(muonBuilder_->GetNode());
+
   // The default weight index is chosen based on the requested systematic
   // variation
   auto const systLabel = options.GetAs<std::string>("syst");
@@ -307,14 +372,51 @@ std::string_view LeptonWeight::VariationName(int variation) const {
 }
 
 void LeptonWeight::Update() const {
+  electronPt_.clear();
+  electronEta_.clear();
+  for (auto const &electron : electronBuilder_->GetTight()) {
+    electronPt_.emplace_back(electron.p4.Pt());
+    electronEta_.emplace_back(electron.etaSc);
+  }
+
+  muonPt_.clear();
+  muonEta_.clear();
+  for (auto const &muon : muonBuilder_->GetTight()) {
+    muonPt_.emplace_back(muon.uncorrP4.Pt());
+    muonEta_.emplace_back(muon.uncorrP4.Eta());
+  }
+
+  // Look up scale factors for all leptons at once. Each set of components is
+  // only evaluated once, even if it is shared between several variations.
+  auto const fillSFs = [](std::vector<PtEtaHistogram> const &components,
+                          std::vector<double> const &pt,
+                          std::vector<double> const &eta,
+                          std::vector<double> &sfs) {
+    sfs.assign(pt.size(), 1.);
+    for (auto const &component : components)
+      component.Multiply(pt.size(), pt.data(), eta.data(), sfs.data());
+  };
+  std::array<bool, 9> electronSFsFilled{}, muonSFsFilled{};
+
   for(int aSyst = 0 ; aSyst < NumVariations() + 1; aSyst++){
-  	double sf = 1.;
-    for (auto &electron : electronBuilder_->GetTight()) {
-      sf *= ElectronSF(electron, aSyst);
+    int const electronIndex = aSyst > 8 ? aSyst - 8 : 0;
+    int const muonIndex = aSyst <= 8 ? aSyst : 0;
+    if (not electronSFsFilled[electronIndex]) {
+      fillSFs(electronScaleFactors_[electronIndex], electronPt_, electronEta_,
+              electronSFs_[electronIndex]);
+      electronSFsFilled[electronIndex] = true;
     }
-    for (auto &muon : muonBuilder_->GetTight()) {
-      sf *= MuonSF(muon, aSyst);
+    if (not muonSFsFilled[muonIndex]) {
+      fillSFs(muonScaleFactors_[muonIndex], muonPt_, muonEta_,
+              muonSFs_[muonIndex]);
+      muonSFsFilled[muonIndex] = true;
     }
+
+  	double sf = 1.;
+    for (double const electronSF : electronSFs_[electronIndex])
+      sf *= electronSF;
+    for (double const muonSF : muonSFs_[muonIndex])
+      sf *= muonSF;
     weights_[aSyst] = sf;
   }
 }
@@ -0,0 +1,181 @@
+#include <MelaCache.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <HZZException.h>
+#include <Logger.h>
+
+
+MelaCache::MelaCache(std::filesystem::path const &path, uint64_t configHash)
+    : path_{path}, configHash_{configHash}, mapped_{path, configHash} {
+  LOG_DEBUG << "Using MELA cache " << path_ << " with "
+      << mapped_.end() - mapped_.begin() << " records.";
+}
+
+
+MelaCache::~MelaCache() noexcept {
+  try {
+    Save();
+  } catch (std::exception const &e) {
+    LOG_WARN << "Failed to update MELA cache " << path_ << ": " << e.what();
+  }
+}
+
+
+MelaCache::Values const *MelaCache::Find(
+    EventID const &id, uint64_t inputHash) const {
+  Key const key{id.run, id.lumi, id.event, inputHash};
+  auto const record = std::lower_bound(
+      mapped_.begin(), mapped_.end(), key,
+      [](Record const &r, Key const &k){return GetKey(r) < k;});
+
+  if (record != mapped_.end() and GetKey(*record) == key)
+    return &record->values;
+
+  auto const res = newRecords_.find(key);
+  if (res != newRecords_.end())
+    return &res->second;
+
+  return nullptr;
+}
+
+
+uint64_t MelaCache::Hash(void const *data, std::size_t size, uint64_t seed) {
+  auto const *bytes = static_cast<unsigned char const *>(data);
+  uint64_t hash = seed;
+
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3;
+  }
+
+  return hash;
+}
+
+
+void MelaCache::Insert(
+    EventID const &id, uint64_t inputHash, Values const &values) {
+  newRecords_[{id.run, id.lumi, id.event, inputHash}] = values;
+}
+
+
+void MelaCache::Save() {
+  if (newRecords_.empty())
+    return;
+
+  // Serialize concurrent updates from different jobs
+  std::filesystem::path lockPath{path_};
+  lockPath += ".lock";
+  int const lockFd = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+
+  if (lockFd < 0 or flock(lockFd, LOCK_EX) != 0) {
+    if (lockFd >= 0)
+      close(lockFd);
+    HZZException exception;
+    exception << "Failed to lock file " << lockPath << ".";
+    throw exception;
+  }
+
+  try {
+    // The file might have been updated by another job since it was mapped
+    MappedFile const current{path_, configHash_};
+    std::vector<Record> records;
+    records.reserve((current.end() - current.begin()) + newRecords_.size());
+
+    auto existing = current.begin();
+
+    for (auto const &[key, values] : newRecords_) {
+      while (existing != current.end() and GetKey(*existing) < key)
+        records.push_back(*existing++);
+
+      if (existing != current.end() and GetKey(*existing) == key)
+        continue;
+
+      auto const &[run, lumi, event, inputHash] = key;
+      records.push_back({run, lumi, event, inputHash, values});
+    }
+
+    records.insert(records.end(), existing, current.end());
+
+    Header const header{magic_, configHash_, records.size()};
+    std::filesystem::path tmpPath{path_};
+    tmpPath += ".tmp" + std::to_string(getpid());
+    std::ofstream file{tmpPath, std::ios::binary};
+    file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    file.write(reinterpret_cast<char const *>(records.data()),
+               sizeof(Record) * records.size());
+    file.close();
+
+    if (not file) {
+      HZZException exception;
+      exception << "Failed to write file " << tmpPath << ".";
+      throw exception;
+    }
+
+    // Mappings of the previous version of the file, including the one held by
+    // this object, remain valid after the rename
+    std::filesystem::rename(tmpPath, path_);
+    LOG_DEBUG << "Wrote " << records.size() << " records, of which "
+        << newRecords_.size() << " are new, to MELA cache " << path_ << ".";
+  } catch (...) {
+    flock(lockFd, LOCK_UN);
+    close(lockFd);
+    throw;
+  }
+
+  flock(lockFd, LOCK_UN);
+  close(lockFd);
+  newRecords_.clear();
+}
+
+
+MelaCache::MappedFile::MappedFile(
+    std::filesystem::path const &path, uint64_t configHash)
+    : data_{nullptr}, size_{0}, records_{nullptr}, numRecords_{0} {
+  int const fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 or info.st_size < off_t(sizeof(Header))) {
+    close(fd);
+    return;
+  }
+
+  size_ = info.st_size;
+  data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    size_ = 0;
+    return;
+  }
+
+  auto const *header = static_cast<Header const *>(data_);
+
+  if (header->magic != magic_ or header->configHash != configHash
+      or size_ != sizeof(Header) + sizeof(Record) * header->numRecords) {
+    LOG_DEBUG << "Ignoring content of MELA cache " << path
+        << " since it is not compatible with the current configuration.";
+    return;
+  }
+
+  records_ = reinterpret_cast<Record const *>(header + 1);
+  numRecords_ = header->numRecords;
+}
+
+
+MelaCache::MappedFile::~MappedFile() noexcept {
+  if (data_)
+    munmap(data_, size_);
+}
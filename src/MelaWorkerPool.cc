@@ -0,0 +1,219 @@
+#include <MelaWorkerPool.h>
+
+#include <array>
+#include <cstring>
+#include <exception>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <TROOT.h>
+
+#include <HZZException.h>
+#include <Logger.h>
+
+
+struct MelaWorkerPool::Slot {
+  /// Components (px, py, pz, E) of the momentum of the ZZ candidate
+  std::array<double, 4> p4ZZ;
+
+  int numJets;
+
+  /// Components (px, py, pz, E) of momenta of jets
+  std::array<std::array<double, 4>, maxJets> jets;
+
+  MelaCache::Values values;
+
+  /**
+   * \brief Indicates whether the computation has failed, with the reason in
+   * \ref error
+   */
+  bool failed;
+  char error[256];
+};
+
+
+MelaWorkerPool::MelaWorkerPool(int numWorkers, ComputeFunction compute)
+    : compute_{std::move(compute)}, slots_{nullptr}, numAlive_{0} {
+  // Helpers are created with fork, which only replicates the calling thread.
+  // Threads of the implicit multithreading of ROOT may already be running and
+  // hold locks that would then never be released in the helpers.
+  if (ROOT::IsImplicitMTEnabled())
+    throw HZZException{
+        "MELA workers cannot be used together with implicit multithreading "
+        "of ROOT (option --unzip-threads)."};
+
+  void *memory = mmap(nullptr, sizeof(Slot) * numWorkers,
+                      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                      -1, 0);
+
+  if (memory == MAP_FAILED)
+    throw HZZException{"Failed to allocate shared memory for MELA workers."};
+
+  slots_ = static_cast<Slot *>(memory);
+
+  for (int i = 0; i < numWorkers; ++i) {
+    Worker worker;
+    worker.scratchDir = std::filesystem::temp_directory_path()
+        / ("hzz2l2nu_mela_" + std::to_string(getpid()) + "_"
+           + std::to_string(i));
+    std::filesystem::create_directories(worker.scratchDir);
+
+    // A socket rather than a pipe is used so that messages can be sent with
+    // MSG_NOSIGNAL. Writing to a helper that has died then results in an error
+    // instead of SIGPIPE.
+    int sockets[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+      throw HZZException{"Failed to create sockets for MELA workers."};
+
+    worker.pid = fork();
+
+    if (worker.pid < 0)
+      throw HZZException{"Failed to start MELA worker."};
+
+    if (worker.pid == 0) {
+      // Helper process. Close sockets of other helpers so that they can detect
+      // when the parent closes its ends.
+      for (auto const &other : workers_)
+        close(other.fd);
+
+      close(sockets[0]);
+      int status = 1;
+
+      if (chdir(worker.scratchDir.c_str()) == 0) {
+        WorkerLoop(slots_[i], sockets[1]);
+        status = 0;
+      }
+
+      // Skip destructors of static objects, which belong to the parent
+      _exit(status);
+    }
+
+    close(sockets[1]);
+    worker.fd = sockets[0];
+    workers_.emplace_back(std::move(worker));
+    freeWorkers_.push_back(i);
+    ++numAlive_;
+  }
+
+  LOG_DEBUG << "Started " << numWorkers << " MELA workers.";
+}
+
+
+MelaWorkerPool::~MelaWorkerPool() noexcept {
+  // Helpers exit when they see that the sockets have been closed
+  for (auto const &worker : workers_)
+    close(worker.fd);
+
+  for (auto const &worker : workers_) {
+    waitpid(worker.pid, nullptr, 0);
+    std::error_code error;
+    std::filesystem::remove_all(worker.scratchDir, error);
+  }
+
+  if (slots_)
+    munmap(slots_, sizeof(Slot) * workers_.size());
+}
+
+
+MelaCache::Values MelaWorkerPool::Compute(
+    FourMomentum const &p4ZZ, std::vector<FourMomentum> const &jets) {
+  if (jets.size() > maxJets) {
+    HZZException exception;
+    exception << "Cannot pass " << jets.size() << " jets to MELA workers. "
+        << "At most " << maxJets << " are supported.";
+    throw exception;
+  }
+
+  int index;
+  {
+    std::unique_lock<std::mutex> lock{mutex_};
+    freed_.wait(lock, [this]{
+      return not freeWorkers_.empty() or numAlive_ == 0;});
+
+    if (freeWorkers_.empty())
+      throw HZZException{"All MELA workers have terminated."};
+
+    index = freeWorkers_.back();
+    freeWorkers_.pop_back();
+  }
+
+  Slot &slot = slots_[index];
+  slot.p4ZZ = {p4ZZ.Px(), p4ZZ.Py(), p4ZZ.Pz(), p4ZZ.E()};
+  slot.numJets = jets.size();
+
+  for (int i = 0; i < slot.numJets; ++i)
+    slot.jets[i] = {jets[i].Px(), jets[i].Py(), jets[i].Pz(), jets[i].E()};
+
+  // The system calls on the socket also order the accesses to the shared
+  // memory
+  char signal = 0;
+  Worker const &worker = workers_[index];
+
+  if (send(worker.fd, &signal, 1, MSG_NOSIGNAL) != 1
+      or recv(worker.fd, &signal, 1, 0) != 1) {
+    // The helper is not returned to the pool. Wake up all threads waiting for
+    // helpers so that they can stop if this was the last one.
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      --numAlive_;
+    }
+    freed_.notify_all();
+
+    HZZException exception;
+    exception << "MELA worker " << index << " (PID " << worker.pid
+        << ") has terminated unexpectedly.";
+    throw exception;
+  }
+
+  bool const failed = slot.failed;
+  std::string const error{slot.error};
+  MelaCache::Values const values = slot.values;
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    freeWorkers_.push_back(index);
+  }
+  freed_.notify_one();
+
+  if (failed) {
+    HZZException exception;
+    exception << "Computation in MELA worker " << index << " failed: " << error;
+    throw exception;
+  }
+
+  return values;
+}
+
+
+void MelaWorkerPool::WorkerLoop(Slot &slot, int fd) const {
+  std::vector<FourMomentum> jets;
+  char signal;
+
+  while (recv(fd, &signal, 1, 0) == 1) {
+    FourMomentum const p4ZZ{
+        slot.p4ZZ[0], slot.p4ZZ[1], slot.p4ZZ[2], slot.p4ZZ[3]};
+    jets.clear();
+
+    for (int i = 0; i < slot.numJets; ++i) {
+      auto const &p = slot.jets[i];
+      jets.emplace_back(p[0], p[1], p[2], p[3]);
+    }
+
+    try {
+      slot.values = compute_(p4ZZ, jets);
+      slot.failed = false;
+    } catch (std::exception const &e) {
+      slot.failed = true;
+      std::strncpy(slot.error, e.what(), sizeof(slot.error) - 1);
+      slot.error[sizeof(slot.error) - 1] = '\0';
+    }
+
+    if (send(fd, &signal, 1, MSG_NOSIGNAL) != 1)
+      return;
+  }
+}
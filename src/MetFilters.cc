@@ -11,12 +11,12 @@ MetFilters::MetFilters(Options const &options, Dataset &dataset) {
         options.GetConfig(), {"met_filters", "data"});
 
   for (auto const &flagName : flagsName)
-    flags_.emplace_back(dataset.Reader(), flagName.c_str());
+    flags_.emplace_back(dataset, flagName);
 }
 
 
 bool MetFilters::operator()() const {
-  for (auto &flag: flags_) {
+  for (auto const &flag: flags_) {
     if (not *flag)
       return false;
   }
@@ -8,18 +8,19 @@
 #include <TRandom.h>
 
 #include <FileInPath.h>
+#include <HZZException.h>
 #include <Utils.h>
 
 
 MuonBuilder::MuonBuilder(Dataset &dataset, Options const &,
-                         TabulatedRngEngine &rngEngine)
-    : CollectionBuilder{dataset.Reader()},
+                         RngEngine &rngEngine)
+    : CollectionBuilder{dataset, "MuonBuilder"},
       minPtLoose_{10.}, minPtTight_{15.},
       maxRelIsoLoose_{0.25}, maxRelIsoTight_{0.15},
-      isSim_{dataset.Info().IsSimulation()},
+      isSim_{dataset.Info().IsSimulation()}, genParticles_{nullptr},
       // Use up to 2 random numbers per muon and allow up to 5 muons before
-      // repetition. This gives 10 channels for TabulatedRandomGenerator.
-      tabulatedRng_{rngEngine, 10},
+      // repetition. This gives 10 channels for RandomGenerator.
+      rng_{rngEngine, 10},
       srcPt_{dataset.Reader(), "Muon_pt"}, srcEta_{dataset.Reader(), "Muon_eta"},
       srcPhi_{dataset.Reader(), "Muon_phi"}, srcMass_{dataset.Reader(), "Muon_mass"},
       srcCharge_{dataset.Reader(), "Muon_charge"},
@@ -32,14 +33,8 @@ MuonBuilder::MuonBuilder(Dataset &dataset, Options const &,
       srcdxy_{dataset.Reader(), "Muon_dxy"},
       srcdz_{dataset.Reader(), "Muon_dz"},
       srcTrackerLayers_{dataset.Reader(), "Muon_nTrackerLayers"} {
-
-  if(isSim_){
-    genPartId_.reset(new TTreeReaderArray<int>(dataset.Reader(), "GenPart_pdgId"));
-    genPartPt_.reset(new TTreeReaderArray<float>(dataset.Reader(), "GenPart_pt"));
-    genPartEta_.reset(new TTreeReaderArray<float>(dataset.Reader(), "GenPart_eta"));
-    genPartPhi_.reset(new TTreeReaderArray<float>(dataset.Reader(), "GenPart_phi"));
-  }
   rochesterCorrection_.reset(new RoccoR(FileInPath::Resolve("rcdata.2016.v3")));
+  GetNode().SetPrefetch([this]{Prefetch();});
 }
 
 
@@ -55,6 +50,14 @@ std::vector<Muon> const &MuonBuilder::GetTight() const {
 }
 
 
+void MuonBuilder::SetGenParticleIndex(GenParticleIndex const *genParticles) {
+  if (isSim_) {
+    genParticles_ = genParticles;
+    GetNode().AddInput(genParticles->GetNode());
+  }
+}
+
+
 void MuonBuilder::ApplyRochesterCorrection(
     int index, Muon *muon, int trackerLayers) const {
 
@@ -71,12 +74,13 @@ void MuonBuilder::ApplyRochesterCorrection(
     if (genMatch)
       scaleFactor = rochesterCorrection_->kScaleFromGenMC(
         muon->charge, muon->p4.Pt(), muon->p4.Eta(), muon->p4.Phi(),
-        trackerLayers, genMatch->p4.Pt(), tabulatedRng_.Rndm(2 * index));
+        trackerLayers, genMatch->p4.Pt(), rochesterRandomNumbers_[2 * index]);
     else
       scaleFactor = rochesterCorrection_->kScaleAndSmearMC(
         muon->charge, muon->p4.Pt(), muon->p4.Eta(), muon->p4.Phi(),
         trackerLayers,
-        tabulatedRng_.Rndm(2 * index), tabulatedRng_.Rndm(2 * index + 1));
+        rochesterRandomNumbers_[2 * index],
+        rochesterRandomNumbers_[2 * index + 1]);
   } else
     scaleFactor = rochesterCorrection_->kScaleDT(
       muon->charge, muon->p4.Pt(), muon->p4.Eta(), muon->p4.Phi());
@@ -92,21 +96,37 @@ void MuonBuilder::Build() const {
   looseMuons_.clear();
   tightMuons_.clear();
 
-  for (unsigned i = 0; i < srcPt_.GetSize(); ++i) {
-    bool const passIdLoose = srcIdLoose_[i];
-    bool const passIdTight = srcIdTight_[i];
+  // Random numbers for the Rochester correction for all muons in the event
+  if (isSim_) {
+    rochesterRandomNumbers_.resize(2 * srcPt_.GetSize());
+    rng_.Rndm(0, int(rochesterRandomNumbers_.size()),
+              rochesterRandomNumbers_.data());
+  }
+
+  KinematicColumns const columns{
+      srcPt_.View(), srcEta_.View(), srcPhi_.View(), srcMass_.View()};
+  auto const isolation = srcIsolation_.View();
 
-    if (not passIdLoose)
-      continue;
+  // Apply the selections that only depend on the input columns to all muons at
+  // once. Requirements on pt are checked after the Rochester correction.
+  double const maxRelIsoLoose = maxRelIsoLoose_;
+  double const maxRelIsoTight = maxRelIsoTight_;
 
-    if (not (srcIsolation_[i] <= maxRelIsoLoose_))
-      continue;
+  looseMask_.Reset(columns.size());
+  looseMask_.Require(srcIdLoose_.View(), [](bool id){return id;})
+      .Require(isolation, [=](float iso){return iso <= maxRelIsoLoose;})
+      .Require(columns.eta, [](float eta){return std::abs(eta) < 2.4;});
 
-    if (not (std::abs(srcEta_[i]) < 2.4))
-      continue;
+  tightMask_.Reset(columns.size());
+  tightMask_.Require(srcIdTight_.View(), [](bool id){return id;})
+      .Require(isolation, [=](float iso){return iso <= maxRelIsoTight;})
+      .Require(srcdxy_.View(), srcdz_.View(), [](float dxy, float dz){
+        return dxy < 0.02 and dz < 0.1;
+      });
 
+  for (int i : looseMask_.Indices()) {
     Muon muon;
-    muon.p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], srcMass_[i]);
+    muon.p4 = columns.Momentum(i);
     muon.uncorrP4 = muon.p4;
     muon.charge = srcCharge_[i];
 
@@ -120,19 +140,8 @@ void MuonBuilder::Build() const {
     // Propagate changes in momenta of loose muons into ptmiss
     AddMomentumShift(muon.uncorrP4, muon.p4);
 
-    if (not passIdTight)
-      continue;
-
-    if (not (srcIsolation_[i] <= maxRelIsoTight_))
-      continue;
-
-    if (not (muon.p4.Pt() > minPtTight_))
-      continue;
-
-    if (not (srcdxy_[i] < 0.02 and srcdz_[i] < 0.1))
-      continue;
-
-    tightMuons_.emplace_back(muon);
+    if (tightMask_[i] and muon.p4.Pt() > minPtTight_)
+      tightMuons_.emplace_back(muon);
   }
 
 
@@ -145,31 +154,42 @@ void MuonBuilder::Build() const {
 std::optional<GenParticle> MuonBuilder::FindGenMatch(
     Muon const &muon, double maxDR) const {
 
-  unsigned iClosest = -1;
-  double minDR2 = std::pow(maxDR, 2);
-
-  for (unsigned i = 0; i < genPartId_->GetSize(); ++i) {
-    if (std::abs(genPartId_->At(i)) != 13)
-      // Only consider muons
-      continue;
-
-    double const dR2 = utils::DeltaR2(
-      muon.p4.Eta(), muon.p4.Phi(), genPartEta_->At(i), genPartPhi_->At(i));
-
-    if (dR2 < minDR2) {
-      iClosest = i;
-      minDR2 = dR2;
-    }
+  if (not genParticles_) {
+    HZZException exception;
+    exception << "MuonBuilder: index of generator-level particles has not "
+        "been provided.";
+    throw exception;
   }
 
-  if (iClosest != unsigned(-1)) {
-    GenParticle matchedParticle{genPartId_->At(iClosest)};
+  // Only consider muons
+  int const iClosest = genParticles_->FindClosest(
+      muon.p4.Eta(), muon.p4.Phi(), maxDR,
+      [this](int i){return std::abs(genParticles_->PdgId(i)) == 13;});
+
+  if (iClosest >= 0) {
+    auto const &genKinematics = genParticles_->Kinematics();
+    GenParticle matchedParticle{genParticles_->PdgId(iClosest)};
     matchedParticle.p4.SetPtEtaPhiM(
-      genPartPt_->At(iClosest), genPartEta_->At(iClosest), genPartPhi_->At(iClosest),
-      0.1057
+      genKinematics.pt[iClosest], genKinematics.eta[iClosest],
+      genKinematics.phi[iClosest], 0.1057
     );
     return matchedParticle;
   } else
     return {};
-} 
+}
+
 
+void MuonBuilder::Prefetch() const {
+  for (auto *src : {&srcPt_, &srcEta_, &srcPhi_, &srcMass_, &srcIsolation_,
+                    &srcdxy_, &srcdz_})
+    src->Prefetch();
+
+  for (auto *src : {&srcCharge_, &srcTrackerLayers_})
+    src->Prefetch();
+
+  srcIdLoose_.Prefetch();
+  srcIdTight_.Prefetch();
+
+  if (isSim_)
+    rng_.Prefetch();
+}
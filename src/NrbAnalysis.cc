@@ -6,6 +6,7 @@
 
 #include <TFile.h>
 
+#include <HZZException.h>
 #include <Utils.h>
 
 
@@ -18,7 +19,7 @@ NrbAnalysis::NrbAnalysis(Options const &options, Dataset &dataset)
       outputFile_{options.GetAs<std::string>("output")},
       keepAllControlPlots_(true),//all plots are control plots in this study
       syst_{options.GetAs<std::string>("syst")},
-      runSampler_{dataset, options, tabulatedRngEngine_},
+      runSampler_{dataset, options, rngEngine_},
       triggerFilter_{dataset, options, &runSampler_},
       divideFinalHistoByBinWidth_{false},  //For final plots, we don't divide by the bin width to ease computations of the yields by eye.
       v_jetCat_{"eq0jets","eq1jets","geq2jets"},
@@ -32,6 +33,11 @@ NrbAnalysis::NrbAnalysis(Options const &options, Dataset &dataset)
         dataset_.Reader(), "GenPart_genPartIdxMother"));
   }
 
+  if (shapeSyst_.IsMultiple())
+    throw HZZException{
+        "NrbAnalysis does not support evaluation of multiple shape variations "
+        "in a single pass."};
+
   InitializeHistograms();
 
   if (syst_ == "")
@@ -208,14 +214,14 @@ bool NrbAnalysis::ProcessEvent() {
   if (isEMu)
     std::sort(tightLeptons.begin(), tightLeptons.end(), PtOrdered);
 
-  TLorentzVector boson = tightLeptons[0].p4 + tightLeptons[1].p4;
+  FourMomentum boson = tightLeptons[0].p4 + tightLeptons[1].p4;
 
   auto const &ptMiss = ptMissBuilder_.Get();
-  TLorentzVector const ptMissP4 = ptMissBuilder_.Get().p4;
+  FourMomentum const ptMissP4 = ptMissBuilder_.Get().p4;
 
   //Loop on lepton type
   double weightBeforeLoop = weight;
-  TLorentzVector bosonBeforeLoop = boson;
+  FourMomentum bosonBeforeLoop = boson;
   bool eventAccepted = false;
 
   for(unsigned int c = 0; c < tagsR_size_; c++){
@@ -5,9 +5,9 @@
 #include <cstdlib>
 #include <stdexcept>
 
-#include <TLorentzVector.h>
 #include <TVector2.h>
 
+#include <FourMomentum.h>
 #include <Utils.h>
 
 
@@ -24,8 +24,8 @@ NrbTrees::NrbTrees(Options const &options, Dataset &dataset)
       triggerFilter_{dataset, options, &runSampler_},
       leptonEff_{dataset, options, &electronBuilder_, &muonBuilder_, isSim_? 2 : 1},
       triggerEff_{dataset, options, &electronBuilder_, &muonBuilder_, isSim_? 2 : 1},
-      srcEvent_{dataset.Reader(), "event"},
-      srcNumPVGood_{dataset.Reader(), "PV_npvsGood"} {
+      srcEvent_{dataset, "event"},
+      srcNumPVGood_{dataset, "PV_npvsGood"} {
 
   if (isSim_) {
     auto const &node = dataset.Info().Parameters()["zz_2l2nu"];
@@ -138,7 +138,7 @@ bool NrbTrees::ProcessEvent() {
   l2Pt_ = l2->p4.Pt();
   l1Eta_ = l1->p4.Eta();
   l2Eta_ = l1->p4.Eta();
-  TLorentzVector const p4LL = l1->p4 + l2->p4;
+  FourMomentum const p4LL = l1->p4 + l2->p4;
   llPt_ = p4LL.Pt();
   llEta_ = p4LL.Eta();
   llPhi_ = p4LL.Phi();
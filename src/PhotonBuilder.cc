@@ -8,20 +8,19 @@
 
 
 PhotonBuilder::PhotonBuilder(Dataset &dataset)
-    : CollectionBuilder{dataset.Reader()},
+    : CollectionBuilder{dataset, "PhotonBuilder"},
       minPt_{20.},
       isSim_{dataset.Info().IsSimulation()},
       srcPt_{dataset.Reader(), "Photon_pt"},
       srcEta_{dataset.Reader(), "Photon_eta"},
       srcPhi_{dataset.Reader(), "Photon_phi"},
+      srcId_{dataset.Reader(), "Photon_cutBased"},
       srcIsEtaScEb_{dataset.Reader(), "Photon_isScEtaEB"},
       srcPixelSeed_{dataset.Reader(), "Photon_pixelSeed"},
       srcElecronVeto_{dataset.Reader(), "Photon_electronVeto"},
       srcR9_{dataset.Reader(), "Photon_r9"},
       srcSieie_{dataset.Reader(), "Photon_sieie"}
 {
-  srcId_.reset(
-      new TTreeReaderArray<int>(dataset.Reader(), "Photon_cutBased"));
   // srcMvaId_.reset(
       // new TTreeReaderArray<bool>(dataset.Reader(), "Photon_mvaID_WP80"));
   // srcIsolation_.reset(
@@ -51,7 +50,20 @@ std::vector<Photon> const &PhotonBuilder::Get() const {
 void PhotonBuilder::Build() const {
   photons_.clear();
 
-  for (unsigned i = 0; i < srcPt_.GetSize(); ++i) {
+  KinematicColumns const columns{
+      srcPt_.View(), srcEta_.View(), srcPhi_.View(), {}};
+
+  // Kinematic selection and tight ID, applied to all photons at once
+  double const minPt = minPt_;
+  mask_.Reset(columns.size());
+  mask_.Require(columns.pt, [=](float pt){return pt > minPt;})
+      .Require(srcId_.View(), [](int id){return id >= 3;})
+      .Require(columns.eta, [](float eta){return std::abs(eta) < 2.5;});
+
+  // Angular cleaning
+  RejectDuplicates(columns.Directions(), 0.1, mask_);
+
+  for (int i : mask_.Indices()) {
     Photon photon;
     // Gen particle matching
     if (isSim_) {
@@ -76,23 +88,7 @@ void PhotonBuilder::Build() const {
         continue;
     }
 
-    // Tight ID
-    bool passId = false;
-    passId = (srcId_->At(i) >= 3);
-    //std::cout<< "photon No."<<i<<" : pt="<<srcPt_[i]<< " eta="<<srcEta_[i] << " phi="<<srcPhi_[i]<<" passID="<<(srcId_->At(i) >= 3)<<std::endl;
-    // passId = srcMvaId_->At(i);
-
-    if (not (srcPt_[i] > minPt_))
-      continue;
-
-    if (not passId)
-      continue;
-
-    // Eta cut
-    if (not (std::abs(srcEta_[i]) < 2.5))
-      continue;
-
-    photon.p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], 0.);
+    photon.p4 = columns.Momentum(i);
 
     // Only consider photons in the barrel except for Njet >= 2
     photon.isEB = srcIsEtaScEb_[i];
@@ -107,16 +103,9 @@ void PhotonBuilder::Build() const {
     // Extra variables
     photon.r9 = srcR9_[i];
 
-    // Perform angular cleaning
-    //std::cout<<"photon No."<<i<<" isEB="<<srcIsEtaScEb_[i] << " passEleVeto="<<(!srcPixelSeed_[i] && srcElecronVeto_[i])<< " sieie" << srcSieie_[i] << " r9="<<srcR9_[i]<< std::endl;
-    if (IsDuplicate(photon.p4, 0.1)){
-      //std::cout<<"deltaR cleaning < 0.1"<<std::endl;
-      continue;
-    }
     photons_.emplace_back(photon);
   }
 
   // Make sure the collection is ordered in pt
   std::sort(photons_.begin(), photons_.end(), PtOrdered);
 }
-
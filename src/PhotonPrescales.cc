@@ -7,8 +7,8 @@
 PhotonPrescales::PhotonPrescales(Dataset &dataset, Options const &options)
     : photonTriggers_{GetTriggers(dataset, options)},
       isSim_{dataset.Info().IsSimulation()},
-      run_{dataset.Reader(), "run"},
-      luminosityBlock_{dataset.Reader(), "luminosityBlock"} {}
+      run_{dataset, "run"},
+      luminosityBlock_{dataset, "luminosityBlock"} {}
 
 
 std::vector<double> PhotonPrescales::GetThresholdsBinning() const {
@@ -77,8 +77,8 @@ std::vector<PhotonTrigger> PhotonPrescales::GetTriggers(Dataset &dataset, Option
     PhotonTrigger currentTrigger;
     currentTrigger.name = node["name"].as<std::string>();
     currentTrigger.threshold = node["threshold"].as<float>();
-    currentTrigger.decision.reset(new TTreeReaderValue<Bool_t>(dataset.Reader(),
-      node["name"].as<std::string>().c_str()));
+    currentTrigger.decision.reset(new BulkValue<Bool_t>(dataset,
+      node["name"].as<std::string>()));
 
     // Loading the prescale map from the yaml file
     YAML::Node trigNode = psfileNode[currentTrigger.name];
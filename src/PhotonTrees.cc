@@ -18,17 +18,17 @@ int const PhotonTrees::maxSize_;
 
 
 PhotonTrees::PhotonTrees(Options const &options, Dataset &dataset)
-    : EventTrees{options, dataset},
+    : EventTrees{options, dataset, "Vars", true},
       storeMoreVariables_{options.Exists("more-vars")},
-      srcRun_{dataset.Reader(), "run"},
-      srcLumi_{dataset.Reader(), "luminosityBlock"},
-      srcEvent_{dataset.Reader(), "event"},
+      srcRun_{dataset, "run"},
+      srcLumi_{dataset, "luminosityBlock"},
+      srcEvent_{dataset, "event"},
       photonBuilder_{dataset},
       photonPrescales_{dataset, options},
       photonWeight_{dataset, options, &photonBuilder_},
       gJetsWeight_{dataset, &photonBuilder_},
       // photonFilter_{dataset, options},
-      srcNumPVGood_{dataset.Reader(), "PV_npvsGood"} {
+      srcNumPVGood_{dataset, "PV_npvsGood"} {
 
   if (isSim_) {
     numGenPart_.reset(new TTreeReaderValue<UInt_t>(dataset.Reader(), "nGenPart"));
@@ -176,6 +176,11 @@ bool PhotonTrees::ProcessEvent() {
   //if (!sel) return false;
   //std::cout << eventInfo <<std::endl;
   //if(sel) std::cout<<"not selected from the list because of reasons: " <<std::endl;
+  return ForEachShapeVariation([this]{return ProcessVariation();});
+}
+
+
+bool PhotonTrees::ProcessVariation() {
   if (not ApplyCommonFilters())
   {
     //if(sel) std::cout << "not pass common filters" <<std::endl;
@@ -372,7 +377,7 @@ bool PhotonTrees::ProcessEvent() {
   if (applyMassLineshape_) {
     photonMass = lineshapeMassWeight_map_["_ll"]->GetRandom();
   }
-  TLorentzVector photonWithMass;
+  FourMomentum photonWithMass;
   photonWithMass.SetPtEtaPhiM(photon->p4.Pt(), photon->p4.Eta(), 
     photon->p4.Phi(), photonMass);
 
@@ -14,7 +14,7 @@ PhotonWeight::PhotonWeight(Dataset &, Options const &options,
   for (auto const &photonPath : 
     Options::NodeAs<std::vector<std::string>>(
       options.GetConfig(), {"photon_efficiency", "photon"})) {
-    photonTable_.emplace_back(ReadHistogram(photonPath));
+    photonTable_.emplace_back(*ReadHistogram(photonPath));
   }
   LOG_WARN << "Photon trigger scale factors are missing";
 }
@@ -36,15 +36,15 @@ double PhotonWeight::PhotonSF(Photon const &photon) const {
   for (auto &photonTable : photonTable_) {
 
     int photonEtaBin;
-    if (photonTable->GetYaxis()->GetXmin() >= 0) {
+    if (photonTable.YAxis().Min() >= 0) {
         eta = fabs(eta);
     }
-    photonEtaBin = photonTable->GetXaxis()->FindFixBin(eta);
-    int photonPtBin = photonTable->GetYaxis()->FindFixBin(pt);
-    if (pt > photonTable->GetYaxis()->GetXmax()) 
-      photonPtBin = photonTable->GetNbinsY();
+    photonEtaBin = photonTable.XAxis().FindBin(eta);
+    int photonPtBin = photonTable.YAxis().FindBin(pt);
+    if (pt > photonTable.YAxis().Max()) 
+      photonPtBin = photonTable.YAxis().NumBins();
 
-    eff *= photonTable->GetBinContent(photonEtaBin, photonPtBin);
+    eff *= photonTable.Value(photonEtaBin, photonPtBin);
   }
   return eff;
 }
@@ -8,6 +8,7 @@
 #include <string>
 
 #include <TFile.h>
+#include <TH2.h>
 
 #include <FileInPath.h>
 
@@ -16,19 +17,19 @@
  * \brief Auxiliary class to simplify reading of histograms in
  * PileUpIdWeight::LoadScaleFactors
  *
- * It reads 2D histograms for a ROOT file, wrapping them in std::shared_ptr. If
- * a histogram with the same name is requested again, the already existing
- * std::shared_ptr is returned.
+ * It reads 2D histograms for a ROOT file, converts them into BinnedTable2D, and
+ * wraps these in std::shared_ptr. If a histogram with the same name is
+ * requested again, the already existing std::shared_ptr is returned.
  */
 class HistReader {
  public:
   HistReader(std::filesystem::path const &path);
   ~HistReader();
-  std::shared_ptr<TH2> operator()(std::string const &name);
+  std::shared_ptr<BinnedTable2D> operator()(std::string const &name);
 
  private:
   TFile file_;
-  std::map<std::string, std::shared_ptr<TH2>> readHistograms_;
+  std::map<std::string, std::shared_ptr<BinnedTable2D>> readHistograms_;
 };
 
 HistReader::HistReader(std::filesystem::path const &path)
@@ -38,14 +39,16 @@ HistReader::~HistReader() {
   file_.Close();
 }
 
-std::shared_ptr<TH2> HistReader::operator()(std::string const &name) {
+std::shared_ptr<BinnedTable2D> HistReader::operator()(
+    std::string const &name) {
   auto const res = readHistograms_.find(name);
   if (res != readHistograms_.end())
     return res->second;
-  auto hist = std::shared_ptr<TH2>(file_.Get<TH2>(name.c_str()));
+  std::unique_ptr<TH2> hist{file_.Get<TH2>(name.c_str())};
   hist->SetDirectory(nullptr);
-  readHistograms_[name] = hist;
-  return hist;
+  auto table = std::make_shared<BinnedTable2D>(*hist);
+  readHistograms_[name] = table;
+  return table;
 }
 
 
@@ -55,8 +58,10 @@ PileUpIdWeight::PileUpIdWeight(
     JetBuilder const *jetBuilder)
     : pileUpIdFilter_{pileUpIdFilter}, jetBuilder_{jetBuilder},
       absEtaEdges_{pileUpIdFilter_->GetAbsEtaEdges()},
-      expPileUp_{dataset.Reader(), "Pileup_nTrueInt"},
-      cache_{dataset.Reader()} {
+      expPileUp_{dataset, "Pileup_nTrueInt"},
+      node_{dataset.Graph(), "PileUpIdWeight", [this]{Update();},
+            &jetBuilder->GetShapeSyst()} {
+  node_.AddInput(jetBuilder->GetNode());
   for (auto const &wp : pileUpIdFilter_->GetWorkingPoints())
     contexts_.emplace_back(wp);
 
@@ -66,13 +71,17 @@ PileUpIdWeight::PileUpIdWeight(
   auto const effModelPath = FileInPath::Resolve(
       Options::NodeAs<std::string>(
           options.GetConfig(), {"pileup_id", "efficiency"}));
-  effCalc_.emplace(effModelPath, effFeatures_.size());
+  std::string compiledModel;
+  if (auto const node = options.GetConfig()["pileup_id"]["efficiency_compiled"])
+    compiledModel = node.as<std::string>();
+  effCalc_.emplace(effModelPath, numEffFeatures_, compiledModel);
 
   // The year won't change, so the corresponding features can be set already
   // now
-  effFeatures_[4] = (year == 2016) ? 1 : 0;
-  effFeatures_[5] = (year == 2017) ? 1 : 0;
-  effFeatures_[6] = (year == 2018) ? 1 : 0;
+  effFeaturesTemplate_.fill(0.);
+  effFeaturesTemplate_[4] = (year == 2016) ? 1 : 0;
+  effFeaturesTemplate_[5] = (year == 2017) ? 1 : 0;
+  effFeaturesTemplate_[6] = (year == 2018) ? 1 : 0;
 
   auto const systLabel = options.GetAs<std::string>("syst");
   if (systLabel == "puid_tag_up")
@@ -104,6 +113,36 @@ std::string_view PileUpIdWeight::VariationName(int variation) const {
 }
 
 
+void PileUpIdWeight::AddTaggableJet(Jet const &jet, bool passed) const {
+  if (not pileUpIdFilter_->IsTaggable(jet))
+    return;
+  auto const &context = FindContext(jet);
+  if (context.workingPoint == Jet::PileUpId::None)
+    return;
+
+  taggableJets_.push_back({&jet, &context, passed});
+}
+
+
+void PileUpIdWeight::FillEffFeatures(
+    Context const &context, Jet const &jet, float *features) const {
+  int const f = jet.combFlavour;
+  // Indices 4 to 6 correspond to year and are copied from the template
+  std::copy(effFeaturesTemplate_.begin(), effFeaturesTemplate_.end(),
+            features);
+  features[0] = jet.p4.Pt();
+  features[1] = jet.p4.Eta();
+  features[2] = *expPileUp_;
+  features[3] = int(context.workingPoint);
+  features[7] = (jet.isPileUp) ? 1 : 0;
+  features[8] = (f == 21 or f == 0) ? 1 : 0;
+  features[9] = (f == 1 or f == 2 or f == 3) ? 1 : 0;
+  features[10] = (f == 4) ? 1 : 0;
+  features[11] = (f == 5) ? 1 : 0;
+  features[12] = std::abs(jet.p4.Eta());
+}
+
+
 PileUpIdWeight::Context const &PileUpIdWeight::FindContext(
     Jet const &jet) const {
   int const bin = std::upper_bound(
@@ -113,37 +152,18 @@ PileUpIdWeight::Context const &PileUpIdWeight::FindContext(
 }
 
 
-double PileUpIdWeight::GetEfficiency(
-    Context const &context, Jet const &jet) const {
-  int const f = jet.combFlavour;
-  effFeatures_[0] = jet.p4.Pt();
-  effFeatures_[1] = jet.p4.Eta();
-  effFeatures_[2] = *expPileUp_;
-  effFeatures_[3] = int(context.workingPoint);
-  // Indices 4 to 6 correspond to year and has been already set
-  effFeatures_[7] = (jet.isPileUp) ? 1 : 0;
-  effFeatures_[8] = (f == 21 or f == 0) ? 1 : 0;
-  effFeatures_[9] = (f == 1 or f == 2 or f == 3) ? 1 : 0;
-  effFeatures_[10] = (f == 4) ? 1 : 0;
-  effFeatures_[11] = (f == 5) ? 1 : 0;
-  effFeatures_[12] = std::abs(jet.p4.Eta());
-  return effCalc_->Predict(effFeatures_.data());
-}
-
-
 double PileUpIdWeight::GetScaleFactor(
     Context const &context, Jet const &jet, Variation variation) const {
-  std::shared_ptr<TH2> histValue, histUnc;
+  BinnedTable2D const *tableValue, *tableUnc;
   if (jet.isPileUp) {
-    histValue = context.sfPileUp;
-    histUnc = context.sfUncPileUp;
+    tableValue = context.sfPileUp.get();
+    tableUnc = context.sfUncPileUp.get();
   } else {
-    histValue = context.sfMatched;
-    histUnc = context.sfUncMatched;
+    tableValue = context.sfMatched.get();
+    tableUnc = context.sfUncMatched.get();
   }
 
-  int const bin = histValue->FindFixBin(jet.p4.Pt(), jet.p4.Eta());
-  double const sfNominal = histValue->GetBinContent(bin);
+  double const sfNominal = (*tableValue)(jet.p4.Pt(), jet.p4.Eta());
 
   int shift = 0;
   if (jet.isPileUp) {
@@ -161,8 +181,7 @@ double PileUpIdWeight::GetScaleFactor(
   if (shift == 0) {
     return sfNominal;
   } else {
-    int const bin = histUnc->FindFixBin(jet.p4.Pt(), jet.p4.Eta());
-    double const sfUnc = histUnc->GetBinContent(bin);
+    double const sfUnc = (*tableUnc)(jet.p4.Pt(), jet.p4.Eta());
     double sf = sfNominal + shift * sfUnc;
     if (sf < 0.)
       sf = 0.;
@@ -210,33 +229,31 @@ void PileUpIdWeight::LoadScaleFactors(YAML::Node const config, int year) {
 void PileUpIdWeight::Update() const {
   std::fill(weights_.begin(), weights_.end(), 1.);
 
-  // Jets that pass pileup ID
-  for (auto const &jet : jetBuilder_->Get()) {
-    if (not pileUpIdFilter_->IsTaggable(jet))
-      continue;
-    auto const &context = FindContext(jet);
-    if (context.workingPoint == Jet::PileUpId::None)
-      continue;
-
-    double const eff = GetEfficiency(context, jet);
-    for (int iVar = 0; iVar < 5; ++iVar) {
-      double const sf = GetScaleFactor(context, jet, Variation(iVar));
-      weights_[iVar] *= std::min(sf * eff, 1.) / eff;
-    }
-  }
-
-  // Jets that fail pileup ID
-  for (auto const &jet : jetBuilder_->GetRejected()) {
-    if (not pileUpIdFilter_->IsTaggable(jet))
-      continue;
-    auto const &context = FindContext(jet);
-    if (context.workingPoint == Jet::PileUpId::None)
-      continue;
-
-    double const eff = GetEfficiency(context, jet);
+  taggableJets_.clear();
+  for (auto const &jet : jetBuilder_->Get())
+    AddTaggableJet(jet, true);
+  for (auto const &jet : jetBuilder_->GetRejected())
+    AddTaggableJet(jet, false);
+
+  // Compute efficiencies for all jets with a single call to the model
+  int const numJets = taggableJets_.size();
+  effFeatures_.resize(numJets * numEffFeatures_);
+  efficiencies_.resize(numJets);
+  for (int i = 0; i < numJets; ++i)
+    FillEffFeatures(
+        *taggableJets_[i].context, *taggableJets_[i].jet,
+        effFeatures_.data() + i * numEffFeatures_);
+  effCalc_->Predict(effFeatures_.data(), numJets, efficiencies_.data());
+
+  for (int i = 0; i < numJets; ++i) {
+    auto const &[jet, context, passed] = taggableJets_[i];
+    double const eff = efficiencies_[i];
     for (int iVar = 0; iVar < 5; ++iVar) {
-      double const sf = GetScaleFactor(context, jet, Variation(iVar));
-      weights_[iVar] *= std::max(1. - sf * eff, 0.) / (1. - eff);
+      double const sf = GetScaleFactor(*context, *jet, Variation(iVar));
+      if (passed)
+        weights_[iVar] *= std::min(sf * eff, 1.) / eff;
+      else
+        weights_[iVar] *= std::max(1. - sf * eff, 0.) / (1. - eff);
     }
   }
 
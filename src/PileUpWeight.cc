@@ -4,6 +4,7 @@
 #include <cmath>
 
 #include <TFile.h>
+#include <TH1.h>
 #include <TKey.h>
 #include <TVectorD.h>
 
@@ -14,8 +15,10 @@
 
 PileUpWeight::PileUpWeight(
     Dataset &dataset, Options const &options, RunSampler const *runSampler)
-    : cache_{dataset.Reader()}, runSampler_{runSampler},
-      mu_{dataset.Reader(), "Pileup_nTrueInt"} {
+    : node_{dataset.Graph(), "PileUpWeight", [this]{Update();}},
+      runSampler_{runSampler},
+      mu_{dataset, "Pileup_nTrueInt"} {
+  node_.AddInput(runSampler_->GetNode());
 
   YAML::Node const config = options.GetConfig()["pileup_weight"];
   if (not config)
@@ -24,8 +27,8 @@ PileUpWeight::PileUpWeight(
 
   std::filesystem::path const dataPath = Options::NodeAs<std::string>(
       config, {"data_profile"});
-  LoadDataProfiles(dataPath);
-  LoadSimProfile(config, dataset.Info().Name());
+  auto const simProfile = LoadSimProfile(config, dataset.Info().Name());
+  LoadDataProfiles(dataPath, *simProfile);
 
   // The default weight index is chosen based on the requested systematic
   // variation
@@ -52,7 +55,63 @@ std::string_view PileUpWeight::VariationName(int variation) const {
 }
 
 
-void PileUpWeight::LoadDataProfiles(std::filesystem::path const &path) {
+void PileUpWeight::BuildWeightTable(
+    Era &era, TH1 const &simProfile,
+    std::array<std::unique_ptr<TH1>, 3> const &dataProfiles) {
+  // Within each bin of the common binning all profiles are constant
+  std::vector<double> edges;
+  auto const addEdges = [&edges](TH1 const &hist) {
+    TAxis const *axis = hist.GetXaxis();
+    for (int bin = 1; bin <= axis->GetNbins() + 1; ++bin)
+      edges.emplace_back(axis->GetBinLowEdge(bin));
+  };
+  addEdges(simProfile);
+  for (auto const &profile : dataProfiles)
+    addEdges(*profile);
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  era.binning = BinnedAxis{edges};
+
+  int const numBins = era.binning.NumBins();
+  era.weights.resize(numBins + 2);
+  int numEmptySimBins = 0;
+
+  for (int bin = 0; bin < numBins + 2; ++bin) {
+    // Representative point in the bin of the common binning. It falls into
+    // the under- or overflow bins of all profiles if the bin is the under- or
+    // overflow.
+    double x;
+    if (bin == 0)
+      x = era.binning.Min() - 1.;
+    else if (bin == numBins + 1)
+      x = era.binning.Max();
+    else
+      x = 0.5 * (era.binning.BinLowEdge(bin) + era.binning.BinLowEdge(bin + 1));
+
+    double const probSim = simProfile.GetBinContent(simProfile.FindFixBin(x));
+    if (probSim <= 0.) {
+      era.weights[bin].fill(1.);
+      if (bin != 0 and bin != numBins + 1)
+        ++numEmptySimBins;
+      continue;
+    }
+
+    for (int i = 0; i < int(dataProfiles.size()); ++i) {
+      double const probData = dataProfiles[i]->GetBinContent(
+          dataProfiles[i]->FindFixBin(x));
+      era.weights[bin][i] = probData / probSim;
+    }
+  }
+
+  if (numEmptySimBins > 0)
+    LOG_WARN << "Pileup probability in simulation is not positive in "
+        << numEmptySimBins << " bins for era with runs [" << era.minRun << ", "
+        << era.maxRun << "]. Pileup weights will be set to 1 in them.";
+}
+
+
+void PileUpWeight::LoadDataProfiles(
+    std::filesystem::path const &path, TH1 const &simProfile) {
   TFile inputFile{path.c_str()};
   if (inputFile.IsZombie()) {
     HZZException exception;
@@ -85,9 +144,10 @@ void PileUpWeight::LoadDataProfiles(std::filesystem::path const &path) {
     era.minRun = std::lround((*runRange)[0]);
     era.maxRun = std::lround((*runRange)[1]);
 
+    std::array<std::unique_ptr<TH1>, 3> dataProfiles;
     int profileIndex = 0;
     for (auto const &label : {"nominal", "up", "down"}) {
-      auto hist = directory->Get<TH1>(label);
+      std::unique_ptr<TH1> hist{directory->Get<TH1>(label)};
       if (not hist) {
         HZZException exception;
         exception << "Mandatory histogram \"" << label << "\" not found in "
@@ -96,10 +156,15 @@ void PileUpWeight::LoadDataProfiles(std::filesystem::path const &path) {
         throw exception;
       }
       hist->SetDirectory(nullptr);
-      era.dataProfiles[profileIndex].reset(hist);
+
+      // Make sure the profile is normalized to represent probability density
+      hist->Scale(1. / hist->Integral(), "width");
+      dataProfiles[profileIndex] = std::move(hist);
       ++profileIndex;
     }
 
+    BuildWeightTable(era, simProfile, dataProfiles);
+
     eras_.emplace_back(std::move(era));
   }
 
@@ -114,20 +179,16 @@ void PileUpWeight::LoadDataProfiles(std::filesystem::path const &path) {
   std::sort(
       eras_.begin(), eras_.end(),
       [](Era const &lhs, Era const &rhs){return lhs.minRun < rhs.minRun;});
-
-  // Make sure the profiles are normalized to represent probability density
-  for (auto &era : eras_)
-    for (auto &profile : era.dataProfiles)
-      profile->Scale(1. / profile->Integral(), "width");
 }
 
 
-void PileUpWeight::LoadSimProfile(
+std::unique_ptr<TH1> PileUpWeight::LoadSimProfile(
     YAML::Node const &config, std::string const &datasetName) {
+  std::unique_ptr<TH1> simProfile;
   if (config["sim_profiles"]) {
-    simProfile_ = utils::ReadHistogram(
+    simProfile = utils::ReadHistogram(
         config["sim_profiles"].as<std::string>(), datasetName, false);
-    if (simProfile_) {
+    if (simProfile) {
       LOG_DEBUG << "Will use dataset-specific pileup profile in simulation.";
     } else {
       if (not config["default_sim_profile"]) {
@@ -138,7 +199,7 @@ void PileUpWeight::LoadSimProfile(
             "provided in the master configuration.";
         throw exception;
       }
-      simProfile_ = utils::ReadHistogram(
+      simProfile = utils::ReadHistogram(
           config["default_sim_profile"].as<std::string>(), "pileup");
       LOG_DEBUG << "Will use default pileup profile in simulation.";
     }
@@ -148,33 +209,24 @@ void PileUpWeight::LoadSimProfile(
           "Illegal master configuration. Section \"pileup_weight\" must "
           "contain at least one of keys \"sim_profiles\" and "
           "\"default_sim_profile\"."};
-    simProfile_ = utils::ReadHistogram(
+    simProfile = utils::ReadHistogram(
         config["default_sim_profile"].as<std::string>(), "pileup");
   }
 
   // Normalize pileup profile to represent probability density
-  simProfile_->Scale(1. / simProfile_->Integral(), "width");
+  simProfile->Scale(1. / simProfile->Integral(), "width");
+  return simProfile;
 }
 
 
-void PileUpWeight::Update() const {
-  // Note that the expected number of pileup interactions stored in NanoAOD is
-  // truncated (as in std::trunc, not std::round) to an integer. Below assume
-  // that profiles in data and simulation have integer binnings and make use of
-  // the fact that in TH1 left boundary of a bin is inclusive. Given that small
-  // integers are representable in float32 exactly, the probabilities below can
-  // be computed by a simple lookup from the histograms. If this were not the
-  // case, the digitization imposed by the truncation would have to be treated
-  // explicitly.
-  double const probSim = simProfile_->GetBinContent(
-      simProfile_->FindFixBin(*mu_));
-  if (probSim <= 0.) {
-    LOG_WARN << "Got pileup probability in simulation of " << probSim <<
-      " for true pileup of " << *mu_ << ". Set pileup weights to 1.";
-    std::fill(weights_.begin(), weights_.end(), 1.);
+PileUpWeight::Era const &PileUpWeight::FindEra(int run) const {
+  // Consecutive events usually come from the same era
+  if (currentEraIndex_ >= 0) {
+    auto const &era = eras_[currentEraIndex_];
+    if (run >= era.minRun and run <= era.maxRun)
+      return era;
   }
 
-  auto const run = runSampler_->Get();
   auto const eraIter = std::lower_bound(
       eras_.begin(), eras_.end(), run,
       [](Era const &era, int const run){return era.maxRun < run;});
@@ -184,13 +236,25 @@ void PileUpWeight::Update() const {
         << "run " << run << ".";
     throw exception;
   }
-  auto const &era = *eraIter;
+  currentEraIndex_ = eraIter - eras_.begin();
+  return *eraIter;
+}
+
+
+void PileUpWeight::Update() const {
+  // Note that the expected number of pileup interactions stored in NanoAOD is
+  // truncated (as in std::trunc, not std::round) to an integer. Profiles in
+  // data and simulation are expected to have integer binnings, and the ratios
+  // of the profiles are tabulated in the common binning, in which left
+  // boundaries of bins are inclusive, as in TH1. Given that small integers are
+  // representable in float32 exactly, the weights below can be computed by a
+  // simple lookup. If this were not the case, the digitization imposed by the
+  // truncation would have to be treated explicitly.
+  auto const run = runSampler_->Get();
+  auto const &era = FindEra(run);
+  auto const &weights = era.weights[era.binning.FindBin(*mu_)];
+  std::copy(weights.begin(), weights.end(), weights_.begin());
 
-  for (int i = 0; i < int(weights_.size()); ++i) {
-    double const probData = era.dataProfiles[i]->GetBinContent(
-        era.dataProfiles[i]->FindFixBin(*mu_));
-    weights_[i] = probData / probSim;
-  }
   LOG_TRACE << "Pileup weights: mu " << *mu_ << ", run " << run << " -> "
       << weights_[0] << ", " << weights_[1] << ", " << weights_[2];
 }
@@ -4,14 +4,15 @@
 #include <MetXYCorrections.h>
 
 
-PtMissBuilder::PtMissBuilder(Dataset &dataset, Options const &options)
-    : syst_{Syst::None}, applyEeNoiseMitigation_{false},
-      cache_{dataset.Reader()},
+PtMissBuilder::PtMissBuilder(Dataset &dataset, Options const &options,
+                             ShapeSyst const &shapeSyst)
+    : shapeSyst_{shapeSyst}, applyEeNoiseMitigation_{false},
+      node_{dataset.Graph(), "PtMissBuilder", [this]{Build();}, &shapeSyst},
       isSim_{dataset.Info().IsSimulation()},
       srcNumPV_{dataset.Reader(), "PV_npvs"},
       srcPt_{dataset.Reader(), "RawMET_pt"},
       srcPhi_{dataset.Reader(), "RawMET_phi"},
-      srcRun_{dataset.Reader(), "run"} {
+      srcRun_{dataset, "run"} {
 
   auto const config = Options::NodeAs<YAML::Node>(
       options.GetConfig(), {"ptmiss"});
@@ -53,15 +54,15 @@ PtMissBuilder::PtMissBuilder(Dataset &dataset, Options const &options)
     srcSignificance_.emplace(dataset.Reader(), "MET_significance");
   }
 
-  std::string const systLabel{options.GetAs<std::string>("syst")};
-  if (systLabel == "metuncl_up")
-    syst_ = Syst::UnclEnergyUp;
-  else if (systLabel == "metuncl_down")
-    syst_ = Syst::UnclEnergyDown;
-  else
-    syst_ = Syst::None;
+  bool hasUnclEnergyVariation = false;
+  for (int i = 0; i < shapeSyst_.NumVariations(); ++i) {
+    auto const variation = shapeSyst_.Get(i);
+    if (variation == ShapeSyst::Variation::kUnclEnergyUp
+        or variation == ShapeSyst::Variation::kUnclEnergyDown)
+      hasUnclEnergyVariation = true;
+  }
 
-  if (syst_ != Syst::None) {
+  if (hasUnclEnergyVariation) {
     std::string const name{(applyEeNoiseMitigation_) ? "METFixEE2017" : "MET"};
     srcUnclEnergyUpDeltaX_.emplace(
         dataset.Reader(), (name + "_MetUnclustEnUpDeltaX").c_str());
@@ -73,17 +74,17 @@ PtMissBuilder::PtMissBuilder(Dataset &dataset, Options const &options)
 
 
 PtMiss const &PtMissBuilder::Get() const {
-  if (cache_.IsUpdated())
-    Build();
-
+  node_.Evaluate();
   return ptMiss_;
 }
 
 
 void PtMissBuilder::PullCalibration(
     std::initializer_list<CollectionBuilderBase const *> builders) {
-  for (auto const *b : builders)
+  for (auto const *b : builders) {
     calibratingBuilders_.emplace_back(b);
+    node_.AddInput(b->GetNode());
+  }
 }
 
 
@@ -97,7 +98,7 @@ void PtMissBuilder::Build() const {
     // It also picks up a part of the type 1 correction from MET, which is
     // removed in JetBuilder. See [1] for details.
     // [1] https://hypernews.cern.ch/HyperNews/CMS/get/met/710.html
-    TLorentzVector p4;
+    FourMomentum p4;
     p4.SetPtEtaPhiM(**srcFixedPt_, 0., **srcFixedPhi_, 0.);
     ptMiss_.p4 += p4;
     p4.SetPtEtaPhiM(**srcDefaultPt_, 0., **srcDefaultPhi_, 0.);
@@ -117,11 +118,12 @@ void PtMissBuilder::Build() const {
         corrected_met_metPhi.first, 0, corrected_met_metPhi.second, 0);
   }
 
-  if (syst_ == Syst::UnclEnergyUp) {
-    ptMiss_.p4.SetPx(ptMiss_.p4.Px() + **srcUnclEnergyUpDeltaX_);
-    ptMiss_.p4.SetPy(ptMiss_.p4.Py() + **srcUnclEnergyUpDeltaY_);
-  } else if (syst_ == Syst::UnclEnergyDown) {
-    ptMiss_.p4.SetPx(ptMiss_.p4.Px() - **srcUnclEnergyUpDeltaX_);
-    ptMiss_.p4.SetPy(ptMiss_.p4.Py() - **srcUnclEnergyUpDeltaY_);
+  auto const variation = shapeSyst_.GetCurrent();
+  if (variation == ShapeSyst::Variation::kUnclEnergyUp) {
+    ptMiss_.p4 += FourMomentum{
+        **srcUnclEnergyUpDeltaX_, **srcUnclEnergyUpDeltaY_, 0., 0.};
+  } else if (variation == ShapeSyst::Variation::kUnclEnergyDown) {
+    ptMiss_.p4 -= FourMomentum{
+        **srcUnclEnergyUpDeltaX_, **srcUnclEnergyUpDeltaY_, 0., 0.};
   }
 }
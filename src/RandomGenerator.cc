@@ -0,0 +1,58 @@
+#include <RandomGenerator.h>
+
+#include <cmath>
+
+#include <boost/math/constants/constants.hpp>
+
+
+RngEngine::RngEngine(Dataset &dataset)
+    : numChannelsRegistered_{0},
+      event_{dataset, "event"},
+      luminosityBlock_{dataset, "luminosityBlock"} {}
+
+
+int RngEngine::Register(int numChannels) {
+  numChannelsRegistered_ += numChannels;
+  return numChannelsRegistered_ - numChannels;
+}
+
+
+double RngEngine::ToNormal(block_t const &block) {
+  double const u1 = ToUniform(block);
+  double const u2 = ToUniform({block[2], block[3], 0, 0});
+  return std::sqrt(-2 * std::log(u1))
+      * std::cos(boost::math::constants::two_pi<double>() * u2);
+}
+
+
+RandomGenerator::RandomGenerator(RngEngine &engine, int numChannels)
+    : engine_{engine}, numChannels_{numChannels} {
+  offset_ = engine.Register(numChannels_);
+}
+
+
+double RandomGenerator::Gaus(int channel, double mean, double sigma) const {
+  return mean + sigma * RngEngine::ToNormal(
+      engine_.Read(EngineChannel(channel)));
+}
+
+
+void RandomGenerator::Gaus(int firstChannel, int n, double *values) const {
+  auto const eventId = engine_.CurrentEvent();
+  for (int i = 0; i < n; ++i)
+    values[i] = RngEngine::ToNormal(
+        RngEngine::Generate(eventId, EngineChannel(firstChannel + i)));
+}
+
+
+double RandomGenerator::Rndm(int channel) const {
+  return RngEngine::ToUniform(engine_.Read(EngineChannel(channel)));
+}
+
+
+void RandomGenerator::Rndm(int firstChannel, int n, double *values) const {
+  auto const eventId = engine_.CurrentEvent();
+  for (int i = 0; i < n; ++i)
+    values[i] = RngEngine::ToUniform(
+        RngEngine::Generate(eventId, EngineChannel(firstChannel + i)));
+}
@@ -12,9 +12,10 @@
 
 
 RunSampler::RunSampler(Dataset &dataset, Options const &options,
-                       TabulatedRngEngine &rngEngine)
-    : samplingEnabled_{dataset.Info().IsSimulation()}, cache_{dataset.Reader()},
-      tabulatedRng_{rngEngine, 1} {
+                       RngEngine &rngEngine)
+    : samplingEnabled_{dataset.Info().IsSimulation()},
+      node_{dataset.Graph(), "RunSampler", [this]{Build();}},
+      rng_{rngEngine, 1} {
   if (samplingEnabled_) {
     auto const config = options.GetConfig()["run_sampler"];
     if (not config)
@@ -23,22 +24,21 @@ RunSampler::RunSampler(Dataset &dataset, Options const &options,
           "missing in the master configuration.");
     LoadData(config);
   } else {
-    srcRun_.emplace(dataset.Reader(), "run");
+    srcRun_.emplace(dataset, "run");
   }
 }
 
 
 
 RunSampler::run_t RunSampler::Get() const {
-  if (cache_.IsUpdated())
-    Build();
+  node_.Evaluate();
   return currentRun_;
 }
 
 
 void RunSampler::Build() const {
   if (samplingEnabled_) {
-    double const r = tabulatedRng_.Rndm(0);
+    double const r = rng_.Rndm(0);
     auto const res = std::lower_bound(
         cumulProb_.begin(), cumulProb_.end(), r,
         [](auto const &el, auto value){return el.first < value;});
@@ -0,0 +1,88 @@
+#include <ShapeSyst.h>
+
+#include <algorithm>
+#include <string>
+
+#include <HZZException.h>
+#include <Logger.h>
+
+
+ShapeSyst::ShapeSyst(Dataset &dataset, Options const &options)
+    : current_{0} {
+  std::string const systLabel{options.GetAs<std::string>("syst")};
+
+  if (systLabel == "shapes") {
+    variations_.emplace_back(Variation::kNominal);
+
+    if (dataset.Info().IsSimulation()) {
+      for (auto const variation : {
+          Variation::kJecUp, Variation::kJecDown,
+          Variation::kJerUp, Variation::kJerDown,
+          Variation::kUnclEnergyUp, Variation::kUnclEnergyDown})
+        variations_.emplace_back(variation);
+      LOG_DEBUG << "Will evaluate " << variations_.size() - 1
+          << " shape variations in addition to the nominal configuration.";
+    }
+  } else if (systLabel == "jec_up")
+    variations_.emplace_back(Variation::kJecUp);
+  else if (systLabel == "jec_down")
+    variations_.emplace_back(Variation::kJecDown);
+  else if (systLabel == "jer_up")
+    variations_.emplace_back(Variation::kJerUp);
+  else if (systLabel == "jer_down")
+    variations_.emplace_back(Variation::kJerDown);
+  else if (systLabel == "metuncl_up")
+    variations_.emplace_back(Variation::kUnclEnergyUp);
+  else if (systLabel == "metuncl_down")
+    variations_.emplace_back(Variation::kUnclEnergyDown);
+  else
+    variations_.emplace_back(Variation::kNominal);
+}
+
+
+bool ShapeSyst::HasJecVariation() const {
+  return std::any_of(
+      variations_.begin(), variations_.end(),
+      [](Variation v){
+        return v == Variation::kJecUp or v == Variation::kJecDown;});
+}
+
+
+bool ShapeSyst::HasJerVariation() const {
+  return std::any_of(
+      variations_.begin(), variations_.end(),
+      [](Variation v){
+        return v == Variation::kJerUp or v == Variation::kJerDown;});
+}
+
+
+std::string_view ShapeSyst::Label(int index) const {
+  switch (variations_.at(index)) {
+    case Variation::kJecUp:
+      return "jec_up";
+    case Variation::kJecDown:
+      return "jec_down";
+    case Variation::kJerUp:
+      return "jer_up";
+    case Variation::kJerDown:
+      return "jer_down";
+    case Variation::kUnclEnergyUp:
+      return "metuncl_up";
+    case Variation::kUnclEnergyDown:
+      return "metuncl_down";
+    default:
+      return "";
+  }
+}
+
+
+void ShapeSyst::SetCurrent(int index) {
+  if (index < 0 or index >= NumVariations()) {
+    HZZException exception;
+    exception << "Illegal index " << index << " for a shape variation. "
+        << "Number of available variations is " << NumVariations() << ".";
+    throw exception;
+  }
+
+  current_ = index;
+}
@@ -8,7 +8,7 @@
 
 
 TauBuilder::TauBuilder(Dataset &dataset, Options const &)
-    : CollectionBuilder{dataset.Reader()},
+    : CollectionBuilder{dataset, "TauBuilder"},
       minLepPt_{18.},
       srcPt_{dataset.Reader(), "Tau_pt"},
       srcEta_{dataset.Reader(), "Tau_eta"},
@@ -26,20 +26,27 @@ std::vector<Tau> const &TauBuilder::Get() const {
 void TauBuilder::Build() const {
   Taus_.clear();
 
-  for (unsigned i = 0; i < srcPt_.GetSize(); ++i) {
-    if (srcDecayMode_[i] == 5 or srcDecayMode_[i] == 6) continue;  // decay modes 5 and 6 are rejected
-    float pt = srcPt_[i];
-    if (pt < minLepPt_ ) continue; // lower pt treshold for taus
-
-    if (fabs(srcEta_[i]) > 2.3) continue; 
-
+  KinematicColumns const columns{
+      srcPt_.View(), srcEta_.View(), srcPhi_.View(), {}};
+
+  double const minLepPt = minLepPt_;
+  mask_.Reset(columns.size());
+  mask_.Require(srcDecayMode_.View(), [](int decayMode){
+        // decay modes 5 and 6 are rejected
+        return decayMode != 5 and decayMode != 6;
+      })
+      .Require(columns.pt, [=](float pt){
+        // lower pt treshold for taus
+        return not (pt < minLepPt);
+      })
+      .Require(columns.eta, [](float eta){return not (std::abs(eta) > 2.3);});
+
+  // Perform angular cleaning
+  RejectDuplicates(columns.Directions(), 0.4, mask_);
+
+  for (int i : mask_.Indices()) {
     Tau tau;
-    tau.p4.SetPtEtaPhiM(srcPt_[i], srcEta_[i], srcPhi_[i], 0.);
-
-    // Perform angular cleaning
-    if (IsDuplicate(tau.p4, 0.4))
-      continue;
-
+    tau.p4 = columns.Momentum(i);
     Taus_.emplace_back(tau);
   }
 
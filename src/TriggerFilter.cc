@@ -8,12 +8,9 @@
 
 TriggerFilter::TriggerFilter(
     Dataset &dataset, Options const &options, RunSampler const *runSampler)
-    : runSampler_{runSampler}, cache_{dataset.Reader()},
-      reader_{&dataset.Reader()}, treeIndex_{-1} {
-  if (not reader_->IsChain())
-    throw HZZException(
-        "TriggerFilter expects that the dataset contains a TChain.");
-  chain_ = dynamic_cast<TChain *>(reader_->GetTree());
+    : runSampler_{runSampler},
+      node_{dataset.Graph(), "TriggerFilter", [this]{Build();}} {
+  node_.AddInput(runSampler_->GetNode());
 
   auto const config = options.GetConfig()["trigger_filter"];
   if (not config)
@@ -22,6 +19,9 @@ TriggerFilter::TriggerFilter(
           "missing in the master configuration.");
   LoadConfig(config);
 
+  for (auto const &trigger : triggers_)
+    trigger.decision.emplace(dataset, "HLT_" + trigger.name, true);
+
   for (auto const &[channelName, channel] : channels_) {
     LOG_TRACE << "Triggers in channel \"" << channelName << "\"";
     for (auto const &trigger : channel.triggers)
@@ -32,8 +32,7 @@ TriggerFilter::TriggerFilter(
 
 
 bool TriggerFilter::operator()(std::string_view channel) const {
-  if (cache_.IsUpdated())
-    Build();
+  node_.Evaluate();
   auto const res = channels_.find(channel);
   if (res == channels_.end()) {
     HZZException exception;
@@ -47,7 +46,8 @@ bool TriggerFilter::operator()(std::string_view channel) const {
 bool TriggerFilter::TriggerInPeriod::GetDecision(run_t run) const {
   if (run < minRun or run > maxRun)
     return false;
-  return (trigger->branch and trigger->decision);
+  auto const &decision = *trigger->decision;
+  return (decision.IsPresent() and *decision);
 }
 
 
@@ -64,26 +64,6 @@ bool TriggerFilter::Channel::Collect(run_t run) const {
 
 
 void TriggerFilter::Build() const {
-  // Update statuses and addresses of trigger branches if the input chain has
-  // switched to a new tree
-  int const curTreeIndex = chain_->GetTreeNumber();
-  if (curTreeIndex != treeIndex_) {
-    treeIndex_ = curTreeIndex;
-    for (auto const &trigger : triggers_) {
-      trigger.branch = chain_->GetBranch(("HLT_" + trigger.name).c_str());
-      if (trigger.branch)
-        trigger.branch->SetAddress(&trigger.decision);
-    }
-  }
-
-  // Read trigger decisions into the buffers
-  int64_t const entryCurTree = reader_->GetCurrentEntry()
-      - chain_->GetTreeOffset()[treeIndex_];
-  for (auto const &trigger : triggers_) {
-    if (trigger.branch)
-      trigger.branch->GetEntry(entryCurTree);
-  }
-
   // Collect trigger decisions for all channels
   for (auto const &[name, channel] : channels_)
     channel.Collect(runSampler_->Get());
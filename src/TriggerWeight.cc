@@ -7,6 +7,7 @@
 #include <string>
 
 #include <TFile.h>
+#include <TH2.h>
 #include <TList.h>
 #include <yaml-cpp/yaml.h>
 
@@ -19,7 +20,10 @@
 TriggerWeight::TriggerWeight(Dataset &dataset, Options const &options,
     ElectronBuilder const *electronBuilder,
     MuonBuilder const *muonBuilder, int efficiencyType)
-    : cache_{dataset.Reader()}, electronBuilder_{electronBuilder}, muonBuilder_{muonBuilder} {
+    : node_{dataset.Graph(), "TriggerWeight", [this]{Update();}},
+      electronBuilder_{electronBuilder}, muonBuilder_{muonBuilder} {
+  node_.AddInput(electronBuilder_->GetNode());
+  node_.AddInput(muonBuilder_->GetNode());
   efficiencyType_ = efficiencyType;
   // The default weight index is chosen based on the requested systematic
   // variation
@@ -74,14 +78,14 @@ std::string_view TriggerWeight::VariationName(int variation) const {
 
 void TriggerWeight::ReadHistogram(
     std::string const &pathWithName,
-    std::map<std::string, std::unique_ptr<TH2D>> &th2Map) {
+    std::map<std::string, BinnedTable2D> &th2Map) {
 
   std::filesystem::path path = FileInPath::Resolve(pathWithName);
   TFile *tmpFile = new TFile(path.c_str());
   auto const listOfKeys = tmpFile->GetListOfKeys();
   for (int i = 0; i < listOfKeys->GetSize(); i++){
     th2Map.emplace(listOfKeys->At(i)->GetName(), 
-        utils::ReadHistogram<TH2D>(path, listOfKeys->At(i)->GetName()));
+        *utils::ReadHistogram<TH2D>(path, listOfKeys->At(i)->GetName()));
   }
 }
 
@@ -176,8 +180,7 @@ double TriggerWeight::GetEfficiency(Lepton const *l1, Lepton const *l2,
       else if (eta1 >= 1.479 and eta2 >= 1.479) cat = "EE";
       auto searchEE = eeScaleFactors_.find(type+"_"+cat+"_"+systTypeEE);
       if (searchEE != eeScaleFactors_.end()){
-        auto const bin = searchEE->second->FindFixBin(pt1, pt2);
-        eff = searchEE->second->GetBinContent(bin);
+        eff = searchEE->second(pt1, pt2);
       }
       else
         throw HZZException("Unknown efficiency table\n");
@@ -190,8 +193,7 @@ double TriggerWeight::GetEfficiency(Lepton const *l1, Lepton const *l2,
       else if (eta1 >= 1.2 and eta2 >= 1.2) cat = "EE";
       auto searchMuMu = mumuScaleFactors_.find(type+"_"+cat+"_"+systTypeMuMu);
       if (searchMuMu != mumuScaleFactors_.end()) {
-        auto const bin = searchMuMu->second->FindFixBin(pt1, pt2);
-        eff =  searchMuMu->second->GetBinContent(bin);
+        eff =  searchMuMu->second(pt1, pt2);
       }
       else 
         throw HZZException("Unknown efficiency table\n");
@@ -204,8 +206,7 @@ double TriggerWeight::GetEfficiency(Lepton const *l1, Lepton const *l2,
       else if (eta1 >= 1.479 and eta2 >= 1.2) cat = "EE";
       auto searchEMu = emuScaleFactors_.find(type+"_"+cat+"_"+systTypeEMu);
       if (searchEMu != emuScaleFactors_.end()){
-        auto const bin = searchEMu->second->FindFixBin(pt1, pt2);
-        eff =  searchEMu->second->GetBinContent(bin);
+        eff =  searchEMu->second(pt1, pt2);
       }
       else 
         throw HZZException("Unknown efficiency table\n");
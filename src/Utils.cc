@@ -13,7 +13,7 @@
 
 namespace utils {
 
-double deltaPhi(TLorentzVector const &v1, TLorentzVector const &v2)
+double deltaPhi(FourMomentum const &v1, FourMomentum const &v2)
 {
   return deltaPhi (v1.Phi(), v2.Phi());
 }
@@ -27,7 +27,7 @@ double deltaPhi (float phi1, float phi2)
 }
 
 
-bool PassVbfCuts(std::vector<Jet> const &selJets, TLorentzVector const &boson) {
+bool PassVbfCuts(std::vector<Jet> const &selJets, FourMomentum const &boson) {
   if(selJets.size()>=2){
     float etamin=0., etamax=0;
     if(selJets[0].p4.Eta()>selJets[1].p4.Eta()) {etamax = selJets[0].p4.Eta(); etamin = selJets[1].p4.Eta();}
@@ -5,14 +5,29 @@
 #include <VBFDiscriminant.h>
 
 #include <filesystem>
+#include <mutex>
 
 
 namespace fs = std::filesystem;
 namespace PDG = PDGHelpers;
 
 
-VBFDiscriminant::VBFDiscriminant(Options const &options)
-    : melaHandle_{MelaHandler::smartMela_.Get()} {
+namespace {
+
+/// Serializes computations with the MELA object of this process
+std::mutex melaMutex;
+
+/// Pool of helper processes shared by all instances of VBFDiscriminant
+std::weak_ptr<MelaWorkerPool> sharedWorkerPool;
+
+}  // anonymous namespace
+
+
+VBFDiscriminant::VBFDiscriminant(Dataset &dataset, Options const &options)
+    : melaHandle_{MelaHandler::smartMela_.Get()},
+      srcRun_{dataset, "run"},
+      srcLumi_{dataset, "luminosityBlock"},
+      srcEvent_{dataset, "event"} {
 
   auto mepConfig = options.GetConfig()["vbf_discriminant"];
   if (not mepConfig)
@@ -71,6 +86,37 @@ VBFDiscriminant::VBFDiscriminant(Options const &options)
               ga3ConstantFile.Get("sp_tgfinal_VBF_SM_over_tgfinal_VBF_g4")));
   gConstant_[MEP::kSIGl1].reset(dynamic_cast<TSpline3 *>(
               gl1ConstantFile.Get("sp_tgfinal_VBF_SM_over_tgfinal_VBF_L1")));
+
+  if (auto const cacheDir = mepConfig["cache_dir"]) {
+    // Any change in the MELA configuration invalidates the cache
+    std::string const melaConfig = YAML::Dump(mepConfig["meps"])
+        + YAML::Dump(mepConfig["mep_flags"]);
+    uint64_t const configHash =
+        MelaCache::Hash(melaConfig.data(), melaConfig.size());
+
+    fs::path const dir{cacheDir.as<std::string>()};
+    fs::create_directories(dir);
+    cache_ = std::make_unique<MelaCache>(
+        dir / (dataset.Info().Name() + ".melacache"), configHash);
+  }
+
+  if (auto const workers = mepConfig["workers"];
+      workers and workers.as<int>() > 0) {
+    std::lock_guard<std::mutex> lock{melaMutex};
+    workerPool_ = sharedWorkerPool.lock();
+
+    if (not workerPool_) {
+      // Helper processes use copies of hypotheses and computations of this
+      // object, which are configured identically in all instances
+      workerPool_ = std::make_shared<MelaWorkerPool>(
+          workers.as<int>(),
+          [this](FourMomentum const &p4ZZ,
+                 std::vector<FourMomentum> const &jets){
+            return ComputeProbabilities(p4ZZ, jets);
+          });
+      sharedWorkerPool = workerPool_;
+    }
+  }
 }
 
 
@@ -81,34 +127,41 @@ VBFDiscriminant::~VBFDiscriminant() {
 
 
 std::array<double, 4> const &VBFDiscriminant::Get(
-    TLorentzVector const &p4LL,
-    TLorentzVector const &p4Miss,
+    FourMomentum const &p4LL,
+    FourMomentum const &p4Miss,
     std::vector<Jet> const &jets) {
-  Reset();
+  dJJVBF_.fill(-1);
   // Check if jets size is less than 2 then
   // return invalid values for Djj VBF discriminants i.e. -1
   if (jets.size() < 2)
     // Default values of Djj VBF discriminants are -1
     return dJJVBF_;
 
-  BuildMelaCandidate(p4LL, p4Miss, jets);
-  ComputeClusters();
+  // Construncing approximate ZZ candidate
+  p4ZZApprox_.SetPtEtaPhiM(p4Miss.Pt(), p4LL.Eta(), p4Miss.Phi(), PDG::Zmass);
+  p4ZZApprox_ += p4LL;
+
+  jetP4_.clear();
+  for (auto const &jet : jets)
+    jetP4_.emplace_back(jet.p4);
 
   // Storing P_sigs and P_alt
-  double pSiga1 = 0, pSiga2 = 0, pSiga3 = 0, pSigl1 = 0, pAlt = 0;
-  for (auto &computer : computers_) {
-    auto const &name = computer->getName();
-    if (name == mepFlag_[MEP::kSIGa1])
-      pSiga1 = computer->getVal(MELAHypothesis::METype::UseME);
-    else if (name == mepFlag_[MEP::kSIGa2])
-      pSiga2 = computer->getVal(MELAHypothesis::METype::UseME);
-    else if (name == mepFlag_[MEP::kSIGa3])
-      pSiga3 = computer->getVal(MELAHypothesis::METype::UseME);
-    else if (name == mepFlag_[MEP::kSIGl1])
-      pSigl1 = computer->getVal(MELAHypothesis::METype::UseME);
-    else if (name == mepFlag_[MEP::kALT])
-      pAlt = computer->getVal(MELAHypothesis::METype::UseME);
-  }
+  MelaCache::Values mep;
+  if (cache_) {
+    MelaCache::EventID const id{*srcRun_, *srcLumi_, *srcEvent_};
+    uint64_t const inputHash = HashInputs();
+    if (auto const cached = cache_->Find(id, inputHash))
+      mep = *cached;
+    else {
+      mep = EvaluateProbabilities();
+      cache_->Insert(id, inputHash, mep);
+    }
+  } else
+    mep = EvaluateProbabilities();
+
+  double const pSiga1 = mep[MEP::kSIGa1], pSiga2 = mep[MEP::kSIGa2],
+      pSiga3 = mep[MEP::kSIGa3], pSigl1 = mep[MEP::kSIGl1],
+      pAlt = mep[MEP::kALT];
 
   auto const mZZ = p4ZZApprox_.M();
   auto const c = cConstant_->Eval(mZZ);
@@ -127,26 +180,21 @@ std::array<double, 4> const &VBFDiscriminant::Get(
 
 void VBFDiscriminant::Reset() {
   melaHandle_->resetInputEvent();
-  dJJVBF_.fill(-1);
   for (auto cluster : clusters_)
     cluster->reset();
 }
 
 
-void VBFDiscriminant::BuildMelaCandidate(TLorentzVector const &p4LL,
-    TLorentzVector const &p4Miss, std::vector<Jet> const &jets) {
+void VBFDiscriminant::BuildMelaCandidate(FourMomentum const &p4ZZ,
+    std::vector<FourMomentum> const &jets) {
   SimpleParticleCollection_t daughters, associated;
 
-  // Construncing approximate ZZ candidate
-  p4ZZApprox_.SetPtEtaPhiM(p4Miss.Pt(), p4LL.Eta(), p4Miss.Phi(), PDG::Zmass);
-  p4ZZApprox_ += p4LL;
-
   // Adding reconstructed ZZ candidate as a duaghter particle
-  daughters.push_back(SimpleParticle_t(25, p4ZZApprox_));
+  daughters.push_back(SimpleParticle_t(25, p4ZZ.ToTLorentzVector()));
 
   // Adding jets as associated particles
   for (auto const& jet : jets)
-    associated.push_back(SimpleParticle_t(0, jet.p4));
+    associated.push_back(SimpleParticle_t(0, jet.ToTLorentzVector()));
 
   melaHandle_->setCandidateDecayMode(TVar::CandidateDecay_Stable);
   melaHandle_->setInputEvent(&daughters, &associated, nullptr, false);
@@ -160,3 +208,49 @@ void VBFDiscriminant::ComputeClusters() const {
   }
 }
 
+
+MelaCache::Values VBFDiscriminant::ComputeProbabilities(
+    FourMomentum const &p4ZZ, std::vector<FourMomentum> const &jets) {
+  Reset();
+  BuildMelaCandidate(p4ZZ, jets);
+  ComputeClusters();
+
+  MelaCache::Values mep;
+  mep.fill(0.);
+  for (auto &computer : computers_) {
+    auto const &name = computer->getName();
+    for (int i = 0; i < int(mepFlag_.size()); ++i) {
+      if (name == mepFlag_[i]) {
+        mep[i] = computer->getVal(MELAHypothesis::METype::UseME);
+        break;
+      }
+    }
+  }
+
+  return mep;
+}
+
+
+MelaCache::Values VBFDiscriminant::EvaluateProbabilities() {
+  if (workerPool_ and int(jetP4_.size()) <= MelaWorkerPool::maxJets)
+    return workerPool_->Compute(p4ZZApprox_, jetP4_);
+
+  std::lock_guard<std::mutex> lock{melaMutex};
+  return ComputeProbabilities(p4ZZApprox_, jetP4_);
+}
+
+
+uint64_t VBFDiscriminant::HashInputs() const {
+  // Hash the Cartesian components, which is what BuildMelaCandidate passes
+  // to MELA
+  std::vector<double> inputs{
+      p4ZZApprox_.Px(), p4ZZApprox_.Py(), p4ZZApprox_.Pz(),
+      p4ZZApprox_.E()};
+  for (auto const &p4 : jetP4_) {
+    inputs.push_back(p4.Px());
+    inputs.push_back(p4.Py());
+    inputs.push_back(p4.Pz());
+    inputs.push_back(p4.E());
+  }
+  return MelaCache::Hash(inputs.data(), sizeof(double) * inputs.size());
+}
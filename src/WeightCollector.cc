@@ -19,6 +19,25 @@ double WeightCollector::NominalWeight() const {
 }
 
 
+void WeightCollector::FillVariations(float *weights) const {
+  int offset = NumVariations();
+  double nominalWeight = 1.;
+
+  // Each computer writes its nominal weight right before its variations. The
+  // computers are processed in the reverse order so that this position, which
+  // is occupied by the last variation from the preceding computer, is read
+  // before it gets overwritten. The first computer writes its nominal weight
+  // at index 0, which is then replaced with the combined one.
+  for (int i = int(computers_.size()) - 1; i >= 0; --i) {
+    offset -= computers_[i]->NumVariations();
+    computers_[i]->FillVariations(weights + offset);
+    nominalWeight *= weights[offset];
+  }
+
+  weights[0] = nominalWeight;
+}
+
+
 int WeightCollector::NumVariations() const {
   int num = 0;
   for (auto const c : computers_)
@@ -0,0 +1,62 @@
+#include <XGBoostCompiledModel.h>
+
+#include <utility>
+
+#include <HZZException.h>
+
+
+XGBoostCompiledModel::XGBoostCompiledModel(
+    std::string name, int numFeatures, PredictFunction predict,
+    std::vector<float> probes)
+    : name_{std::move(name)}, numFeatures_{numFeatures}, predict_{predict},
+      probes_{std::move(probes)} {
+  if (numFeatures_ <= 0 or probes_.size() % numFeatures_ != 0) {
+    HZZException exception;
+    exception << "Inconsistent specification of compiled XGBoost model \""
+        << name_ << "\": " << numFeatures_ << " features and "
+        << probes_.size() << " values for probe examples.";
+    throw exception;
+  }
+
+  auto const [pos, inserted] = Registry().emplace(name_, this);
+
+  if (not inserted) {
+    HZZException exception;
+    exception << "Compiled XGBoost model \"" << name_
+        << "\" is registered more than once.";
+    throw exception;
+  }
+}
+
+
+XGBoostCompiledModel const &XGBoostCompiledModel::Get(std::string const &name) {
+  auto const &registry = Registry();
+  auto const res = registry.find(name);
+
+  if (res == registry.end()) {
+    HZZException exception;
+    exception << "Compiled XGBoost model \"" << name << "\" is not available.";
+
+    if (registry.empty())
+      exception << " No compiled models have been built.";
+    else {
+      exception << " Available models:";
+      for (auto const &[availableName, model] : registry)
+        exception << " \"" << availableName << "\"";
+      exception << ".";
+    }
+
+    throw exception;
+  }
+
+  return *res->second;
+}
+
+
+std::map<std::string, XGBoostCompiledModel const *> &
+XGBoostCompiledModel::Registry() {
+  // Constructed on first use, so that models can be registered from static
+  // objects in other translation units
+  static std::map<std::string, XGBoostCompiledModel const *> registry;
+  return registry;
+}
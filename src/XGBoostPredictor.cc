@@ -1,7 +1,13 @@
 #include <XGBoostPredictor.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <sstream>
+#include <vector>
+
+#include <HZZException.h>
+#include <Logger.h>
 
 
 XGBoostPredictorException::XGBoostPredictorException(
@@ -13,11 +19,19 @@ XGBoostPredictorException::XGBoostPredictorException(
 }
 
 
-XGBoostPredictor::XGBoostPredictor(std::string const &path, int numFeatures)
-    : booster_{nullptr}, numFeatures_{numFeatures} {
+XGBoostPredictor::XGBoostPredictor(std::string const &path, int numFeatures,
+                                   std::string const &compiledModel)
+    : booster_{nullptr}, numFeatures_{numFeatures}, compiledModel_{nullptr} {
   CheckCall("XGBoosterCreate", XGBoosterCreate(nullptr, 0, &booster_));
   CheckCall("XGBoosterSetParam", XGBoosterSetParam(booster_, "nthread", "1"));
   CheckCall("XGBoosterLoadModel", XGBoosterLoadModel(booster_, path.c_str()));
+
+  if (not compiledModel.empty()) {
+    compiledModel_ = &XGBoostCompiledModel::Get(compiledModel);
+    CheckCompiledModel();
+    LOG_DEBUG << "Using compiled model \"" << compiledModel
+        << "\" in place of XGBoost model " << path << ".";
+  }
 }
 
 
@@ -27,21 +41,19 @@ XGBoostPredictor::~XGBoostPredictor() {
 
 
 float XGBoostPredictor::Predict(float const *x) const {
-  DMatrixHandle dmat{nullptr};
-  CheckCall(
-      "XGDMatrixCreateFromMat",
-      XGDMatrixCreateFromMat(
-          x, 1, numFeatures_, std::numeric_limits<float>::quiet_NaN(), &dmat));
+  float prediction;
+  Predict(x, 1, &prediction);
+  return prediction;
+}
 
-  bst_ulong numScores = 0;
-  float const *scores{nullptr};
-  CheckCall(
-      "XGBoosterPredict",
-      XGBoosterPredict(booster_, dmat, 0, 0, 0, &numScores, &scores));
-  float const prediction = scores[0];
 
-  CheckCall("XGDMatrixFree", XGDMatrixFree(dmat));
-  return prediction;
+void XGBoostPredictor::Predict(
+    float const *x, int numExamples, float *predictions) const {
+  if (compiledModel_) {
+    for (int i = 0; i < numExamples; ++i)
+      predictions[i] = compiledModel_->Predict(x + i * numFeatures_);
+  } else
+    PredictLibrary(x, numExamples, predictions);
 }
 
 
@@ -51,3 +63,64 @@ void XGBoostPredictor::CheckCall(
     throw XGBoostPredictorException(functionName, exitCode);
 }
 
+
+void XGBoostPredictor::CheckCompiledModel() const {
+  if (compiledModel_->GetNumFeatures() != numFeatures_) {
+    HZZException exception;
+    exception << "Compiled XGBoost model \"" << compiledModel_->GetName()
+        << "\" expects " << compiledModel_->GetNumFeatures()
+        << " input features while " << numFeatures_ << " are provided.";
+    throw exception;
+  }
+
+  int const numProbes = compiledModel_->GetNumProbes();
+  float const *probes = compiledModel_->GetProbes();
+  std::vector<float> expected(numProbes);
+  PredictLibrary(probes, numProbes, expected.data());
+
+  // The compiled model performs the same floating-point operations in the same
+  // order as the library, but allow for differences in the implementation of
+  // the link function
+  for (int i = 0; i < numProbes; ++i) {
+    float const prediction = compiledModel_->Predict(probes + i * numFeatures_);
+    if (std::abs(prediction - expected[i])
+        > 1e-5f * std::max(1.f, std::abs(expected[i]))) {
+      HZZException exception;
+      exception << "Compiled XGBoost model \"" << compiledModel_->GetName()
+          << "\" does not reproduce the original model for probe example #"
+          << i << ": " << prediction << " vs " << expected[i] << ".";
+      throw exception;
+    }
+  }
+
+  LOG_DEBUG << "Compiled XGBoost model \"" << compiledModel_->GetName()
+      << "\" reproduces the original model for " << numProbes
+      << " probe examples.";
+}
+
+
+void XGBoostPredictor::PredictLibrary(
+    float const *x, int numExamples, float *predictions) const {
+  if (numExamples <= 0)
+    return;
+
+  DMatrixHandle dmat{nullptr};
+  CheckCall(
+      "XGDMatrixCreateFromMat",
+      XGDMatrixCreateFromMat(
+          x, numExamples, numFeatures_,
+          std::numeric_limits<float>::quiet_NaN(), &dmat));
+
+  bst_ulong numScores = 0;
+  float const *scores{nullptr};
+  int const status =
+      XGBoosterPredict(booster_, dmat, 0, 0, 0, &numScores, &scores);
+
+  // The scores are owned by the booster and remain valid after the DMatrix is
+  // freed, but the DMatrix must be freed even if the prediction failed
+  if (status == 0)
+    std::copy(scores, scores + numExamples, predictions);
+
+  CheckCall("XGDMatrixFree", XGDMatrixFree(dmat));
+  CheckCall("XGBoosterPredict", status);
+}
@@ -20,27 +20,19 @@ int const ZGammaTrees::maxSize_;
 ZGammaTrees::ZGammaTrees(Options const &options, Dataset &dataset)
     : EventTrees{options, dataset},
       storeMoreVariables_{options.Exists("more-vars")},
-      srcRun_{dataset.Reader(), "run"},
-      srcLumi_{dataset.Reader(), "luminosityBlock"},
-      srcEvent_{dataset.Reader(), "event"},
+      srcRun_{dataset, "run"},
+      srcLumi_{dataset, "luminosityBlock"},
+      srcEvent_{dataset, "event"},
       photonBuilder_{dataset},
       photonPrescales_{dataset, options},
       photonWeight_{dataset, options, &photonBuilder_},
       triggerFilter_{dataset, options, &runSampler_},
       gJetsWeight_{dataset, &photonBuilder_},
       //photonFilter_{dataset, options},
-      srcNumPVGood_{dataset.Reader(), "PV_npvsGood"} {
+      srcNumPVGood_{dataset, "PV_npvsGood"} {
 
   if (isSim_) {
     srcLHEVpt_.reset(new TTreeReaderValue<Float_t>(dataset.Reader(), "LHE_Vpt"));
-
-    numGenPart_.reset(new TTreeReaderValue<UInt_t>(dataset.Reader(), "nGenPart"));
-    genPartPdgId_.reset(new TTreeReaderArray<Int_t>(dataset.Reader(), "GenPart_pdgId"));
-    genPartPt_.reset(new TTreeReaderArray<Float_t>(dataset.Reader(), "GenPart_pt"));
-    genPartEta_.reset(new TTreeReaderArray<Float_t>(dataset.Reader(), "GenPart_eta"));
-    genPartPhi_.reset(new TTreeReaderArray<Float_t>(dataset.Reader(), "GenPart_phi"));
-    genPartStatus_.reset(new TTreeReaderArray<Int_t>(dataset.Reader(), "GenPart_status"));
-    genPartStatusFlags_.reset(new TTreeReaderArray<Int_t>(dataset.Reader(), "GenPart_statusFlags"));
   }
 
   photonBuilder_.EnableCleaning({&muonBuilder_, &electronBuilder_});
@@ -173,7 +165,7 @@ bool ZGammaTrees::ProcessEvent() {
       return false;
   }
   leptonCat_ = int(leptonCat);
-  TLorentzVector const p4LL = l1->p4 + l2->p4;
+  FourMomentum const p4LL = l1->p4 + l2->p4;
   llPt_ = p4LL.Pt();
   llEta_ = p4LL.Eta();
   llPhi_ = p4LL.Phi();
@@ -224,53 +216,51 @@ bool ZGammaTrees::ProcessEvent() {
   isOverlapped_ = false;
 
   if (isSim_ && (isZGToLLG_ || isDYJetsToLL_)) {
-    for (unsigned i = 0; i < genPartPdgId_->GetSize(); ++i) {
-      // Particle is in the final state
-      if (not (genPartStatus_->At(i) == 1))
-        continue;
+    auto const &genKinematics = genParticles_->Kinematics();
 
-      // is a photon
-      if (not (genPartPdgId_->At(i) == 22))
+    // is a photon
+    for (int i : genParticles_->WithPdgId(22)) {
+      // Particle is in the final state
+      if (not (genParticles_->Status(i) == 1))
         continue;
 
       // isPrompt or fromHardProcess
-      if (not ((genPartStatusFlags_->At(i) & 1) || (genPartStatusFlags_->At(i) >> 8) & 1))
+      int const statusFlags = genParticles_->StatusFlags(i);
+      if (not ((statusFlags & 1) || (statusFlags >> 8) & 1))
         continue;
 
-      if (not (genPartPt_->At(i) > 15 && std::abs(genPartEta_->At(i) < 2.6)))
+      if (not (genKinematics.pt[i] > 15 && std::abs(genKinematics.eta[i] < 2.6)))
         continue;
 
       // std::cout << "Gen photon!" << std::endl;
 
       bool gen_photon_isolated = true;
 
-      for (unsigned j = 0; j < genPartPdgId_->GetSize(); ++j) {
+      genParticles_->ForEachInCone(
+          genKinematics.eta[i], genKinematics.phi[i], 0.05,
+          [&](int j, double) {
         // Other particles
         if (j == i)
-          continue;
+          return true;
 
         // is in the final state
-        if (not (genPartStatus_->At(j) == 1))
-          continue;
+        if (not (genParticles_->Status(j) == 1))
+          return true;
 
         // is NOT a photon
-        if (genPartPdgId_->At(j) == 22)
-          continue;
+        if (genParticles_->PdgId(j) == 22)
+          return true;
 
         // fromHardProcess
-        if (not ((genPartStatusFlags_->At(j) >> 8) & 1))
-          continue;
-
-        if (not (genPartPt_->At(j) > 5))
-          continue;
+        if (not ((genParticles_->StatusFlags(j) >> 8) & 1))
+          return true;
 
-        // std::cout << std::sqrt(utils::DeltaR2(genPartEta_->At(i), genPartPhi_->At(i), genPartEta_->At(j), genPartPhi_->At(j))) << std::endl;
+        if (not (genKinematics.pt[j] > 5))
+          return true;
 
-        if (std::sqrt(utils::DeltaR2(genPartEta_->At(i), genPartPhi_->At(i), genPartEta_->At(j), genPartPhi_->At(j))) < 0.05) {
-          gen_photon_isolated = false;
-          break;
-        }
-      }
+        gen_photon_isolated = false;
+        return false;
+      });
 
       if (gen_photon_isolated) {
         // std::cout << "Event removed!" << std::endl;
@@ -380,7 +370,7 @@ bool ZGammaTrees::ProcessEvent() {
   if (applyMassLineshape_) {
     photonMass = lineshapeMassWeight_map_["_ll"]->GetRandom();
   }
-  TLorentzVector photonWithMass;
+  FourMomentum photonWithMass;
   photonWithMass.SetPtEtaPhiM(photon->p4.Pt(), photon->p4.Eta(), 
     photon->p4.Phi(), photonMass);
 